@@ -0,0 +1,103 @@
+#include "ahocorasick.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+static i32 aho_add_state(AhoCorasick* aho) {
+    isize at = arrlist_count(aho->next);
+    arrlist_setcount(aho->next, at + aho->class_count);
+    memset(aho->next + at, -1, aho->class_count * sizeof(i32));
+    arrlist_append(aho->longest, 0);
+    arrlist_append(aho->shorter, -1);
+    return aho->state_count++;
+}
+
+void aho_build(AhoCorasick* aho, const String* patterns, isize count) {
+    PROFILE_BEGIN("aho_build");
+    *aho = (AhoCorasick){0};
+    aho->class_count = 1;
+    for (isize i = 0; i < count; i++) {
+        for (isize j = 0; j < patterns[i].count; j++) {
+            u8 byte = patterns[i].data[j];
+            if (aho->classes[byte] == 0) aho->classes[byte] = aho->class_count++;
+        }
+    }
+    i32 classes = aho->class_count;
+    aho_add_state(aho);
+
+    // the trie, missing edges stay -1 until the failure links fill them in
+    for (isize i = 0; i < count; i++) {
+        i32 state = 0;
+        for (isize j = 0; j < patterns[i].count; j++) {
+            u8 class = aho->classes[(u8)patterns[i].data[j]];
+            if (aho->next[state * classes + class] < 0) {
+                i32 added = aho_add_state(aho);
+                aho->next[state * classes + class] = added;
+            }
+            state = aho->next[state * classes + class];
+        }
+        if (patterns[i].count > aho->longest[state]) aho->longest[state] = patterns[i].count;
+    }
+
+    // breadth first so a state's failure state is finished before the state itself, a missing
+    // edge goes where the failure state's edge goes
+    i32* fail = NULL;
+    i32* queue = NULL;
+    arrlist_setcount(fail, aho->state_count);
+    arrlist_setcount(aho->report, aho->state_count);
+    aho->report[0] = -1;
+    for (i32 class = 0; class < classes; class++) {
+        i32 child = aho->next[class];
+        if (child > 0) {
+            fail[child] = 0;
+            arrlist_append(queue, child);
+        } else {
+            aho->next[class] = 0;
+        }
+    }
+    for (isize head = 0; head < arrlist_count(queue); head++) {
+        i32 state = queue[head];
+        i32 failure = fail[state];
+        aho->shorter[state] = aho->longest[failure] > 0 ? failure : aho->shorter[failure];
+        aho->report[state] = aho->longest[state] > 0 ? state : aho->shorter[state];
+        for (i32 class = 0; class < classes; class++) {
+            i32 child = aho->next[state * classes + class];
+            if (child >= 0) {
+                fail[child] = aho->next[failure * classes + class];
+                arrlist_append(queue, child);
+            } else {
+                aho->next[state * classes + class] = aho->next[failure * classes + class];
+            }
+        }
+    }
+    arrlist_free(fail);
+    arrlist_free(queue);
+
+    // the scan looks rows up by where they start rather than by state
+    for (isize i = 0; i < arrlist_count(aho->next); i++) aho->next[i] *= classes;
+    PROFILE_END("aho_build");
+}
+
+void aho_free(AhoCorasick* aho) {
+    arrlist_free(aho->next);
+    arrlist_free(aho->longest);
+    arrlist_free(aho->shorter);
+    arrlist_free(aho->report);
+    *aho = (AhoCorasick){0};
+}
+
+void aho_scan(AhoCorasick* aho, const char* data, isize count, TextRange** matches) {
+    if (aho->state_count == 0) return;
+    const i32* next = aho->next;
+    const i32* report = aho->report;
+    i32 classes = aho->class_count;
+    i32 row = 0;
+    for (isize i = 0; i < count; i++) {
+        row = next[row + aho->classes[(u8)data[i]]];
+        // every pattern ending here, the longest one first
+        for (i32 s = report[row / classes]; s >= 0; s = aho->shorter[s]) {
+            arrlist_append(*matches, ((TextRange){i + 1 - aho->longest[s], i + 1}));
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef AHOCORASICK_H_
+#define AHOCORASICK_H_
+
+#include "short_types.h"
+#include "stringbuilder.h"
+#include "text.h"
+
+// finds every occurrence of many patterns in one pass over the bytes
+//
+// the trie's failure links are folded into a full transition table when it's built, so the
+// scan is a single table lookup per byte no matter how many patterns there are. bytes that
+// appear in no pattern all share one column, which keeps the table small enough to stay in cache
+
+typedef struct AhoCorasick {
+    u8 classes[256]; // column of each byte in the table, 0 for bytes no pattern uses
+    i32 class_count;
+    i32* next;    // arraylist, next[state * class_count + class] is the next state * class_count
+    i32* longest; // arraylist, per state the length of the longest pattern ending there, 0 for none
+    i32* shorter; // arraylist, per state the next state down the failure chain where a pattern ends, -1 for none
+    i32* report;  // arraylist, per state the first state to report from (itself or shorter), -1 for none
+    i32 state_count;
+} AhoCorasick;
+
+// empty patterns are ignored
+void aho_build(AhoCorasick* aho, const String* patterns, isize count);
+void aho_free(AhoCorasick* aho);
+
+// appends every occurrence (overlapping ones included) to the matches arraylist, offsets are
+// relative to data and sorted by where they end
+void aho_scan(AhoCorasick* aho, const char* data, isize count, TextRange** matches);
+
+#endif //AHOCORASICK_H_
@@ -0,0 +1,304 @@
+#include "brackets.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static const i8 bracket_deltas[256] = {
+    ['('] = 1, ['['] = 1, ['{'] = 1,
+    [')'] = -1, [']'] = -1, ['}'] = -1,
+};
+
+// the depths are pulled up with the tree's spans, nodes[0] stays zero for the empty subtrees
+static void bracket_pull(void* data, GapTreapNode* tree, i32 t) {
+    BracketNode* nodes = ((BracketIndex*)data)->nodes;
+    GapTreapNode* node = &tree[t];
+    BracketNode* n = &nodes[t];
+    BracketNode* left = &nodes[node->left];
+    BracketNode* right = &nodes[node->right];
+    n->sum = left->sum + n->delta + right->sum;
+
+    i32 prefix = left->sum + n->delta;
+    n->min_prefix = prefix;
+    if (node->left != 0 && left->min_prefix < n->min_prefix) n->min_prefix = left->min_prefix;
+    if (node->right != 0 && prefix + right->min_prefix < n->min_prefix) n->min_prefix = prefix + right->min_prefix;
+
+    i32 suffix = right->sum + n->delta;
+    n->max_suffix = suffix;
+    if (node->right != 0 && right->max_suffix > n->max_suffix) n->max_suffix = right->max_suffix;
+    if (node->left != 0 && suffix + left->max_suffix > n->max_suffix) n->max_suffix = suffix + left->max_suffix;
+}
+
+static void bracket_pull_all(GapTreap* tree, i32 t) {
+    if (t == 0) return;
+    bracket_pull_all(tree, tree->nodes[t].left);
+    bracket_pull_all(tree, tree->nodes[t].right);
+    gaptreap_pull(tree, t);
+}
+
+static i32 bracket_node_new(BracketIndex* index, i64 gap, char c) {
+    i32 t = gaptreap_node_new(&index->tree, gap);
+    if (t == arrlist_count(index->nodes)) arrlist_append(index->nodes, (BracketNode){0});
+    index->nodes[t] = (BracketNode){.delta = bracket_deltas[(u8)c]};
+    gaptreap_pull(&index->tree, t);
+    return t;
+}
+
+// a tree of sorted brackets in linear time, each new node pops the right spine nodes with lower
+// priorities and takes them as its left subtree
+static i32 bracket_build(BracketIndex* index, const Bracket* brackets, isize count, i64 origin) {
+    i32* spine = NULL;
+    i64 previous = origin;
+    arrlist_expand(index->tree.nodes, count);
+    arrlist_expand(index->nodes, count);
+    for (isize i = 0; i < count; i++) {
+        i32 t = bracket_node_new(index, brackets[i].index - previous, brackets[i].c);
+        previous = brackets[i].index;
+        GapTreapNode* nodes = index->tree.nodes;
+        i32 last = 0;
+        while (arrlist_count(spine) > 0 && nodes[arrlist_back(spine)].priority < nodes[t].priority) last = arrlist_pop(spine);
+        nodes[t].left = last;
+        if (arrlist_count(spine) > 0) nodes[arrlist_back(spine)].right = t;
+        arrlist_append(spine, t);
+    }
+    i32 root = arrlist_count(spine) > 0 ? spine[0] : 0;
+    arrlist_free(spine);
+    bracket_pull_all(&index->tree, root);
+    return root;
+}
+
+// swaps the brackets in [begin, begin + removed) of the text before an edit for brackets, which
+// are in [begin, begin + inserted) of the text after it. the brackets after move with the edit
+static void bracket_replace(BracketIndex* index, isize begin, isize removed, isize inserted, const Bracket* brackets, isize count) {
+    GapTreap* tree = &index->tree;
+    i32 l, m, r;
+    gaptreap_split(tree, tree->root, begin, &l, &r);
+    gaptreap_split(tree, r, begin + removed - tree->nodes[l].span, &m, &r);
+    i64 removed_span = tree->nodes[m].span;
+    gaptreap_release(tree, m);
+    i32 n = bracket_build(index, brackets, count, tree->nodes[l].span);
+    // r's first gap was measured from the last bracket removed, or l's last if none were
+    if (r != 0) gaptreap_shift(tree, r, removed_span - tree->nodes[n].span + inserted - removed);
+    gaptreap_set_root(tree, gaptreap_merge(tree, gaptreap_merge(tree, l, n), r));
+}
+
+// where the running depth from t's left end first goes below zero, -1 if it never does
+static i64 bracket_first_below(BracketIndex* index, i32 t) {
+    GapTreapNode* tree = index->tree.nodes;
+    BracketNode* nodes = index->nodes;
+    if (t == 0 || nodes[t].min_prefix >= 0) return -1;
+    i64 base = 0;
+    i32 depth = 0;
+    while (t != 0) {
+        GapTreapNode* node = &tree[t];
+        BracketNode* left = &nodes[node->left];
+        if (node->left != 0 && depth + left->min_prefix < 0) {
+            t = node->left;
+            continue;
+        }
+        depth += left->sum + nodes[t].delta;
+        base += tree[node->left].span + node->gap;
+        if (depth < 0) return base;
+        t = node->right;
+    }
+    return -1;
+}
+
+// the last bracket the running depth to t's right end is positive from, -1 if there's none
+static i64 bracket_last_above(BracketIndex* index, i32 t) {
+    GapTreapNode* tree = index->tree.nodes;
+    BracketNode* nodes = index->nodes;
+    if (t == 0 || nodes[t].max_suffix < 1) return -1;
+    i64 base = 0;
+    i32 need = 1;
+    while (t != 0) {
+        GapTreapNode* node = &tree[t];
+        BracketNode* right = &nodes[node->right];
+        i64 at = tree[node->left].span + node->gap;
+        if (node->right != 0 && right->max_suffix >= need) {
+            base += at;
+            t = node->right;
+            continue;
+        }
+        i32 suffix = right->sum + nodes[t].delta;
+        if (suffix >= need) return base + at;
+        need -= suffix;
+        t = node->left;
+    }
+    return -1;
+}
+
+// lexes a line starting in state and collects its brackets outside strings and comments, begin is
+// where the line starts in the text. lines without a bracket only need the state they end in
+static LexState bracket_scan_line(BracketIndex* index, LexState state, String line, isize begin) {
+    isize first = 0;
+    while (first < line.count && bracket_deltas[(u8)line.data[first]] == 0) first++;
+    if (index->language == NULL) {
+        for (isize i = first; i < line.count; i++) {
+            if (bracket_deltas[(u8)line.data[i]] != 0) arrlist_append(index->found, ((Bracket){begin + i, line.data[i]}));
+        }
+        return LEX_LINE_START;
+    }
+    if (first == line.count) return highlight_lex_line(index->language, state, line.data, line.count, NULL);
+
+    arrlist_setcount(index->spans, 0);
+    LexState end = highlight_lex_line(index->language, state, line.data, line.count, &index->spans);
+    isize span = 0;
+    isize span_count = arrlist_count(index->spans);
+    for (isize i = first; i < line.count; i++) {
+        if (bracket_deltas[(u8)line.data[i]] == 0) continue;
+        while (span < span_count && index->spans[span].end <= i) span++;
+        if (span < span_count && index->spans[span].begin <= i) {
+            HighlightKind kind = index->spans[span].kind;
+            if (kind == HIGHLIGHT_STRING || kind == HIGHLIGHT_COMMENT) continue;
+        }
+        arrlist_append(index->found, ((Bracket){begin + i, line.data[i]}));
+    }
+    return end;
+}
+
+// the line offsets aren't up to date while an edit is being handled, lines are found in the buffer
+static isize bracket_line_end(GapBuffer* gapbuf, isize begin) {
+    GapBufSlice strings = gapbuf_getstrings(gapbuf);
+    if (begin < strings.l.count) {
+        const char* newline = memchr(strings.l.data + begin, '\n', strings.l.count - begin);
+        if (newline) return newline - strings.l.data + 1;
+        begin = strings.l.count;
+    }
+    isize right = begin - strings.l.count;
+    const char* newline = memchr(strings.r.data + right, '\n', strings.r.count - right);
+    return newline ? strings.l.count + (newline - strings.r.data) + 1 : strings.l.count + strings.r.count;
+}
+
+static String bracket_bytes(BracketIndex* index, isize begin, isize end) {
+    GapBufSlice bytes = gapbuf_slice(&index->txt->gapbuf, begin, end);
+    if (bytes.r.count == 0) return bytes.l;
+    if (bytes.l.count == 0) return bytes.r;
+    string_clear(&index->straddle);
+    string_append_string(&index->straddle, bytes.l);
+    string_append_string(&index->straddle, bytes.r);
+    return string_build(index->straddle);
+}
+
+// line offsets still describe the text before the edit. the edited lines are swapped for the
+// lines the edit left and lexed, then the lines after them until one ends in the state it did
+// before, and all the brackets of those lines are replaced in one go
+static void bracket_on_edit(void* data, Text* txt, TextEdit edit) {
+    BracketIndex* index = data;
+    PROFILE_BEGIN("bracket_on_edit");
+    isize first = text_line_of(txt, edit.index);
+    isize last = text_line_of(txt, edit.index + edit.removed);
+    isize added = 0;
+    GapBufSlice inserted = gapbuf_slice(&txt->gapbuf, edit.index, edit.index + edit.inserted);
+    for (isize i = 0; i < inserted.l.count; i++) added += inserted.l.data[i] == '\n';
+    for (isize i = 0; i < inserted.r.count; i++) added += inserted.r.data[i] == '\n';
+
+    isize count = arrlist_count(index->states);
+    isize removed_lines = last - first + 1;
+    isize inserted_lines = added + 1;
+    isize new_count = count - removed_lines + inserted_lines;
+    LexState old_state = index->states[last];
+    if (removed_lines != inserted_lines) {
+        if (new_count > count) arrlist_setcount(index->states, new_count);
+        memmove(index->states + first + inserted_lines, index->states + last + 1, count - last - 1);
+        if (new_count < count) arrlist_setcount(index->states, new_count);
+    }
+
+    isize begin = first > 0 ? txt->line_offsets[first - 1] : 0;
+    isize end = begin;
+    isize last_edited = first + inserted_lines - 1;
+    LexState state = first > 0 ? index->states[first - 1] : LEX_LINE_START;
+    arrlist_setcount(index->found, 0);
+    for (isize line = first; line < new_count; line++) {
+        isize line_end = bracket_line_end(&txt->gapbuf, end);
+        state = bracket_scan_line(index, state, bracket_bytes(index, end, line_end), end);
+        end = line_end;
+        LexState before = line == last_edited ? old_state : index->states[line];
+        index->states[line] = state;
+        if (line >= last_edited && state == before) break;
+    }
+
+    isize shift = edit.inserted - edit.removed;
+    bracket_replace(index, begin, end - shift - begin, end - begin, index->found, arrlist_count(index->found));
+    PROFILE_END("bracket_on_edit");
+}
+
+static void bracket_index_rebuild(BracketIndex* index) {
+    PROFILE_BEGIN("bracket_index_rebuild");
+    Text* txt = index->txt;
+    gaptreap_clear(&index->tree);
+    arrlist_setcount(index->nodes, 0);
+    arrlist_append(index->nodes, (BracketNode){0});
+
+    isize line_count = arrlist_count(txt->line_offsets) + 1;
+    arrlist_setcount(index->states, line_count);
+    arrlist_setcount(index->found, 0);
+    LexState state = LEX_LINE_START;
+    for (isize line = 0; line < line_count; line++) {
+        isize begin = line > 0 ? txt->line_offsets[line - 1] : 0;
+        state = bracket_scan_line(index, state, text_line_string(txt, line, &index->straddle), begin);
+        index->states[line] = state;
+    }
+    gaptreap_set_root(&index->tree, bracket_build(index, index->found, arrlist_count(index->found), 0));
+    PROFILE_END("bracket_index_rebuild");
+}
+
+void bracket_index_attach(BracketIndex* index, Text* txt, const HighlightLanguage* language) {
+    bracket_index_free(index);
+    index->txt = txt;
+    gaptreap_init(&index->tree, bracket_pull, index);
+    bracket_index_set_language(index, language);
+    text_add_listener(txt, (TextListener){bracket_on_edit, index});
+}
+
+void bracket_index_set_language(BracketIndex* index, const HighlightLanguage* language) {
+    index->language = language;
+    bracket_index_rebuild(index);
+}
+
+void bracket_index_free(BracketIndex* index) {
+    if (index->txt) text_remove_listener(index->txt, index);
+    gaptreap_free(&index->tree);
+    arrlist_free(index->nodes);
+    arrlist_free(index->states);
+    arrlist_free(index->found);
+    arrlist_free(index->spans);
+    string_free(&index->straddle);
+    *index = (BracketIndex){0};
+}
+
+isize bracket_index_count(BracketIndex* index) {
+    return gaptreap_count(&index->tree);
+}
+
+// the bracket at at is split out on its own, the opener's match is in what comes after it and the
+// closer's in what comes before, then the tree is put back together
+isize bracket_index_match(BracketIndex* index, isize at) {
+    if (index->txt == NULL || at < 0) return -1;
+    GapTreap* tree = &index->tree;
+    i32 l, m, r;
+    gaptreap_split(tree, tree->root, at, &l, &r);
+    gaptreap_split(tree, r, at + 1 - tree->nodes[l].span, &m, &r);
+    isize match = -1;
+    if (m != 0 && index->nodes[m].delta > 0) {
+        i64 after = bracket_first_below(index, r);
+        if (after >= 0) match = at + after;
+    } else if (m != 0) {
+        match = bracket_last_above(index, l);
+    }
+    gaptreap_set_root(tree, gaptreap_merge(tree, gaptreap_merge(tree, l, m), r));
+    return match;
+}
+
+bool bracket_index_near(BracketIndex* index, isize cursor, isize* at, isize* match) {
+    for (isize i = cursor; i >= cursor - 1; i--) {
+        isize found = bracket_index_match(index, i);
+        if (found >= 0) {
+            *at = i;
+            *match = found;
+            return true;
+        }
+    }
+    return false;
+}
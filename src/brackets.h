@@ -0,0 +1,59 @@
+#ifndef BRACKETS_H_
+#define BRACKETS_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "highlight.h"
+#include "gaptreap.h"
+
+// every (, [ and { and its closer outside strings and comments, kept in a treap in text order so
+// the bracket matching any other is found in O(log n) however big the file is.
+//
+// the brackets are nodes of a gap treap (gaptreap.h), so an edit moves everything after it by
+// changing one gap. every subtree also knows its depth change (+1 per opener, -1 per closer)
+// and the lowest and highest the running depth gets from its left and right end, the match of an
+// opener is the first bracket after it where the depth drops below the opener's, found in a
+// single walk down the tree. edits lex the edited lines again with the language's tables, and the
+// lines after them until one ends in the state it did before, the same way the highlighter does
+
+// the depths of a bracket's subtree, kept next to the tree's nodes
+typedef struct BracketNode {
+    i32 sum;        // depth change of the subtree
+    i32 min_prefix; // lowest running depth from the subtree's left end
+    i32 max_suffix; // highest running depth from the subtree's right end
+    i8 delta;       // +1 for an opener, -1 for a closer
+} BracketNode;
+
+typedef struct Bracket {
+    isize index;
+    char c;
+} Bracket;
+
+typedef struct BracketIndex {
+    Text* txt;
+    const HighlightLanguage* language; // every bracket counts without one
+    GapTreap tree;
+    BracketNode* nodes; // arraylist, indexed like the tree's nodes
+    LexState* states;   // arraylist, the lexer state at the end of every line
+    // scratch for lexing
+    Bracket* found;
+    HighlightSpan* spans;
+    StringBuilder straddle;
+} BracketIndex;
+
+// indexes every bracket of txt and keeps up with its edits
+void bracket_index_attach(BracketIndex* index, Text* txt, const HighlightLanguage* language);
+// switches language and indexes everything again
+void bracket_index_set_language(BracketIndex* index, const HighlightLanguage* language);
+void bracket_index_free(BracketIndex* index);
+
+// how many brackets outside strings and comments the text has
+isize bracket_index_count(BracketIndex* index);
+// where the bracket matching the one at at is, -1 when there's no indexed bracket at at or it's
+// never closed (or opened). brackets of different kinds still match, ( with ] is for the caller to flag
+isize bracket_index_match(BracketIndex* index, isize at);
+// the bracket just after the cursor, or failing that just before it, and its match. false if
+// neither is a bracket with a match
+bool bracket_index_near(BracketIndex* index, isize cursor, isize* at, isize* match);
+
+#endif //BRACKETS_H_
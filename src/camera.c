@@ -1,82 +1,167 @@
 #include "camera.h"
+#include "profiler.h"
+#include "rlgl.h"
 #include <math.h>
+#include <stdlib.h>
+#include <assert.h>
 
 static Color cursor_colour = {.r = 0x0a, .g = 0x0a, .b = 0x1a, .a = 0xff};
 static Color text_colour = {.r = 0x05, .g = 0x05, .b = 0x05, .a = 0xff};
 static Color highlight_colour = {.r = 0x6a, .g = 0x83, .b = 0xfc, .a = 0xff};
+static Color match_colour = {.r = 0xf5, .g = 0xd7, .b = 0x6e, .a = 0xff};
+static Color watch_colour = {.r = 0xb5, .g = 0xe8, .b = 0xb0, .a = 0xff};
+static Color bracket_colour = {.r = 0x40, .g = 0x40, .b = 0x40, .a = 0xff};
+static Color mismatch_colour = {.r = 0xe0, .g = 0x30, .b = 0x30, .a = 0xff};
+static Color bookmark_colour = {.r = 0x1f, .g = 0x3f, .b = 0xb5, .a = 0xff};
+static Color syntax_colours[HIGHLIGHT_KIND_COUNT] = {
+    [HIGHLIGHT_TEXT] = {.r = 0x05, .g = 0x05, .b = 0x05, .a = 0xff},
+    [HIGHLIGHT_KEYWORD] = {.r = 0x1f, .g = 0x3f, .b = 0xb5, .a = 0xff},
+    [HIGHLIGHT_TYPE] = {.r = 0x0f, .g = 0x7a, .b = 0x7a, .a = 0xff},
+    [HIGHLIGHT_NUMBER] = {.r = 0xa3, .g = 0x4a, .b = 0x00, .a = 0xff},
+    [HIGHLIGHT_STRING] = {.r = 0x2e, .g = 0x7d, .b = 0x32, .a = 0xff},
+    [HIGHLIGHT_COMMENT] = {.r = 0x80, .g = 0x80, .b = 0x80, .a = 0xff},
+    [HIGHLIGHT_PREPROCESSOR] = {.r = 0x8e, .g = 0x24, .b = 0xaa, .a = 0xff},
+    [HIGHLIGHT_IDENTIFIER] = {.r = 0x05, .g = 0x05, .b = 0x05, .a = 0xff},
+};
 
-TextCamera camera_default() {
-    return (TextCamera) {
-        .max_cols = 80,
-        .padding = 5.0,
-        .spacing = 1.0,
-
-        .left_margin = 20.0,
-        .bottom_margin = 10.0,
-    };
+void glyph_atlas_load(GlyphAtlas* atlas, const char* filename, int font_size) {
+    atlas->font = LoadFontEx(filename, font_size, NULL, 0);
+    atlas->file_data = LoadFileData(filename, &atlas->file_size);
+    glyph_cache_init(&atlas->cache, GLYPH_PAGE_SIZE, GLYPH_PAGE_MAX);
 }
 
-Codepoint camera_next_char(TextCamera* camera, Text* txt, Font font, CameraPosition* pos) {
-    float screen_width = GetScreenWidth();
-    float screen_height = GetScreenHeight();
-
-    float bottom = screen_height - camera->padding - camera->bottom_margin;
+void glyph_atlas_unload(GlyphAtlas* atlas) {
+    for (isize i = 0; i < GLYPH_PAGE_MAX; i++) {
+        if (atlas->pages[i].id != 0) UnloadTexture(atlas->pages[i]);
+    }
+    glyph_cache_free(&atlas->cache);
+    UnloadFileData(atlas->file_data);
+    UnloadFont(atlas->font);
+    *atlas = (GlyphAtlas){0};
+}
 
-    Codepoint c = gapbuf_next_codepoint(&txt->gapbuf, &pos->index);
+void glyph_atlas_next_frame(GlyphAtlas* atlas) {
+    glyph_cache_next_frame(&atlas->cache);
+}
 
-    if (c != '\n') {
-        pos->col++;
-        pos->screen_col++;
+// the index of the codepoint's glyph in the font loaded with the file, -1 when it isn't one of them
+static isize glyph_atlas_font_index(GlyphAtlas* atlas, Codepoint c) {
+    isize index = GetGlyphIndex(atlas->font, c);
+    return atlas->font.glyphs[index].value == (int)c ? index : -1;
+}
 
-        isize glyph_index = GetGlyphIndex(font, c);
-        pos->width = 0;
-        if (font.glyphs[glyph_index].advanceX == 0) pos->width = font.recs[glyph_index].width ;
-        else pos->width = font.glyphs[glyph_index].advanceX;
-        pos->width += camera->spacing;
+// the page's pixels are zeroed, either it's new or the glyphs on it were dropped. quads drawn from
+// the old glyphs this frame are still waiting in raylib's batch, they're drawn before the pixels go
+static void glyph_atlas_clear_page(GlyphAtlas* atlas, i32 page) {
+    if (atlas->pages[page].id == 0) {
+        Image blank = GenImageColor(GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, BLANK);
+        ImageFormat(&blank, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+        atlas->pages[page] = LoadTextureFromImage(blank);
+        UnloadImage(blank);
+        return;
     }
+    rlDrawRenderBatchActive();
+    u8* zeroes = calloc(GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE, 2);
+    assert(zeroes && "calloc failed");
+    UpdateTexture(atlas->pages[page], zeroes);
+    free(zeroes);
+}
 
-    if (pos->screen_col >= camera->max_cols || pos->position.x + pos->width > screen_width - camera->padding || c == '\n') {
-        pos->screen_col = 0;
-        pos->screen_line++;
-
-        pos->position.x = camera->padding + camera->left_margin;
-        pos->position.y += font.baseSize ;
-        
-        if (c == '\n') {
-            pos->line++;
-            pos->col = 0;
+// the glyph of a codepoint outside the loaded font, rasterized and packed the first time it's asked for
+static GlyphEntry* glyph_atlas_glyph(GlyphAtlas* atlas, Codepoint c) {
+    GlyphEntry* glyph = glyph_cache_find(&atlas->cache, c);
+    if (glyph) return glyph;
+    PROFILE_BEGIN("glyph_atlas_rasterize");
+    int codepoint = c;
+    GlyphInfo* info = atlas->file_data ? LoadFontData(atlas->file_data, atlas->file_size, atlas->font.baseSize, &codepoint, 1, FONT_DEFAULT) : NULL;
+    bool missing = info == NULL || (info->image.data == NULL && info->advanceX == 0);
+    i32 width = missing || info->image.data == NULL ? 0 : info->image.width;
+    i32 height = missing || info->image.data == NULL ? 0 : info->image.height;
+    i32 cleared;
+    glyph = glyph_cache_insert(&atlas->cache, c, width, height, &cleared);
+    if (cleared >= 0) glyph_atlas_clear_page(atlas, cleared);
+    glyph->missing = missing;
+    if (missing) {
+        glyph->advance = camera_font_advance(atlas, '?');
+    } else {
+        glyph->offset_x = info->offsetX;
+        glyph->offset_y = info->offsetY;
+        glyph->advance = info->advanceX;
+    }
+    if (width > 0 && height > 0) {
+        // rasterized as grayscale, the pages are white with the coverage as alpha so tinting works
+        u8* pixels = malloc(width * height * 2);
+        assert(pixels && "malloc failed");
+        u8* coverage = info->image.data;
+        for (isize i = 0; i < width * height; i++) {
+            pixels[i * 2] = 0xff;
+            pixels[i * 2 + 1] = coverage[i];
         }
-        if (pos->position.y > bottom) return c;
+        UpdateTextureRec(atlas->pages[glyph->page], (Rectangle){glyph->x, glyph->y, width, height}, pixels);
+        free(pixels);
+    }
+    if (info) UnloadFontData(info, 1);
+    PROFILE_END("glyph_atlas_rasterize");
+    return glyph;
+}
+
+void glyph_atlas_draw(GlyphAtlas* atlas, Codepoint c, Vector2 position, Color tint) {
+    Font font = atlas->font;
+    if (glyph_atlas_font_index(atlas, c) >= 0) {
+        DrawTextCodepoint(font, c, position, font.baseSize, tint);
+        return;
+    }
+    GlyphEntry* glyph = glyph_atlas_glyph(atlas, c);
+    if (glyph->missing) {
+        DrawTextCodepoint(font, '?', position, font.baseSize, tint);
+        return;
     }
+    if (glyph->width == 0 || glyph->height == 0) return;
+    Rectangle source = {glyph->x, glyph->y, glyph->width, glyph->height};
+    Vector2 at = {position.x + glyph->offset_x, position.y + glyph->offset_y};
+    DrawTextureRec(atlas->pages[glyph->page], source, at, tint);
+}
 
-    return c;
+// advance of the glyph, falls back to the glyph's width for fonts without advances
+float camera_font_advance(void* atlas_ptr, Codepoint c) {
+    GlyphAtlas* atlas = atlas_ptr;
+    Font* font = &atlas->font;
+    isize glyph_index = glyph_atlas_font_index(atlas, c);
+    if (glyph_index < 0) return glyph_atlas_glyph(atlas, c)->advance;
+    if (font->glyphs[glyph_index].advanceX == 0) return font->recs[glyph_index].width;
+    return font->glyphs[glyph_index].advanceX;
+}
+FontMetrics camera_font_metrics(GlyphAtlas* atlas) {
+    return (FontMetrics) {
+        .font = atlas,
+        .advance = camera_font_advance,
+        .line_height = atlas->font.baseSize,
+    };
 }
-MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, Font font) {
+
+MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, WrapIndex* wrap, GlyphAtlas* atlas) {
+    PROFILE_BEGIN("camera_mouse_pos");
     MouseCursorPosition mouse_pos = {0};
-    float screen_width = GetScreenWidth();
-    float screen_height = GetScreenHeight();
+    Font font = atlas->font;
+    FontMetrics metrics = camera_font_metrics(atlas);
+    float screen_width = camera->width - camera->right_margin;
+    float screen_height = camera->height;
 
     Vector2 mpos = GetMousePosition();
 
     float bottom = screen_height - camera->padding - camera->bottom_margin;
 
-    if (camera->row < 0) camera->row = 0;
-    if (camera->row > arrlist_count(txt->line_offsets)) camera->row = arrlist_count(txt->line_offsets);
-
-    CameraPosition pos = {
-        .position = {camera->padding + camera->left_margin, .y = camera->padding},
-        .line = camera->row,
-    };
+    CameraPosition pos = camera_start_position(camera, txt, wrap);
     isize line = pos.screen_line;
     isize old_line = pos.line;
     isize old_col = pos.col;
-    Vector2 old_pos = pos.position;
-    for (pos.index = camera->row != 0 ? txt->line_offsets[camera->row - 1] : 0; pos.index < gapbuf_count(&txt->gapbuf) && pos.position.y + font.baseSize < bottom;) {
+    LayoutVector old_pos = pos.position;
+    for (; pos.index < gapbuf_count(&txt->gapbuf) && pos.position.y + font.baseSize < bottom;) {
         line = pos.screen_line;
         old_line = pos.line;
         old_col = pos.col;
         old_pos = pos.position;
-        Codepoint c = camera_next_char(camera, txt, font, &pos);
+        Codepoint c = camera_next_char(camera, txt, metrics, &pos);
         
         Rectangle char_rect = {pos.position.x, pos.position.y, pos.width, font.baseSize};
         if (CheckCollisionPointRec(mpos, char_rect)) {
@@ -91,6 +176,8 @@ MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, Font font) {
             mouse_pos.exists = true;
             mouse_pos.pos.line = pos.line;
             
+            PROFILE_END("camera_mouse_pos");
+            
             return mouse_pos;
         }
         Rectangle line_rect = {camera->padding + camera->left_margin, old_pos.y, screen_width - line_rect.x, font.baseSize};
@@ -101,6 +188,7 @@ MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, Font font) {
             mouse_pos.exists = true;
             mouse_pos.pos.line = old_line;
             mouse_pos.pos.col = old_col;
+            PROFILE_END("camera_mouse_pos");
             return mouse_pos;
         }
         if (c != '\r' && c != '\n') {
@@ -115,19 +203,27 @@ MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, Font font) {
         mouse_pos.exists = true;
         mouse_pos.pos.line = pos.line;
         mouse_pos.pos.col = pos.col;
+        PROFILE_END("camera_mouse_pos");
         return mouse_pos;
     }
+    PROFILE_END("camera_mouse_pos");
     return mouse_pos;
 }
-void camera_draw(TextCamera* camera, Text* txt, Font font) {
-    //float screen_width = GetScreenWidth();
-    float screen_height = GetScreenHeight();
+void camera_draw(Editor* editor, GlyphAtlas* atlas) {
+    PROFILE_BEGIN("camera_draw");
+    Font font = atlas->font;
+    TextCamera* camera = &editor->camera;
+    Text* txt = &editor->txt;
+    MatchIndex* matches = &editor->find.matches;
+    Watchlist* watchlist = &editor->watchlist;
+    FontMetrics metrics = camera_font_metrics(atlas);
+    float screen_height = camera->height;
     
     
     float bottom = screen_height - camera->padding - camera->bottom_margin;
-    
-    if (camera->row < 0) camera->row = 0;
-    if (camera->row > arrlist_count(txt->line_offsets)) camera->row = arrlist_count(txt->line_offsets);
+
+    // the rows only have to be counted again when the window or the font changed since the last frame
+    wrap_index_configure(&editor->wrap, camera, metrics);
 
     isize l, r;
     if (txt->selection_begin < txt->selection_end) {
@@ -138,53 +234,123 @@ void camera_draw(TextCamera* camera, Text* txt, Font font) {
         r = txt->selection_begin;
     }
 
-    CameraPosition pos = {
-        .position = {camera->padding + camera->left_margin, .y = camera->padding},
-        .line = camera->row,
-    };
+    CameraPosition pos = camera_start_position(camera, txt, &editor->wrap);
+    // the matches are sorted so only the first visible one is searched for, the rest follow in order
+    isize match = 0, match_count = 0;
+    if (matches->valid) {
+        match = match_index_find(matches, pos.index);
+        match_count = arrlist_count(matches->matches);
+    }
+    // the watchlist is looked up once per line, its spans are relative to where the line starts
+    WatchLine* watch_line = NULL;
+    isize watch_line_begin = pos.index;
+    isize watch_span = 0;
+    // the extra cursors are sorted too, the selections are drawn here and the carets with the text
+    TextCursor* cursors = txt->cursors;
+    isize cursor_count = arrlist_count(cursors);
+    isize cursor = 0;
+    // the bracket at the cursor and its match are boxed, in red when they're different kinds
+    isize bracket_at = -1, bracket_match = -1;
+    Color bracket_box = bracket_colour;
+    if (bracket_index_near(&editor->brackets, text_cursor_idx(txt), &bracket_at, &bracket_match)) {
+        char open = gapbuf_get(&txt->gapbuf, bracket_at < bracket_match ? bracket_at : bracket_match);
+        char close = gapbuf_get(&txt->gapbuf, bracket_at < bracket_match ? bracket_match : bracket_at);
+        if (!((open == '(' && close == ')') || (open == '[' && close == ']') || (open == '{' && close == '}'))) bracket_box = mismatch_colour;
+    }
 
-    for (pos.index = camera->row != 0 ? txt->line_offsets[camera->row - 1] : 0; pos.index < gapbuf_count(&txt->gapbuf) && pos.position.y + font.baseSize < bottom;) {
-        Codepoint c = camera_next_char(camera, txt, font, &pos);
+    for (; pos.index < gapbuf_count(&txt->gapbuf) && pos.position.y + font.baseSize < bottom;) {
+        isize char_index = pos.index;
+        isize char_line = pos.line;
+        Codepoint c = camera_next_char(camera, txt, metrics, &pos);
     
         if (c != '\r' && c != '\n') {
+            if (watchlist->active) {
+                if (watch_line == NULL || watch_line->line != char_line) {
+                    watch_line = watchlist_line(watchlist, char_line);
+                    watch_line_begin = char_line > 0 ? txt->line_offsets[char_line - 1] : 0;
+                    watch_span = 0;
+                }
+                isize offset = char_index - watch_line_begin;
+                isize span_count = arrlist_count(watch_line->spans);
+                while (watch_span < span_count && watch_line->spans[watch_span].end <= offset) watch_span++;
+                if (watch_span < span_count && watch_line->spans[watch_span].begin <= offset) {
+                    DrawRectangle(pos.position.x, pos.position.y, pos.width, font.baseSize, watch_colour);
+                }
+            }
+            while (match < match_count && matches->matches[match].end <= char_index) match++;
+            if (match < match_count && matches->matches[match].begin <= char_index) {
+                DrawRectangle(pos.position.x, pos.position.y, pos.width, font.baseSize, match_colour);
+            }
             if (pos.index > l && pos.index <= r && txt->selected) {
                 DrawRectangle(pos.position.x, pos.position.y, pos.width, font.baseSize, highlight_colour);
             }
+            while (cursor < cursor_count && TEXT_CURSOR_HI(cursors[cursor]) <= char_index) cursor++;
+            if (cursor < cursor_count && TEXT_CURSOR_LO(cursors[cursor]) <= char_index) {
+                DrawRectangle(pos.position.x, pos.position.y, pos.width, font.baseSize, highlight_colour);
+            }
+            if (char_index == bracket_at || char_index == bracket_match) {
+                DrawRectangleLines(pos.position.x, pos.position.y, pos.width, font.baseSize, bracket_box);
+            }
             pos.position.x += pos.width;
         }
     }
 
-    CameraPosition pos2 = {
-        .position = {camera->padding + camera->left_margin, .y = camera->padding},
-        .line = camera->row,
-    };
+    CameraPosition pos2 = camera_start_position(camera, txt, &editor->wrap);
 
-    for (pos2.index = camera->row != 0 ? txt->line_offsets[camera->row - 1] : 0; pos2.index < gapbuf_count(&txt->gapbuf) && pos2.position.y + font.baseSize < bottom;) {
+    for (; pos2.index < gapbuf_count(&txt->gapbuf) && pos2.position.y + font.baseSize < bottom;) {
         if (pos2.col == 0) {
-            DrawTextEx(font, TextFormat("%d", pos2.line + 1), (Vector2){.x = camera->padding, .y = pos2.position.y}, font.baseSize, camera->spacing, text_colour);
+            // a bookmarked line's number is coloured
+            isize line_end = pos2.line < arrlist_count(txt->line_offsets) ? txt->line_offsets[pos2.line] : gapbuf_count(&txt->gapbuf) + 1;
+            isize bookmark_at;
+            bool bookmarked = marker_next(&editor->bookmarks, pos2.index, &bookmark_at) != 0 && bookmark_at < line_end;
+            DrawTextEx(font, TextFormat("%d", pos2.line + 1), (Vector2){.x = camera->padding, .y = pos2.position.y}, font.baseSize, camera->spacing, bookmarked ? bookmark_colour : text_colour);
         }
-        Codepoint c = camera_next_char(camera, txt, font, &pos2);
+        Codepoint c = camera_next_char(camera, txt, metrics, &pos2);
         if (c != '\r' && c != '\n') {
-            pos.position.x += pos.width;
+            pos2.position.x += pos2.width;
         }
     }
 
-    CameraPosition pos3 = {
-        .position = {camera->padding + camera->left_margin, .y = camera->padding},
-        .line = camera->row,
-    };
+    CameraPosition pos3 = camera_start_position(camera, txt, &editor->wrap);
 
     
 
-    for (pos3.index = camera->row != 0 ? txt->line_offsets[camera->row - 1] : 0; pos3.index < gapbuf_count(&txt->gapbuf) && pos3.position.y + font.baseSize < bottom;) {
+    // only the lines drawn are lexed, each one once
+    Highlighter* highlighter = &editor->highlighter;
+    HighlightSpan* syntax = NULL;
+    isize syntax_line = -1;
+    isize syntax_line_begin = 0;
+    isize syntax_span = 0;
+    isize caret = 0;
+
+    for (; pos3.index < gapbuf_count(&txt->gapbuf) && pos3.position.y + font.baseSize < bottom;) {
         if (pos3.line == txt->cursor_line && pos3.col == txt->cursor_col) {
             DrawRectangle(pos3.position.x, pos3.position.y, 2, font.baseSize, cursor_colour);
         }
+        while (caret < cursor_count && cursors[caret].head < pos3.index) caret++;
+        if (caret < cursor_count && cursors[caret].head == pos3.index) {
+            DrawRectangle(pos3.position.x, pos3.position.y, 2, font.baseSize, cursor_colour);
+        }
         
-        Codepoint c = camera_next_char(camera, txt, font, &pos3);
+        isize char_index = pos3.index;
+        isize char_line = pos3.line;
+        Codepoint c = camera_next_char(camera, txt, metrics, &pos3);
     
         if (c != '\r' && c != '\n') {
-            DrawTextCodepoint(font, c, pos3.position, font.baseSize, text_colour);
+            Color colour = text_colour;
+            if (highlighter->language) {
+                if (char_line != syntax_line) {
+                    syntax = highlight_line(highlighter, char_line);
+                    syntax_line = char_line;
+                    syntax_line_begin = char_line > 0 ? txt->line_offsets[char_line - 1] : 0;
+                    syntax_span = 0;
+                }
+                isize offset = char_index - syntax_line_begin;
+                isize span_count = arrlist_count(syntax);
+                while (syntax_span < span_count && syntax[syntax_span].end <= offset) syntax_span++;
+                if (syntax_span < span_count && syntax[syntax_span].begin <= offset) colour = syntax_colours[syntax[syntax_span].kind];
+            }
+            glyph_atlas_draw(atlas, c, (Vector2){pos3.position.x, pos3.position.y}, colour);
             pos3.position.x += pos3.width;
         }
     }
@@ -197,5 +363,88 @@ void camera_draw(TextCamera* camera, Text* txt, Font font) {
         if (pos3.line == txt->cursor_line && pos3.col == txt->cursor_col) {
             DrawRectangle(pos3.position.x, pos3.position.y, 2, font.baseSize , cursor_colour);
         }
+        while (caret < cursor_count && cursors[caret].head < pos3.index) caret++;
+        if (caret < cursor_count && cursors[caret].head == pos3.index) {
+            DrawRectangle(pos3.position.x, pos3.position.y, 2, font.baseSize, cursor_colour);
+        }
+    }
+    PROFILE_END("camera_draw");
+}
+
+static Color minimap_background = {.r = 0xf4, .g = 0xf4, .b = 0xf4, .a = 0xff};
+static Color minimap_view_colour = {.r = 0x6a, .g = 0x83, .b = 0xfc, .a = 0x40};
+
+static Rectangle camera_minimap_rect(TextCamera* camera) {
+    float width = MINIMAP_CELLS * MINIMAP_PIXEL_WIDTH;
+    return (Rectangle){camera->width - width, 0, width, camera->height - camera->bottom_margin};
+}
+
+// the pixels are only built again when the rows changed or the panel scrolled, and then only the
+// panel's rows of the cache are read
+void camera_draw_minimap(Editor* editor, MinimapView* view, Font font) {
+    PROFILE_BEGIN("camera_draw_minimap");
+    TextCamera* camera = &editor->camera;
+    Minimap* map = &editor->minimap;
+    Rectangle rect = camera_minimap_rect(camera);
+    isize rows = rect.height > 0 ? rect.height : 0;
+    isize top = minimap_top(map, camera->row, rows);
+    isize lines = minimap_lines(map);
+
+    if (view->rows != rows || view->pixels == NULL) {
+        if (view->pixels) UnloadTexture(view->texture);
+        free(view->pixels);
+        view->pixels = NULL;
+        view->rows = rows;
+        if (rows > 0) {
+            view->pixels = calloc(rows * MINIMAP_CELLS, sizeof(Color));
+            assert(view->pixels && "calloc failed");
+            Image image = {view->pixels, MINIMAP_CELLS, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            view->texture = LoadTextureFromImage(image);
+        }
+        view->version = map->version - 1;
     }
-}
\ No newline at end of file
+    if (view->pixels == NULL) {
+        PROFILE_END("camera_draw_minimap");
+        return;
+    }
+    if (view->top != top || view->version != map->version) {
+        view->top = top;
+        view->version = map->version;
+        for (isize y = 0; y < rows; y++) {
+            Color* pixels = view->pixels + y * MINIMAP_CELLS;
+            if (top + y >= lines) {
+                for (isize x = 0; x < MINIMAP_CELLS; x++) pixels[x] = minimap_background;
+                continue;
+            }
+            MinimapCell* cells = minimap_row(map, top + y);
+            for (isize x = 0; x < MINIMAP_CELLS; x++) {
+                // the ink is mixed into the background, a full cell is the kind's colour
+                Color ink = syntax_colours[MINIMAP_KIND(cells[x])];
+                float alpha = MINIMAP_INK(cells[x]) / (float)MINIMAP_CELL_COLS;
+                pixels[x] = (Color){
+                    .r = minimap_background.r + (ink.r - minimap_background.r) * alpha,
+                    .g = minimap_background.g + (ink.g - minimap_background.g) * alpha,
+                    .b = minimap_background.b + (ink.b - minimap_background.b) * alpha,
+                    .a = 0xff,
+                };
+            }
+        }
+        UpdateTexture(view->texture, view->pixels);
+    }
+    DrawTexturePro(view->texture, (Rectangle){0, 0, MINIMAP_CELLS, rows}, (Rectangle){rect.x, rect.y, rect.width, rows}, (Vector2){0}, 0, WHITE);
+
+    // the lines the camera shows, a line per row of text though wrapped ones take more
+    isize visible = rect.height / font.baseSize;
+    DrawRectangle(rect.x, camera->row - top, rect.width, visible > 1 ? visible : 1, minimap_view_colour);
+    PROFILE_END("camera_draw_minimap");
+}
+
+isize camera_minimap_line(Editor* editor, Vector2 mouse) {
+    TextCamera* camera = &editor->camera;
+    Rectangle rect = camera_minimap_rect(camera);
+    if (camera->right_margin == 0 || !CheckCollisionPointRec(mouse, rect)) return -1;
+    isize top = minimap_top(&editor->minimap, camera->row, rect.height);
+    isize line = top + (isize)(mouse.y - rect.y);
+    isize lines = minimap_lines(&editor->minimap);
+    return line < lines ? line : lines - 1;
+}
@@ -1,35 +1,51 @@
+#ifndef CAMERA_H_
+#define CAMERA_H_
+
 #include <raylib.h>
 #include "short_types.h"
 #include "text.h"
-
-typedef struct MouseCursorPosition {
-    CursorPosition pos;
-    bool exists;
-} MouseCursorPosition;
-
-typedef struct TextCamera {
-    isize row;
-
-    float padding;
-    float left_margin;
-    float bottom_margin;
-
-    float spacing;
-    int max_cols;
-} TextCamera;
-
-typedef struct CameraPosition {
-    isize line, col;
-    isize screen_line, screen_col;
-
-    isize index;
-    Vector2 position;
-    float width;
-} CameraPosition;
-
-TextCamera camera_default();
-
-Codepoint camera_next_char(TextCamera* camera, Text* txt, Font font, CameraPosition* pos);
-
-MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, Font font);
-void camera_draw(TextCamera* camera, Text* txt, Font font);
\ No newline at end of file
+#include "layout.h"
+#include "editor.h"
+#include "glyphcache.h"
+
+// the font rasterized as it's drawn. printable ascii comes with the font at load, every other
+// codepoint is rasterized from the font file the first time it's laid out and packed into pages
+// the glyph cache keeps track of
+typedef struct GlyphAtlas {
+    Font font;                           // printable ascii, and '?' for codepoints the file has no glyph for
+    unsigned char* file_data;            // the font file, kept for rasterizing
+    int file_size;
+    GlyphCache cache;
+    Texture2D pages[GLYPH_PAGE_MAX];     // id 0 until the cache first packs glyphs onto the page
+} GlyphAtlas;
+
+void glyph_atlas_load(GlyphAtlas* atlas, const char* filename, int font_size);
+void glyph_atlas_unload(GlyphAtlas* atlas);
+// called once a frame before drawing, see glyph_cache_next_frame
+void glyph_atlas_next_frame(GlyphAtlas* atlas);
+void glyph_atlas_draw(GlyphAtlas* atlas, Codepoint c, Vector2 position, Color tint);
+
+FontMetrics camera_font_metrics(GlyphAtlas* atlas);
+float camera_font_advance(void* atlas, Codepoint c);
+
+MouseCursorPosition camera_mouse_pos(TextCamera* camera, Text* txt, WrapIndex* wrap, GlyphAtlas* atlas);
+// find matches and watchlist patterns are highlighted behind the text
+void camera_draw(Editor* editor, GlyphAtlas* atlas);
+
+#define MINIMAP_PIXEL_WIDTH 2 // screen pixels per minimap cell, the panel is MINIMAP_CELLS of them wide
+
+// the frontend's texture of the minimap rows on screen
+typedef struct MinimapView {
+    Texture2D texture;
+    Color* pixels; // MINIMAP_CELLS for every row of the panel
+    isize rows;
+    isize top;
+    u64 version;
+} MinimapView;
+
+// draws the panel at the right edge of the window, camera.right_margin keeps the text out of it
+void camera_draw_minimap(Editor* editor, MinimapView* view, Font font);
+// the line of the minimap under the mouse, -1 when it isn't over the panel
+isize camera_minimap_line(Editor* editor, Vector2 mouse);
+
+#endif //CAMERA_H_
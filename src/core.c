@@ -0,0 +1,10 @@
+// implementations of the single header libraries used by the editing core
+// compiled into libeditcore so neither the core nor the frontend define them twice
+#define STRINGBUILDER_IMPLEMENTATION
+#include "stringbuilder.h"
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#define ARRAYLIST_IMPLEMENTATION
+#include "arraylist.h"
+#define GAPBUFFER_IMPLEMENTATION
+#include "gapbuffer.h"
@@ -0,0 +1,625 @@
+#include "editor.h"
+#include "searcher.h"
+#include "search.h"
+#include "arraylist.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool still_word(Codepoint c) {
+    if (string_is_ascii_alpha(c) || string_is_digit(c, NULL) || c == '_') {
+        return false;
+    }
+    return true;
+}
+
+bool is_alpha_numeric(Codepoint c) {
+    if (string_is_ascii_alpha(c) || string_is_digit(c, NULL) || c == '_') {
+        return true;
+    }
+    return false;
+}
+
+// inserts everything typed in a frame at once, the streak is decided by the first
+// character and continued from the last one
+void type_string(Text* txt, UndoStreak* streak, String s) {
+    if (s.count == 0) return;
+
+    if (streak->alpha_num && is_alpha_numeric(s.data[0])) {}
+    else if (streak->space && string_is_ascii_whitespace(s.data[0])) {}
+    else text_begin_command(txt);
+
+    text_cursor_insert(txt, s);
+
+    char last = s.data[s.count - 1];
+    *streak = (UndoStreak) {
+        .alpha_num = is_alpha_numeric(last),
+        .space = string_is_ascii_whitespace(last),
+    };
+}
+
+// modifiers and the key events of printable keys (their text arrives as a separate
+// codepoint event) don't act on the text so they shouldn't split a batch of typing
+bool is_passive_key(int key, bool cntrl) {
+    if (key >= INPUT_KEY_LEFT_SHIFT && key <= INPUT_KEY_RIGHT_SUPER) return true;
+    if (key >= INPUT_KEY_SPACE && key <= INPUT_KEY_GRAVE && !cntrl) return true;
+    if (key >= INPUT_KEY_KP_0 && key <= INPUT_KEY_KP_EQUAL) return true;
+    return false;
+}
+
+static bool editor_flush_typed(Editor* editor) {
+    if (editor->typed.count == 0) return false;
+    if (arrlist_count(editor->txt.cursors) > 0) {
+        text_cursors_insert(&editor->txt, string_build(editor->typed));
+        editor->streak = (UndoStreak){0};
+    } else {
+        type_string(&editor->txt, &editor->streak, string_build(editor->typed));
+    }
+    string_clear(&editor->typed);
+    return true;
+}
+
+// ctrl + d selects the word at the cursor, then every press adds a cursor at the next occurrence of
+// the selection. with shift every occurrence gets a cursor at once
+static void editor_add_occurrences(Editor* editor, bool every) {
+    Text* txt = &editor->txt;
+    GapBuffer* gapbuf = &txt->gapbuf;
+    isize lo = txt->selection_begin < txt->selection_end ? txt->selection_begin : txt->selection_end;
+    isize hi = txt->selection_begin < txt->selection_end ? txt->selection_end : txt->selection_begin;
+    if (!txt->selected || lo == hi) {
+        lo = hi = text_cursor_idx(txt);
+        while (lo > 0 && is_alpha_numeric(gapbuf_get(gapbuf, lo - 1))) lo--;
+        while (hi < gapbuf_count(gapbuf) && is_alpha_numeric(gapbuf_get(gapbuf, hi))) hi++;
+        if (lo == hi) return;
+        text_select_range(txt, lo, hi);
+        if (!every) return;
+    }
+
+    StringBuilder needle = {0};
+    GapBufSlice selected = gapbuf_slice(gapbuf, lo, hi);
+    string_append_string(&needle, selected.l);
+    string_append_string(&needle, selected.r);
+    String word = string_build(needle);
+    if (every) {
+        for (isize at = search_find(gapbuf, word, 0); at >= 0; at = search_find(gapbuf, word, at + word.count)) {
+            if (at != lo) text_add_cursor(txt, at, at + word.count);
+        }
+    } else {
+        isize at = search_find(gapbuf, word, hi);
+        if (at < 0) at = search_find(gapbuf, word, 0);
+        // the selection so far becomes an extra cursor and the gap's cursor selects the new one
+        if (at >= 0 && at != lo) {
+            text_add_cursor(txt, lo, hi);
+            text_select_range(txt, at, at + word.count);
+        }
+    }
+    string_free(&needle);
+}
+
+// a bookmark is a marker anywhere on its line, it's added at the line's start and moves with the
+// edits before it. ctrl + b takes the cursor's line's bookmark away or adds one
+static void editor_toggle_bookmark(Editor* editor) {
+    Text* txt = &editor->txt;
+    MarkerSet* bookmarks = &editor->bookmarks;
+    if (bookmarks->txt == NULL) marker_set_attach(bookmarks, txt);
+    isize line = text_line_of(txt, text_cursor_idx(txt));
+    isize begin = line > 0 ? txt->line_offsets[line - 1] : 0;
+    isize end = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf) + 1;
+    isize at;
+    Marker bookmark = marker_next(bookmarks, begin, &at);
+    if (bookmark != 0 && at < end) marker_remove(bookmarks, bookmark);
+    else marker_add(bookmarks, begin);
+}
+
+// f2 goes to the first bookmark after the cursor's line, from the top again past the last one
+static bool editor_next_bookmark(Editor* editor) {
+    Text* txt = &editor->txt;
+    MarkerSet* bookmarks = &editor->bookmarks;
+    isize line = text_line_of(txt, text_cursor_idx(txt));
+    isize from = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf) + 1;
+    isize at;
+    if (marker_next(bookmarks, from, &at) == 0 && marker_next(bookmarks, 0, &at) == 0) return false;
+    isize bookmark_line = text_line_of(txt, at);
+    at = bookmark_line > 0 ? txt->line_offsets[bookmark_line - 1] : 0;
+    text_cursor_move(txt, at - text_cursor_idx(txt));
+    return true;
+}
+
+// alt + shift + arrows start a block at the cursor or move the corner of the one being made
+static void editor_extend_block(Editor* editor, int key) {
+    Text* txt = &editor->txt;
+    EditorBlock* block = &editor->block;
+    if (!block->active) {
+        text_cursor_update_position(txt);
+        *block = (EditorBlock){true, txt->cursor_line, txt->cursor_col, txt->cursor_line, txt->cursor_col};
+    }
+    if (key == INPUT_KEY_UP && block->head_line > 0) block->head_line--;
+    if (key == INPUT_KEY_DOWN && block->head_line < arrlist_count(txt->line_offsets)) block->head_line++;
+    if (key == INPUT_KEY_LEFT && block->head_col > 0) block->head_col--;
+    if (key == INPUT_KEY_RIGHT) block->head_col++;
+    text_select_block(txt, block->anchor_line, block->anchor_col, block->head_line, block->head_col);
+}
+
+// indexes every match of the query, small buffers right away and big ones on the searcher's thread
+static void editor_find_index(Editor* editor) {
+    Find* find = &editor->find;
+    Text* txt = &editor->txt;
+    String query = string_build(find->query);
+    bool edited = find->restart; // the index is from before the edit, there's nothing to filter
+    find->restart = false;
+    // typing onto the end of the query only ever drops matches, the finished index is filtered instead
+    if (!find->regex && !edited && !searcher_running(&find->searcher) && match_index_narrow(&find->matches, &txt->gapbuf, query)) return;
+    searcher_cancel(&find->searcher);
+
+    Regex* regex = find->regex ? &find->compiled : NULL;
+    if (regex && (query.count == 0 || regex->error != NULL)) {
+        match_index_clear(&find->matches);
+    } else if (gapbuf_count(&txt->gapbuf) < SEARCHER_BACKGROUND_MIN) {
+        if (regex) match_index_build_regex(&find->matches, &txt->gapbuf, regex);
+        else match_index_build(&find->matches, &txt->gapbuf, query);
+    } else {
+        match_index_reset(&find->matches, query, regex);
+        searcher_start(&find->searcher, txt, query, find->regex);
+    }
+}
+
+// plain text matches are patched where the edit was, a search still running over the old text
+// and regex searches over big buffers start again instead. that's left for the end of the frame so
+// a frame of typing starts one search, not one for every key
+static void editor_find_on_edit(void* data, Text* txt, TextEdit edit) {
+    Editor* editor = data;
+    Find* find = &editor->find;
+    if (!find->matches.valid || find->restart) return;
+
+    if (searcher_running(&find->searcher) || (find->regex && gapbuf_count(&txt->gapbuf) >= SEARCHER_BACKGROUND_MIN)) {
+        find->restart = true;
+    } else {
+        match_index_edit(&find->matches, &txt->gapbuf, edit);
+    }
+}
+
+static void editor_find_clear(Editor* editor) {
+    searcher_cancel(&editor->find.searcher);
+    match_index_clear(&editor->find.matches);
+    editor->find.pending = false;
+}
+
+// compiles the query and indexes all of its matches, the index then follows edits by itself
+static void editor_find_rebuild(Editor* editor) {
+    Find* find = &editor->find;
+    if (!find->listening) {
+        text_add_listener(&editor->txt, (TextListener){editor_find_on_edit, editor});
+        find->listening = true;
+    }
+    if (find->regex) {
+        regex_free(&find->compiled);
+        regex_compile(&find->compiled, string_build(find->query));
+    }
+    editor_find_index(editor);
+    find->stale = false;
+}
+
+// picks the match out of the index, the first one at or after from (or the last one before from)
+// wrapping around the end of the buffer, with nothing found the cursor goes back to the origin
+static void editor_find_select_indexed(Editor* editor, isize from, bool forwards) {
+    Find* find = &editor->find;
+    Text* txt = &editor->txt;
+    MatchIndex* index = &find->matches;
+    isize count = index->valid ? arrlist_count(index->matches) : 0;
+
+    isize match = -1;
+    if (count > 0 && forwards) {
+        match = match_index_next(index, from);
+        if (match == count) match = 0;
+    } else if (count > 0) {
+        match = match_index_next(index, from) - 1;
+        if (match < 0) match = count - 1;
+    }
+
+    find->found = match >= 0;
+    if (find->found) {
+        text_select_range(txt, index->matches[match].begin, index->matches[match].end);
+    } else {
+        text_cursor_move(txt, find->origin - text_cursor_idx(txt));
+        txt->selected = false;
+    }
+}
+
+// while the searcher is still going the selection waits for the match to come in, see editor_find_poll
+static void editor_find_select(Editor* editor, isize from, bool forwards) {
+    Find* find = &editor->find;
+    if (find->stale) editor_find_rebuild(editor);
+    else if (find->restart) editor_find_index(editor);
+
+    find->pending = searcher_running(&find->searcher);
+    find->pending_from = from;
+    find->pending_forwards = forwards;
+    if (!find->pending) editor_find_select_indexed(editor, from, forwards);
+}
+
+// moves the matches the searcher found into the index, returns true if a waiting selection was made.
+// a match after the start is final as soon as it arrives, wrapping around or going back has to wait
+// until the whole buffer was searched
+static bool editor_find_poll(Editor* editor) {
+    Find* find = &editor->find;
+    if (find->restart) editor_find_index(editor); // matches of the text from before an edit are never taken in
+    bool done = searcher_poll(&find->searcher, &find->matches);
+    if (!find->pending) return false;
+
+    isize next = match_index_next(&find->matches, find->pending_from);
+    if (done || (find->pending_forwards && next < arrlist_count(find->matches.matches))) {
+        find->pending = false;
+        editor_find_select_indexed(editor, find->pending_from, find->pending_forwards);
+        return true;
+    }
+    return false;
+}
+
+// the index has every match (the searcher is finished off first), the text skips overlapping ones
+static void editor_find_replace_all(Editor* editor) {
+    Find* find = &editor->find;
+    Text* txt = &editor->txt;
+    if (find->stale) editor_find_rebuild(editor);
+    else if (find->restart) editor_find_index(editor);
+    if (searcher_running(&find->searcher)) {
+        searcher_cancel(&find->searcher);
+        if (find->regex) match_index_build_regex(&find->matches, &txt->gapbuf, &find->compiled);
+        else match_index_build(&find->matches, &txt->gapbuf, string_build(find->query));
+    }
+    if (!find->matches.valid || find->query.count == 0) return;
+
+    // the index follows the edit through the listener so it's copied out first
+    isize count = arrlist_count(find->matches.matches);
+    if (count == 0) return;
+    TextRange* ranges = malloc(count * sizeof(TextRange));
+    memcpy(ranges, find->matches.matches, count * sizeof(TextRange));
+    text_replace_all(txt, ranges, count, string_build(find->replacement));
+    free(ranges);
+
+    editor->streak = (UndoStreak){0};
+    find->pending = false;
+    find->origin = text_cursor_idx(txt);
+    editor_find_select_indexed(editor, find->origin, true);
+}
+
+// the query is kept from the last search so ctrl + f, enter finds it again
+static void editor_find_open(Editor* editor) {
+    Text* txt = &editor->txt;
+    Find* find = &editor->find;
+    find->active = true;
+    find->stale = true;
+    find->origin = text_cursor_idx(txt);
+    if (txt->selected) {
+        find->origin = txt->selection_begin < txt->selection_end ? txt->selection_begin : txt->selection_end;
+    }
+    editor_find_select(editor, find->origin, true);
+}
+
+// returns false for keys find doesn't use, those close it and act on the text as usual
+static bool editor_find_event(Editor* editor, InputEvent event, EditorInput input) {
+    Find* find = &editor->find;
+    Text* txt = &editor->txt;
+    isize match = txt->selection_begin < txt->selection_end ? txt->selection_begin : txt->selection_end;
+
+    if (event.codepoint != 0) {
+        if (input.cntrl) return true;
+        if (find->replacing) {
+            string_append(&find->replacement, event.codepoint);
+            return true;
+        }
+        string_append(&find->query, event.codepoint);
+        find->stale = true;
+        editor_find_select(editor, find->origin, true);
+        return true;
+    }
+    switch (event.key) {
+        case INPUT_KEY_BACKSPACE: {
+            if (find->replacing) {
+                if (find->replacement.count > 0) string_popn(&find->replacement, 1);
+                return true;
+            }
+            if (find->query.count > 0) string_popn(&find->query, 1);
+            find->stale = true;
+            editor_find_select(editor, find->origin, true);
+        } return true;
+        case INPUT_KEY_H: {
+            if (input.cntrl) find->replacing = !find->replacing;
+        } return true;
+        case INPUT_KEY_F3:
+        case INPUT_KEY_ENTER: {
+            if (input.cntrl && event.key == INPUT_KEY_ENTER) {
+                editor_find_replace_all(editor);
+            } else if (!find->found) {
+                editor_find_select(editor, find->origin, true);
+            } else if (input.shift) {
+                editor_find_select(editor, match, false);
+            } else {
+                editor_find_select(editor, match + 1, true);
+            }
+        } return true;
+        case INPUT_KEY_F: {
+            if (!input.cntrl) return true;
+            editor_find_select(editor, find->found ? match + 1 : find->origin, true);
+        } return true;
+        case INPUT_KEY_R: {
+            if (!input.cntrl) return true;
+            find->regex = !find->regex;
+            find->stale = true;
+            editor_find_select(editor, find->origin, true);
+        } return true;
+        case INPUT_KEY_ESCAPE: {
+            find->active = false;
+            editor_find_clear(editor);
+        } return true;
+        default: break;
+    }
+    return is_passive_key(event.key, input.cntrl);
+}
+
+// scrolls by display rows, a line that wraps takes as many steps as it's drawn on
+static void editor_scroll(Editor* editor, isize rows) {
+    TextCamera* camera = &editor->camera;
+    if (editor->wrap.configured) wrap_index_scroll(&editor->wrap, &camera->row, &camera->wrap_row, rows);
+    else camera->row += rows;
+}
+
+void editor_update(Editor* editor, EditorInput input) {
+    Text* txt = &editor->txt;
+    TextCamera* camera = &editor->camera;
+    bool cntrl = input.cntrl;
+    bool shift = input.shift;
+
+    if (input.wheel != 0) {
+        editor_scroll(editor, -(isize)input.wheel);
+    }
+
+    bool cursor_moved = false;
+    bool found_moved = editor_find_poll(editor); // the cursor followed a find match, unlike other moves this keeps the selection
+
+    for (isize i = 0; i < input.event_count; i++) {
+        InputEvent event = input.events[i];
+
+        if (editor->find.active) {
+            if (editor_find_event(editor, event, input)) {
+                found_moved = true;
+                continue;
+            }
+            editor->find.active = false;
+            editor->find.pending = false;
+        }
+
+        if (event.codepoint != 0) {
+            if (!cntrl) string_append(&editor->typed, event.codepoint);
+            continue;
+        } else if (event.key == INPUT_KEY_ENTER && !cntrl) {
+            string_append_byte(&editor->typed, '\n');
+            continue;
+        } else if (event.key == INPUT_KEY_TAB && !cntrl) {
+            string_append_string(&editor->typed, sl("    "));
+            continue;
+        } else if (is_passive_key(event.key, cntrl)) {
+            continue;
+        }
+
+        if (editor_flush_typed(editor)) {
+            cursor_moved = true;
+            editor->block.active = false;
+        }
+        bool arrow = event.key == INPUT_KEY_UP || event.key == INPUT_KEY_DOWN || event.key == INPUT_KEY_LEFT || event.key == INPUT_KEY_RIGHT;
+        if (input.alt && shift && arrow) {
+            editor_extend_block(editor, event.key);
+            cursor_moved = true;
+            continue;
+        }
+        editor->block.active = false;
+
+        bool selection_active = txt->selected && !shift && txt->selection_begin != txt->selection_end;
+        bool is_movement = false;
+        text_cursor_update_position(txt);
+        if (shift && !txt->selected) {
+            text_select_begin(txt);
+        }
+
+        switch (event.key) {
+            case INPUT_KEY_V: if (cntrl && editor->get_clipboard) {
+                const char* str = editor->get_clipboard();
+                if (arrlist_count(txt->cursors) > 0) {
+                    text_cursors_paste(txt, string_from_cstring(str));
+                    break;
+                }
+                text_begin_command(txt);
+                text_cursor_insert(txt, string_from_cstring(str));
+                text_end_command(txt);
+            } break;
+            case INPUT_KEY_X: if (cntrl && !event.repeat) {
+                if (arrlist_count(txt->cursors) > 0) {
+                    text_cursors_copy(txt);
+                    text_cursors_insert(txt, (String){0});
+                    break;
+                }
+                text_begin_command(txt);
+                text_copy_and_delete_selection_to_clipboard(txt);
+                text_end_command(txt);
+            } break;
+            case INPUT_KEY_C: if (cntrl && !event.repeat) {
+                if (arrlist_count(txt->cursors) > 0) text_cursors_copy(txt);
+                else text_copy_selection_to_clipboard(txt);
+            } break;
+            case INPUT_KEY_Z: if (cntrl) {
+                editor->streak = (UndoStreak){0};
+                text_undo(txt);
+            } break;
+            case INPUT_KEY_Y: if (cntrl) {
+                text_redo(txt);
+            } break;
+            case INPUT_KEY_F: if (cntrl && !event.repeat) {
+                editor_find_open(editor);
+                found_moved = true;
+                cursor_moved = false; // text typed earlier in the frame shouldn't drop the match's selection
+            } break;
+            case INPUT_KEY_ESCAPE: {
+                text_clear_cursors(txt);
+                editor_find_clear(editor);
+            } break;
+            case INPUT_KEY_D: if (cntrl) {
+                editor_add_occurrences(editor, shift);
+                found_moved = true; // the selection is what was found, moving onto it shouldn't drop it
+            } break;
+            case INPUT_KEY_M: if (cntrl) {
+                // the cursor ends up on the same side of the match as it was of the bracket
+                isize cursor = text_cursor_idx(txt);
+                isize at, match;
+                if (bracket_index_near(&editor->brackets, cursor, &at, &match)) {
+                    is_movement = true;
+                    text_cursor_move(txt, (at == cursor ? match : match + 1) - cursor);
+                }
+            } break;
+            case INPUT_KEY_B: if (cntrl && !event.repeat) {
+                editor_toggle_bookmark(editor);
+            } break;
+            case INPUT_KEY_F2: {
+                if (editor_next_bookmark(editor)) is_movement = true;
+            } break;
+            case INPUT_KEY_A: if (cntrl && !event.repeat) {
+                text_clear_cursors(txt);
+                text_cursor_moveto(txt, 0, 0);
+                text_select_begin(txt);
+                txt->selection_end = gapbuf_count(&txt->gapbuf);
+            } break;
+
+            case INPUT_KEY_BACKSPACE:
+            case INPUT_KEY_DELETE: {
+                if (arrlist_count(txt->cursors) > 0) {
+                    text_cursors_remove(txt, event.key == INPUT_KEY_DELETE);
+                    editor->streak = (UndoStreak){0};
+                    break;
+                }
+                if (!editor->streak.delete) {
+                    text_begin_command(txt);
+                }
+                if (event.key == INPUT_KEY_BACKSPACE) {
+                    text_cursor_remove_before(txt, 1);
+                } else {
+                    text_cursor_remove_after(txt, 1);
+                }
+                editor->streak = (UndoStreak){.delete = true};
+            } break;
+
+            case INPUT_KEY_LEFT: {
+                is_movement = true;
+                if (cntrl || shift) text_clear_cursors(txt);
+                else text_cursors_move_codepoints(txt, -1);
+                if (selection_active) text_cursor_move_to_selected(txt, false);
+                else if (cntrl) text_cursor_move_until(txt, false, still_word);
+                else text_cursor_move_codepoints(txt, -1);
+            } break;
+            case INPUT_KEY_RIGHT: {
+                is_movement = true;
+                if (cntrl || shift) text_clear_cursors(txt);
+                else text_cursors_move_codepoints(txt, 1);
+                if (selection_active) text_cursor_move_to_selected(txt, true);
+                else if (cntrl) text_cursor_move_until(txt, true, still_word);
+                else text_cursor_move_codepoints(txt, 1);
+            } break;
+            case INPUT_KEY_UP: {
+                if (cntrl) { editor_scroll(editor, -1); break; }
+                is_movement = true;
+                if (selection_active) text_cursor_move_to_selected(txt, false);
+                else text_cursor_moveto(txt, txt->cursor_col, txt->cursor_line - 1);
+            } break;
+            case INPUT_KEY_DOWN: {
+                if (cntrl) { editor_scroll(editor, 1); break; }
+                is_movement = true;
+                if (selection_active) text_cursor_move_to_selected(txt, true);
+                else text_cursor_moveto(txt, txt->cursor_col, txt->cursor_line + 1);
+            } break;
+            case INPUT_KEY_HOME: {
+                is_movement = true;
+                text_cursor_moveto(txt, 0, txt->cursor_line);
+            } break;
+            case INPUT_KEY_END: {
+                is_movement = true;
+                text_cursor_moveto(txt, ISIZE_MAX, txt->cursor_line);
+            } break;
+            case INPUT_KEY_PAGE_UP: {
+                if (cntrl) { editor_scroll(editor, -20); break; }
+                is_movement = true;
+                text_cursor_moveto(txt, txt->cursor_col, txt->cursor_line - 20);
+            } break;
+            case INPUT_KEY_PAGE_DOWN: {
+                if (cntrl) { editor_scroll(editor, 20); break; }
+                is_movement = true;
+                text_cursor_moveto(txt, txt->cursor_col, txt->cursor_line + 20);
+            } break;
+
+            default: break;
+        }
+
+        if (is_movement) {
+            // left and right move every cursor, any other move goes back to just the one
+            if (event.key != INPUT_KEY_LEFT && event.key != INPUT_KEY_RIGHT) text_clear_cursors(txt);
+            cursor_moved = true;
+            if (shift) {
+                text_cursor_update_position(txt);
+                text_select_end(txt);
+            }
+        }
+    }
+
+    if (editor_flush_typed(editor)) cursor_moved = true;
+    if (editor->find.restart) editor_find_index(editor);
+
+    if (cursor_moved || found_moved) {
+        text_cursor_update_position(txt);
+        // the cursor is kept within 20 display rows of the top, counted through the wrapped lines
+        isize cursor_row = wrap_index_row_in_line(&editor->wrap, txt->cursor_line, text_cursor_idx(txt));
+        if (txt->cursor_line < camera->row || (txt->cursor_line == camera->row && cursor_row < camera->wrap_row)) {
+            camera->row = txt->cursor_line;
+            camera->wrap_row = cursor_row;
+        } else {
+            isize line = txt->cursor_line, row = cursor_row;
+            wrap_index_scroll(&editor->wrap, &line, &row, -20);
+            if (line > camera->row || (line == camera->row && row > camera->wrap_row)) {
+                camera->row = line;
+                camera->wrap_row = row;
+            }
+        }
+    }
+    if (cursor_moved && !shift) {
+        txt->selected = false;
+    }
+
+    text_cursor_update_position(txt);
+}
+
+void editor_mouse(Editor* editor, EditorMouse mouse) {
+    Text* txt = &editor->txt;
+    if (!mouse.pos.exists) return;
+
+    // alt + drag selects a block from where the button went down
+    EditorBlock* block = &editor->block;
+    if (mouse.alt && (mouse.pressed || (mouse.down && block->active))) {
+        if (mouse.pressed) *block = (EditorBlock){.active = true, .anchor_line = mouse.pos.pos.line, .anchor_col = mouse.pos.pos.col};
+        block->head_line = mouse.pos.pos.line;
+        block->head_col = mouse.pos.pos.col;
+        text_select_block(txt, block->anchor_line, block->anchor_col, block->head_line, block->head_col);
+        return;
+    }
+    if (mouse.pressed) block->active = false;
+
+    if (mouse.pressed) {
+        text_clear_cursors(txt);
+        if (mouse.shift && !txt->selected) {
+            text_select_begin(txt);
+        }
+        text_cursor_moveto(txt, mouse.pos.pos.col, mouse.pos.pos.line);
+        if (mouse.shift) {
+            text_select_end(txt);
+        } else {
+            text_select_begin(txt);
+        }
+    }
+    if (mouse.down) {
+        text_cursor_moveto(txt, mouse.pos.pos.col, mouse.pos.pos.line);
+        text_select_end(txt);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef EDITOR_H_
+#define EDITOR_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "layout.h"
+#include "inputs.h"
+#include "regexp.h"
+#include "matchindex.h"
+#include "searcher.h"
+#include "watchlist.h"
+#include "highlight.h"
+#include "brackets.h"
+#include "markers.h"
+#include "minimap.h"
+
+// consecutive words, whitespace or deletes are merged into a single undo command
+typedef struct UndoStreak {
+    bool alpha_num;
+    bool space;
+    bool delete;
+} UndoStreak;
+
+// incremental find, while it's open typed text goes to the query and the first match
+// after where the search started is selected on every keystroke
+typedef struct Find {
+    bool active;
+    StringBuilder query;
+    isize origin; // the query is searched from here again whenever it changes
+    bool found;
+
+    // ctrl + h switches typing between the query and the replacement, ctrl + enter replaces every match
+    StringBuilder replacement;
+    bool replacing;
+
+    bool regex;      // ctrl + r switches the query between plain text and a regex
+    Regex compiled;  // the regex query, compiled again whenever the query changes
+    bool stale;
+
+    // every match of the query, highlighted until escape is pressed even after find closes
+    MatchIndex matches;
+    Searcher searcher; // fills in matches over a few frames on big buffers
+    bool listening;
+    bool restart;      // the text was edited under a search that can't be patched, it's searched again at the end of the frame
+
+    // a selection waiting for the searcher to get far enough
+    bool pending;
+    isize pending_from;
+    bool pending_forwards;
+} Find;
+
+// everything the editor reads from the frontend in one frame, this is also what a trace records
+typedef struct EditorInput {
+    InputEvent* events;
+    isize event_count;
+
+    bool cntrl;
+    bool shift;
+    bool alt;
+    float wheel;
+} EditorInput;
+
+// result of hit testing the mouse against the last drawn frame
+typedef struct EditorMouse {
+    MouseCursorPosition pos;
+    bool pressed;
+    bool down;
+    bool shift;
+    bool alt;
+} EditorMouse;
+
+// a column selection made with alt + shift + arrows or alt + drag, the anchor is the corner it
+// started from and the head the one being moved. columns are counted in codepoints like cursor_col
+// and can go past the end of the lines
+typedef struct EditorBlock {
+    bool active;
+    isize anchor_line;
+    isize anchor_col;
+    isize head_line;
+    isize head_col;
+} EditorBlock;
+
+// applies input events to the text, shared by the window frontend and the headless replay
+// so both go through exactly the same editing paths
+typedef struct Editor {
+    Text txt;
+    TextCamera camera;
+
+    UndoStreak streak;
+    StringBuilder typed; // text events of the current frame, inserted in one batch
+    Find find;
+    Watchlist watchlist; // patterns highlighted everywhere, set with --watch
+    Highlighter highlighter; // syntax colours, nothing is coloured until it's attached to txt with a language
+    BracketIndex brackets;   // ctrl + m jumps to the bracket matching the one at the cursor
+    MarkerSet bookmarks;     // ctrl + b toggles one on the cursor's line, f2 goes to the next
+    EditorBlock block;
+    WrapIndex wrap;          // display rows of the wrapped lines, for scrolling through them
+    Minimap minimap;         // the whole document at a pixel row per line, drawn next to the text
+
+    // supplied by the frontend, pasting does nothing without it
+    const char* (*get_clipboard)(void);
+} Editor;
+
+void editor_update(Editor* editor, EditorInput input);
+void editor_mouse(Editor* editor, EditorMouse mouse);
+
+#endif //EDITOR_H_
@@ -23,6 +23,9 @@ isize gapbuf_count(GapBuffer* gapbuf);
 GapBuffer gapbuf_with_cap(isize cap);
 void gapbuf_free(GapBuffer* gapbuf);
 
+isize gapbuf_rawidx(GapBuffer* gapbuf, isize index);
+char gapbuf_get(GapBuffer* gapbuf, isize index);
+
 GapBufSlice gapbuf_getstrings(GapBuffer* gapbuf);
 GapBufSlice gapbuf_slice(GapBuffer* gapbuf, isize start, isize end);
 
@@ -72,7 +75,7 @@ void gapbuf_free(GapBuffer* gapbuf) {
 
 isize gapbuf_rawidx(GapBuffer* gapbuf, isize index) {
     assert(index >= 0 && index < gapbuf_count(gapbuf));
-    return index < gapbuf->gap_begin ? index : index + gapbuf->gap_end;
+    return index < gapbuf->gap_begin ? index : index + gapbuf_gaplen(gapbuf);
 }
 char gapbuf_get(GapBuffer* gapbuf, isize index) {
     return gapbuf->data[gapbuf_rawidx(gapbuf, index)];
@@ -116,7 +119,7 @@ GapBufSlice gapbuf_slice(GapBuffer* gapbuf, isize start, isize end) {
         //  s               e
         GapBufSlice slice = {
             .l = {.data = gapbuf->data + start, .count = gapbuf->gap_begin - start},
-            .r = {.data = gapbuf->data + gapbuf->gap_end + end, .count = end - gapbuf->gap_end},
+            .r = {.data = gapbuf->data + gapbuf->gap_end, .count = end - gapbuf->gap_begin},
         };
         return slice;
     }
@@ -155,10 +158,11 @@ void gapbuf_movegap_rel(GapBuffer* gapbuf, isize n) {
     char* gap_begin_p = gapbuf->data + gapbuf->gap_begin;
     char* gap_end_p = gapbuf->data + gapbuf->gap_end;
 
+    // the two ranges overlap when the gap moves further than its own length
     if (n > 0) {
-        memcpy(gap_begin_p, gap_end_p, labs(n));
+        memmove(gap_begin_p, gap_end_p, labs(n));
     } else {
-        memcpy(gap_end_p + n, gap_begin_p + n, labs(n));
+        memmove(gap_end_p + n, gap_begin_p + n, labs(n));
     }
 
     gapbuf->gap_begin += n;
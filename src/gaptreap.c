@@ -0,0 +1,227 @@
+#include "gaptreap.h"
+#include "arraylist.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// xorshift, the priorities only have to be spread out for the tree to stay balanced
+static u32 gaptreap_random(GapTreap* tree) {
+    tree->seed ^= tree->seed << 13;
+    tree->seed ^= tree->seed >> 7;
+    tree->seed ^= tree->seed << 17;
+    return (u32)(tree->seed >> 32);
+}
+
+void gaptreap_init(GapTreap* tree, GapTreapPull pull, void* data) {
+    gaptreap_free(tree);
+    tree->seed = 0x9E3779B97F4A7C15ull;
+    tree->pull = pull;
+    tree->data = data;
+    gaptreap_clear(tree);
+}
+
+void gaptreap_clear(GapTreap* tree) {
+    arrlist_setcount(tree->nodes, 0);
+    arrlist_append(tree->nodes, (GapTreapNode){0});
+    arrlist_setcount(tree->free_nodes, 0);
+    tree->root = 0;
+}
+
+void gaptreap_free(GapTreap* tree) {
+    arrlist_free(tree->nodes);
+    arrlist_free(tree->free_nodes);
+    *tree = (GapTreap){0};
+}
+
+isize gaptreap_count(GapTreap* tree) {
+    if (tree->nodes == NULL) return 0;
+    return arrlist_count(tree->nodes) - 1 - arrlist_count(tree->free_nodes);
+}
+
+i32 gaptreap_node_new(GapTreap* tree, i64 gap) {
+    GapTreapNode node = {.priority = gaptreap_random(tree), .gap = gap, .span = gap};
+    if (arrlist_count(tree->free_nodes) > 0) {
+        i32 t = arrlist_pop(tree->free_nodes);
+        tree->nodes[t] = node;
+        return t;
+    }
+    arrlist_append(tree->nodes, node);
+    return arrlist_count(tree->nodes) - 1;
+}
+
+void gaptreap_release(GapTreap* tree, i32 t) {
+    if (t == 0) return;
+    gaptreap_release(tree, tree->nodes[t].left);
+    gaptreap_release(tree, tree->nodes[t].right);
+    tree->nodes[t] = (GapTreapNode){0};
+    arrlist_append(tree->free_nodes, t);
+}
+
+void gaptreap_collapse(GapTreap* tree, i32 t) {
+    if (t == 0) return;
+    tree->nodes[t].gap = 0;
+    tree->nodes[t].span = 0;
+    tree->nodes[t].collapse = true;
+}
+
+// the children only find out about a collapse when they're visited
+static void gaptreap_push(GapTreap* tree, i32 t) {
+    if (!tree->nodes[t].collapse) return;
+    gaptreap_collapse(tree, tree->nodes[t].left);
+    gaptreap_collapse(tree, tree->nodes[t].right);
+    tree->nodes[t].collapse = false;
+}
+
+// the collapses above t are pushed down to it so its gap and its left subtree's span are up to date
+static void gaptreap_push_path(GapTreap* tree, i32 t) {
+    if (tree->nodes[t].parent != 0) gaptreap_push_path(tree, tree->nodes[t].parent);
+    gaptreap_push(tree, t);
+}
+
+// node 0 is the empty tree, all its fields are zero so it can be read like any other
+void gaptreap_pull(GapTreap* tree, i32 t) {
+    GapTreapNode* nodes = tree->nodes;
+    GapTreapNode* n = &nodes[t];
+    n->span = nodes[n->left].span + n->gap + nodes[n->right].span;
+    if (n->left != 0) nodes[n->left].parent = t;
+    if (n->right != 0) nodes[n->right].parent = t;
+    if (tree->pull) tree->pull(tree->data, nodes, t);
+}
+
+void gaptreap_set_root(GapTreap* tree, i32 root) {
+    tree->root = root;
+    if (root != 0) tree->nodes[root].parent = 0;
+}
+
+void gaptreap_split(GapTreap* tree, i32 t, i64 pos, i32* l, i32* r) {
+    if (t == 0) {
+        *l = *r = 0;
+        return;
+    }
+    gaptreap_push(tree, t);
+    GapTreapNode* n = &tree->nodes[t];
+    i64 at = tree->nodes[n->left].span + n->gap;
+    if (at < pos) {
+        gaptreap_split(tree, n->right, pos - at, &n->right, r);
+        *l = t;
+    } else {
+        gaptreap_split(tree, n->left, pos, l, &n->left);
+        *r = t;
+    }
+    gaptreap_pull(tree, t);
+}
+
+i32 gaptreap_merge(GapTreap* tree, i32 a, i32 b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    GapTreapNode* nodes = tree->nodes;
+    if (nodes[a].priority > nodes[b].priority) {
+        gaptreap_push(tree, a);
+        nodes[a].right = gaptreap_merge(tree, nodes[a].right, b);
+        gaptreap_pull(tree, a);
+        return a;
+    }
+    gaptreap_push(tree, b);
+    nodes[b].left = gaptreap_merge(tree, a, nodes[b].left);
+    gaptreap_pull(tree, b);
+    return b;
+}
+
+// only the first gap changes and with it the spans above it
+void gaptreap_shift(GapTreap* tree, i32 t, i64 delta) {
+    GapTreapNode* nodes = tree->nodes;
+    for (; t != 0; t = nodes[t].left) {
+        gaptreap_push(tree, t);
+        nodes[t].span += delta;
+        if (nodes[t].left == 0) nodes[t].gap += delta;
+    }
+}
+
+void gaptreap_edit(GapTreap* tree, i64 index, i64 removed, i64 inserted) {
+    if (tree->root == 0) return;
+    i32 l, m, r;
+    gaptreap_split(tree, tree->root, index, &l, &r);
+    i64 before = tree->nodes[l].span;
+    gaptreap_split(tree, r, index + removed - before, &m, &r);
+    // r's first gap was measured from the last node of m, or l's last if m is empty
+    i64 old_last = before + tree->nodes[m].span;
+    i64 new_last = before;
+    if (m != 0) {
+        gaptreap_collapse(tree, m);
+        gaptreap_shift(tree, m, index - before);
+        new_last = index;
+    }
+    gaptreap_shift(tree, r, old_last + inserted - removed - new_last);
+    gaptreap_set_root(tree, gaptreap_merge(tree, gaptreap_merge(tree, l, m), r));
+}
+
+i32 gaptreap_insert(GapTreap* tree, i64 index) {
+    i32 t = gaptreap_node_new(tree, 0);
+    i32 l, r;
+    gaptreap_split(tree, tree->root, index + 1, &l, &r);
+    tree->nodes[t].gap = index - tree->nodes[l].span;
+    gaptreap_pull(tree, t);
+    // r's first gap was measured from l's last node, now it's from the new one
+    gaptreap_shift(tree, r, -tree->nodes[t].gap);
+    gaptreap_set_root(tree, gaptreap_merge(tree, gaptreap_merge(tree, l, t), r));
+    return t;
+}
+
+// the node's children take its place, its gap goes to the first node after it. that's the first
+// of its right subtree, or without one the lowest node it's to the left of
+void gaptreap_remove(GapTreap* tree, i32 t) {
+    assert(t > 0 && t < arrlist_count(tree->nodes) && "not a node");
+    GapTreapNode* nodes = tree->nodes;
+    gaptreap_push_path(tree, t);
+    GapTreapNode n = nodes[t];
+    if (n.right != 0) {
+        gaptreap_shift(tree, n.right, n.gap);
+    } else {
+        for (i32 c = t; nodes[c].parent != 0; c = nodes[c].parent) {
+            if (nodes[nodes[c].parent].left == c) {
+                nodes[nodes[c].parent].gap += n.gap;
+                break;
+            }
+        }
+    }
+    i32 child = gaptreap_merge(tree, n.left, n.right);
+    if (n.parent == 0) {
+        gaptreap_set_root(tree, child);
+    } else {
+        if (nodes[n.parent].left == t) nodes[n.parent].left = child;
+        else nodes[n.parent].right = child;
+        for (i32 p = n.parent; p != 0; p = nodes[p].parent) gaptreap_pull(tree, p);
+    }
+    nodes[t] = (GapTreapNode){0};
+    arrlist_append(tree->free_nodes, t);
+}
+
+i64 gaptreap_position(GapTreap* tree, i32 t) {
+    assert(t > 0 && t < arrlist_count(tree->nodes) && "not a node");
+    GapTreapNode* nodes = tree->nodes;
+    gaptreap_push_path(tree, t);
+    i64 index = nodes[nodes[t].left].span + nodes[t].gap;
+    for (i32 c = t; nodes[c].parent != 0; c = nodes[c].parent) {
+        GapTreapNode* parent = &nodes[nodes[c].parent];
+        if (parent->right == c) index += nodes[parent->left].span + parent->gap;
+    }
+    return index;
+}
+
+i32 gaptreap_next(GapTreap* tree, i64 from, i64* index) {
+    GapTreapNode* nodes = tree->nodes;
+    i32 found = 0;
+    i64 base = 0;
+    for (i32 t = tree->root; t != 0;) {
+        gaptreap_push(tree, t);
+        i64 at = base + nodes[nodes[t].left].span + nodes[t].gap;
+        if (at >= from) {
+            found = t;
+            *index = at;
+            t = nodes[t].left;
+        } else {
+            base = at;
+            t = nodes[t].right;
+        }
+    }
+    return found;
+}
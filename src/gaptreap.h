@@ -0,0 +1,68 @@
+#ifndef GAPTREAP_H_
+#define GAPTREAP_H_
+
+#include "short_types.h"
+
+// positions in the text kept in a treap in text order where a node only stores how far it is from
+// the one before it, so an edit moves every position after it by changing one gap and adding,
+// removing or finding one is O(log n) however many there are. markers (markers.h) and brackets
+// (brackets.h) are both one, what else they need per subtree lives in their own array indexed like
+// the nodes and is recomputed by the tree's pull whenever a node's children change
+
+typedef struct GapTreapNode {
+    i32 left;
+    i32 right;
+    i32 parent;
+    u32 priority;
+    i64 gap;       // bytes from the node before this one
+    i64 span;      // gaps of the whole subtree, the position of its last node
+    bool collapse; // the children's subtrees were collapsed and all their gaps are still to be zeroed
+} GapTreapNode;
+
+// recomputes the user's aggregates of t from its children's, node 0 has to read as the empty tree
+typedef void (*GapTreapPull)(void* data, GapTreapNode* nodes, i32 t);
+
+typedef struct GapTreap {
+    GapTreapNode* nodes; // arraylist, nodes[0] is the empty tree
+    i32* free_nodes;     // arraylist
+    i32 root;
+    u64 seed;
+    GapTreapPull pull;   // NULL when there's nothing but the positions
+    void* data;
+} GapTreap;
+
+// an empty tree, anything it had before is dropped
+void gaptreap_init(GapTreap* tree, GapTreapPull pull, void* data);
+// drops every node but keeps the memory
+void gaptreap_clear(GapTreap* tree);
+void gaptreap_free(GapTreap* tree);
+isize gaptreap_count(GapTreap* tree);
+
+// a node on its own, the user sets up its aggregates and pulls it before it goes into the tree
+i32 gaptreap_node_new(GapTreap* tree, i64 gap);
+// gives every node of the subtree t back
+void gaptreap_release(GapTreap* tree, i32 t);
+void gaptreap_pull(GapTreap* tree, i32 t);
+void gaptreap_set_root(GapTreap* tree, i32 root);
+
+// nodes before pos go to l and the rest to r. the first gap of r is still measured from the node
+// before it, so r's positions start from l's last node
+void gaptreap_split(GapTreap* tree, i32 t, i64 pos, i32* l, i32* r);
+i32 gaptreap_merge(GapTreap* tree, i32 a, i32 b);
+// moves every node of t by delta
+void gaptreap_shift(GapTreap* tree, i32 t, i64 delta);
+// moves every node of t onto the one before t
+void gaptreap_collapse(GapTreap* tree, i32 t);
+
+// nodes before the edit stay, the ones in the removed bytes collapse onto where the edit was and
+// the ones after move by how much longer or shorter the text got
+void gaptreap_edit(GapTreap* tree, i64 index, i64 removed, i64 inserted);
+// a node at index, after any already there
+i32 gaptreap_insert(GapTreap* tree, i64 index);
+void gaptreap_remove(GapTreap* tree, i32 t);
+// where t is in the text now
+i64 gaptreap_position(GapTreap* tree, i32 t);
+// the first node at or after from and where it is, 0 when there's none
+i32 gaptreap_next(GapTreap* tree, i64 from, i64* index);
+
+#endif //GAPTREAP_H_
@@ -0,0 +1,127 @@
+#include "glyphcache.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <assert.h>
+
+static u32 glyph_hash(Codepoint c) {
+    return (u32)c * 2654435761u;
+}
+
+static void glyph_slots_add(GlyphCache* cache, i32 entry) {
+    u32 mask = arrlist_count(cache->slots) - 1;
+    u32 slot = glyph_hash(cache->entries[entry].codepoint) & mask;
+    while (cache->slots[slot] != -1) slot = (slot + 1) & mask;
+    cache->slots[slot] = entry;
+}
+
+// the table is kept at most half full, and built again whenever entries are dropped instead of
+// leaving tombstones for them
+static void glyph_slots_rebuild(GlyphCache* cache, isize capacity) {
+    isize count = 16;
+    while (count < capacity * 2) count *= 2;
+    arrlist_setcount(cache->slots, count);
+    for (isize i = 0; i < count; i++) cache->slots[i] = -1;
+    for (i32 i = 0; i < arrlist_count(cache->entries); i++) glyph_slots_add(cache, i);
+}
+
+void glyph_cache_init(GlyphCache* cache, i32 page_size, i32 max_pages) {
+    glyph_cache_free(cache);
+    assert(page_size > 0 && max_pages > 0 && "a glyph cache needs room for at least one page");
+    cache->page_size = page_size;
+    cache->max_pages = max_pages;
+    cache->current = -1;
+    glyph_slots_rebuild(cache, 0);
+}
+
+void glyph_cache_free(GlyphCache* cache) {
+    arrlist_free(cache->pages);
+    arrlist_free(cache->entries);
+    arrlist_free(cache->slots);
+    *cache = (GlyphCache){0};
+}
+
+GlyphEntry* glyph_cache_find(GlyphCache* cache, Codepoint c) {
+    if (cache->slots == NULL) return NULL;
+    u32 mask = arrlist_count(cache->slots) - 1;
+    for (u32 slot = glyph_hash(c) & mask; cache->slots[slot] != -1; slot = (slot + 1) & mask) {
+        GlyphEntry* entry = &cache->entries[cache->slots[slot]];
+        if (entry->codepoint != c) continue;
+        cache->pages[entry->page].used = cache->frame;
+        return entry;
+    }
+    return NULL;
+}
+
+// the page's glyphs are dropped and it's packed again from its top left corner
+static void glyph_cache_empty_page(GlyphCache* cache, i32 page) {
+    PROFILE_BEGIN("glyph_cache_empty_page");
+    isize kept = 0;
+    for (isize i = 0; i < arrlist_count(cache->entries); i++) {
+        if (cache->entries[i].page != page) cache->entries[kept++] = cache->entries[i];
+    }
+    arrlist_setcount(cache->entries, kept);
+    glyph_slots_rebuild(cache, kept);
+    cache->pages[page] = (GlyphPage){0};
+    PROFILE_END("glyph_cache_empty_page");
+}
+
+// starts a new shelf when the glyph doesn't fit on the current one, false when the page is full
+static bool glyph_page_fit(GlyphPage* page, i32 page_size, i32 width, i32 height, i32* x, i32* y) {
+    if (page->shelf_x + width > page_size) {
+        page->shelf_y += page->shelf_height;
+        page->shelf_x = 0;
+        page->shelf_height = 0;
+    }
+    if (page->shelf_y + height > page_size) return false;
+    *x = page->shelf_x;
+    *y = page->shelf_y;
+    page->shelf_x += width;
+    if (height > page->shelf_height) page->shelf_height = height;
+    return true;
+}
+
+GlyphEntry* glyph_cache_insert(GlyphCache* cache, Codepoint c, i32 width, i32 height, i32* cleared) {
+    assert(width + GLYPH_PADDING <= cache->page_size && height + GLYPH_PADDING <= cache->page_size && "glyph is bigger than a page");
+    *cleared = -1;
+    i32 x = 0, y = 0;
+    // blanks take no room but still belong to a page, so they're dropped with it like any other
+    i32 room_width = width > 0 ? width + GLYPH_PADDING : 0;
+    i32 room_height = height > 0 ? height + GLYPH_PADDING : 0;
+    if (cache->current < 0 || !glyph_page_fit(&cache->pages[cache->current], cache->page_size, room_width, room_height, &x, &y)) {
+        if (arrlist_count(cache->pages) < cache->max_pages) {
+            arrlist_append(cache->pages, (GlyphPage){0});
+            cache->current = arrlist_count(cache->pages) - 1;
+        } else {
+            i32 oldest = 0;
+            for (i32 i = 1; i < arrlist_count(cache->pages); i++) {
+                if (cache->pages[i].used < cache->pages[oldest].used) oldest = i;
+            }
+            glyph_cache_empty_page(cache, oldest);
+            cache->current = oldest;
+        }
+        *cleared = cache->current;
+        bool fit = glyph_page_fit(&cache->pages[cache->current], cache->page_size, room_width, room_height, &x, &y);
+        assert(fit && "an empty page fits any glyph");
+        (void)fit;
+    }
+    cache->pages[cache->current].used = cache->frame;
+
+    GlyphEntry entry = {
+        .codepoint = c,
+        .page = cache->current,
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+    };
+    arrlist_append(cache->entries, entry);
+    i32 index = arrlist_count(cache->entries) - 1;
+    if (arrlist_count(cache->entries) * 2 > arrlist_count(cache->slots)) glyph_slots_rebuild(cache, arrlist_count(cache->entries));
+    else glyph_slots_add(cache, index);
+    return &cache->entries[index];
+}
+
+void glyph_cache_next_frame(GlyphCache* cache) {
+    cache->frame++;
+}
@@ -0,0 +1,58 @@
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include "short_types.h"
+#include "stringbuilder.h"
+
+// where the glyphs the frontend rasterized on demand are in its atlas pages, so a font only has
+// to be rasterized for the codepoints a file actually uses.
+//
+// glyphs are packed onto square pages in shelves, rows as tall as their tallest glyph. pages are
+// added as they fill up until there are max_pages of them, after that the page drawn from the
+// longest ago is emptied for the new glyphs and the ones it held are rasterized again when they
+// show up, so the atlas never takes more than max_pages pages however many codepoints a file has
+
+#define GLYPH_PAGE_SIZE 512
+#define GLYPH_PAGE_MAX 4
+#define GLYPH_PADDING 1 // pixels between glyphs so sampling one never bleeds into its neighbour
+
+typedef struct GlyphEntry {
+    Codepoint codepoint;
+    i32 page;
+    i32 x, y, width, height; // the glyph's pixels on its page, empty for blanks and missing glyphs
+    // filled in by the frontend from the rasterized glyph
+    i32 offset_x, offset_y;
+    float advance;
+    bool missing; // the font has no glyph for the codepoint
+} GlyphEntry;
+
+typedef struct GlyphPage {
+    i32 shelf_x;      // where the next glyph on the current shelf goes
+    i32 shelf_y;
+    i32 shelf_height;
+    u64 used;         // the frame a glyph on the page was last looked up in
+} GlyphPage;
+
+typedef struct GlyphCache {
+    i32 page_size;
+    i32 max_pages;
+    i32 current;         // the page new glyphs are packed onto
+    GlyphPage* pages;    // arraylist, up to max_pages
+    GlyphEntry* entries; // arraylist
+    i32* slots;          // arraylist, open addressed by codepoint, entry indexes and -1 for empty
+    u64 frame;
+} GlyphCache;
+
+void glyph_cache_init(GlyphCache* cache, i32 page_size, i32 max_pages);
+void glyph_cache_free(GlyphCache* cache);
+
+// the glyph of the codepoint or NULL when it has to be rasterized, a glyph that's found keeps its
+// page from being the next one emptied. the pointer is good until the next insert
+GlyphEntry* glyph_cache_find(GlyphCache* cache, Codepoint c);
+// makes room for a width by height glyph. *cleared is set to the page that was added or emptied
+// for it and its pixels have to be cleared, -1 when the glyph fit on the current page
+GlyphEntry* glyph_cache_insert(GlyphCache* cache, Codepoint c, i32 width, i32 height, i32* cleared);
+// the frontend calls it once a frame, pages are emptied in the order they were last drawn from
+void glyph_cache_next_frame(GlyphCache* cache);
+
+#endif //GLYPHCACHE_H_
@@ -0,0 +1,141 @@
+#include "highlight.h"
+#include "highlight_tables.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+const HighlightLanguage* highlight_language_for(const char* filename) {
+    if (filename == NULL || filename[0] == '\0') return &highlight_languages[0];
+    const char* dot = strrchr(filename, '.');
+    if (dot == NULL || strpbrk(dot, "/\\")) return NULL;
+    for (isize i = 0; i < countof(highlight_languages); i++) {
+        for (const char* const* extension = highlight_languages[i].extensions; *extension; extension++) {
+            if (strcmp(dot + 1, *extension) == 0) return &highlight_languages[i];
+        }
+    }
+    return NULL;
+}
+
+static HighlightKind highlight_word(const HighlightLanguage* language, const char* word, isize count) {
+    u32 mask = language->word_slot_mask;
+    for (u32 slot = HIGHLIGHT_WORD_HASH(word, count) & mask; language->word_slots[slot] >= 0; slot = (slot + 1) & mask) {
+        isize index = language->word_slots[slot];
+        const char* candidate = language->words[index];
+        if (strncmp(candidate, word, count) == 0 && candidate[count] == '\0') return language->word_kinds[index];
+    }
+    return HIGHLIGHT_TEXT;
+}
+
+static void highlight_push(const HighlightLanguage* language, HighlightSpan** spans, const char* data, isize begin, isize end, HighlightKind kind) {
+    if (end <= begin) return;
+    if (kind == HIGHLIGHT_IDENTIFIER) kind = highlight_word(language, data + begin, end - begin);
+    if (kind != HIGHLIGHT_TEXT) arrlist_append(*spans, ((HighlightSpan){begin, end, kind}));
+}
+
+LexState highlight_lex_line(const HighlightLanguage* language, LexState state, const char* data, isize count, HighlightSpan** spans) {
+    const u8* classes = language->classes;
+    const u32* next = language->next;
+    isize class_count = language->class_count;
+    u32 row = state * class_count;
+    if (spans == NULL) {
+        for (isize i = 0; i < count; i++) row = HIGHLIGHT_ROW(next[row + classes[(u8)data[i]]]);
+        return row / class_count;
+    }
+
+    // a span ends wherever the kind of the bytes changes, or further back when the table says
+    // the last few bytes started the next token. kind and back are compared in one go
+    isize begin = 0;
+    u32 current = HIGHLIGHT_TEXT;
+    for (isize i = 0; i < count; i++) {
+        u32 entry = next[row + classes[(u8)data[i]]];
+        row = HIGHLIGHT_ROW(entry);
+        if (entry >> 16 != current) {
+            isize split = i - HIGHLIGHT_BACK(entry);
+            highlight_push(language, spans, data, begin, split, current);
+            begin = split;
+            current = HIGHLIGHT_EMIT(entry);
+        }
+    }
+    highlight_push(language, spans, data, begin, count, current);
+    return row / class_count;
+}
+
+// line offsets still describe the text before the edit, the edited lines are swapped for as many
+// unlexed lines as the edit left behind and everything after moves with them
+static void highlight_on_edit(void* data, Text* txt, TextEdit edit) {
+    Highlighter* hl = data;
+    isize first = text_line_of(txt, edit.index);
+    isize last = text_line_of(txt, edit.index + edit.removed);
+    isize added = 0;
+    GapBufSlice inserted = gapbuf_slice(&txt->gapbuf, edit.index, edit.index + edit.inserted);
+    for (isize i = 0; i < inserted.l.count; i++) added += inserted.l.data[i] == '\n';
+    for (isize i = 0; i < inserted.r.count; i++) added += inserted.r.data[i] == '\n';
+
+    isize count = arrlist_count(hl->states);
+    isize removed_lines = last - first + 1;
+    isize inserted_lines = added + 1;
+    isize new_count = count - removed_lines + inserted_lines;
+    if (new_count > count) arrlist_setcount(hl->states, new_count);
+    memmove(hl->states + first + inserted_lines, hl->states + last + 1, count - last - 1);
+    if (new_count < count) arrlist_setcount(hl->states, new_count);
+    memset(hl->states + first, LEX_UNKNOWN, inserted_lines);
+    if (hl->clean > first) hl->clean = first;
+}
+
+void highlight_attach(Highlighter* hl, Text* txt, const HighlightLanguage* language) {
+    highlight_free(hl);
+    hl->txt = txt;
+    arrlist_setcount(hl->states, arrlist_count(txt->line_offsets) + 1);
+    highlight_set_language(hl, language);
+    text_add_listener(txt, (TextListener){highlight_on_edit, hl});
+}
+
+void highlight_set_language(Highlighter* hl, const HighlightLanguage* language) {
+    hl->language = language;
+    memset(hl->states, LEX_UNKNOWN, arrlist_count(hl->states));
+    hl->clean = 0;
+}
+
+void highlight_free(Highlighter* hl) {
+    if (hl->txt) text_remove_listener(hl->txt, hl);
+    arrlist_free(hl->states);
+    arrlist_free(hl->spans);
+    string_free(&hl->straddle);
+    *hl = (Highlighter){0};
+}
+
+static void highlight_update(Highlighter* hl, isize through) {
+    isize count = arrlist_count(hl->states);
+    if (hl->clean > through || hl->clean >= count) return;
+    PROFILE_BEGIN("highlight_update");
+    while (hl->clean <= through && hl->clean < count) {
+        isize line = hl->clean++;
+        LexState start = line > 0 ? hl->states[line - 1] : LEX_LINE_START;
+        String bytes = text_line_string(hl->txt, line, &hl->straddle);
+        LexState end = highlight_lex_line(hl->language, start, bytes.data, bytes.count, NULL);
+        bool same = hl->states[line] == end;
+        hl->states[line] = end;
+        if (same) {
+            // the next line starts the way it did before, so every line up to the next edited one still ends the same
+            const u8* edited = memchr(hl->states + line + 1, LEX_UNKNOWN, count - line - 1);
+            hl->clean = edited ? edited - hl->states : count;
+            PROFILE_END("highlight_update");
+            return;
+        }
+    }
+    // the line after the last one lexed was lexed from a different state, it can't be trusted to stop at
+    if (hl->clean < count) hl->states[hl->clean] = LEX_UNKNOWN;
+    PROFILE_END("highlight_update");
+}
+
+HighlightSpan* highlight_line(Highlighter* hl, isize line) {
+    assert(hl->language && "no language to highlight with");
+    highlight_update(hl, line - 1);
+    arrlist_setcount(hl->spans, 0);
+    LexState start = line > 0 ? hl->states[line - 1] : LEX_LINE_START;
+    String bytes = text_line_string(hl->txt, line, &hl->straddle);
+    highlight_lex_line(hl->language, start, bytes.data, bytes.count, &hl->spans);
+    return hl->spans;
+}
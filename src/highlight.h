@@ -0,0 +1,90 @@
+#ifndef HIGHLIGHT_H_
+#define HIGHLIGHT_H_
+
+#include "short_types.h"
+#include "text.h"
+
+// syntax highlighting, lexed a line at a time
+//
+// every language is a transition table generated from its grammar in src/grammars by
+// src/tools/highlightgen.c, lexing is the same table lookup per byte whatever the language.
+// the only thing carried from one line to the next is the table's state after the newline
+// (inside a block comment, a string continued with a backslash, ...), and that is all that's
+// stored per line. after an edit lines are lexed again from the edited one only until a line
+// ends in the same state it did before, everything after that is still right
+
+typedef enum HighlightKind {
+    HIGHLIGHT_TEXT,
+    HIGHLIGHT_KEYWORD,
+    HIGHLIGHT_TYPE,
+    HIGHLIGHT_NUMBER,
+    HIGHLIGHT_STRING,
+    HIGHLIGHT_COMMENT,
+    HIGHLIGHT_PREPROCESSOR,
+    HIGHLIGHT_IDENTIFIER, // looked up in the language's words when it ends, never in a span
+    HIGHLIGHT_KIND_COUNT,
+} HighlightKind;
+
+// a state of the language's table, every language starts a file in LEX_LINE_START
+typedef u8 LexState;
+#define LEX_LINE_START 0
+#define LEX_UNKNOWN 0xff
+
+// a table entry is where the next state's row starts, the kind of the byte just read and how
+// many bytes before it turn out to be part of the same token (the / of a //), packed as
+// row | kind << 16 | back << 24. rows are state * class_count so the lookup needs no multiply
+#define HIGHLIGHT_ROW(entry) ((entry) & 0xffff)
+#define HIGHLIGHT_EMIT(entry) (((entry) >> 16) & 0xff)
+#define HIGHLIGHT_BACK(entry) ((entry) >> 24)
+
+// where a word's slot search starts, the generator lays the words out with it so it's a macro
+#define HIGHLIGHT_WORD_HASH(word, count) ((u8)(word)[0] * 31u + (u8)(word)[(count) - 1] * 7u + (u32)(count))
+
+typedef struct HighlightLanguage {
+    const char* name;
+    const char* const* extensions; // NULL terminated, without the dot
+    const u8* classes;             // column of every byte in next
+    isize class_count;
+    const u32* next;               // next[state * class_count + class]
+    const u8* state_kinds;         // what a line ending in the state continues, a comment, a string or nothing
+    const char* const* words;      // keywords, types and constants
+    const u8* word_kinds;
+    const i16* word_slots;         // open addressed by HIGHLIGHT_WORD_HASH, -1 for empty
+    u32 word_slot_mask;
+} HighlightLanguage;
+
+typedef struct HighlightSpan {
+    isize begin; // relative to the start of the line
+    isize end;
+    HighlightKind kind;
+} HighlightSpan;
+
+typedef struct Highlighter {
+    Text* txt;
+    const HighlightLanguage* language; // nothing is coloured without one
+    // arraylist, the lexer state at the end of every line. edited lines are LEX_UNKNOWN, lines past
+    // clean keep the state they ended in before so lexing can stop once a line agrees with it again
+    LexState* states;
+    isize clean;  // states before this line are right
+    HighlightSpan* spans; // arraylist, the spans of the last line asked for
+    StringBuilder straddle;
+} Highlighter;
+
+// the language for a file name by its extension, c for a buffer without a name and NULL for
+// an extension no grammar claims
+const HighlightLanguage* highlight_language_for(const char* filename);
+
+void highlight_attach(Highlighter* hl, Text* txt, const HighlightLanguage* language);
+// switches language and lexes everything again
+void highlight_set_language(Highlighter* hl, const HighlightLanguage* language);
+void highlight_free(Highlighter* hl);
+
+// lexes one line starting in state, the spans are appended when spans isn't NULL (text isn't
+// given a span). returns the state the next line starts in
+LexState highlight_lex_line(const HighlightLanguage* language, LexState state, const char* data, isize count, HighlightSpan** spans);
+
+// brings the line states up to date as far as line, then lexes the line. the spans stay valid
+// until the next call
+HighlightSpan* highlight_line(Highlighter* hl, isize line);
+
+#endif //HIGHLIGHT_H_
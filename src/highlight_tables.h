@@ -0,0 +1,167 @@
+// generated by src/tools/highlightgen.c from src/grammars, make -f MakeFile highlight_tables writes it again
+#ifndef HIGHLIGHT_TABLES_H_
+#define HIGHLIGHT_TABLES_H_
+
+#include "highlight.h"
+
+// src/grammars/c.grammar: 26 states, 23 byte classes
+static const u8 c_classes[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 4, 0, 0, 0, 5, 0, 0, 6, 7, 0, 7, 8, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 0, 11, 0, 12, 0,
+    0, 13, 13, 13, 13, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 0, 15, 0, 0, 13,
+    0, 13, 13, 16, 17, 18, 13, 13, 13, 19, 13, 13, 20, 13, 21, 13, 13, 13, 13, 13, 13, 22, 13, 13, 13, 13, 13, 0, 0, 0, 0, 0,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+static const u32 c_next[598] = {
+    0x00000017, 0x00000000, 0x00000000, 0x000401e3, 0x0006008a, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x00030045, 0x00000017, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x00030045, 0x00000017, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x0007002e, 0x00000017, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00030045, 0x000000b8, 0x00030045, 0x00000017, 0x00000017, 0x00030045, 0x0003005c, 0x00000017, 0x00030045, 0x00030045, 0x0003005c, 0x00030045, 0x00030045, 0x00030045, 0x00030045,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00030045, 0x00030045, 0x000000b8, 0x00030045, 0x00000017, 0x00000017, 0x00030045, 0x0003005c, 0x00000017, 0x00030045, 0x00030045, 0x0003005c, 0x00030045, 0x00030045, 0x00030045, 0x00030045,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x01030045, 0x00000017, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00000017, 0x0006008a, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x00030045, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600cf, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x010501b5, 0x00000017, 0x00000073, 0x01050187, 0x00030045, 0x00000017, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600e6, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600fd, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x00060114, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x0006012b,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x00060142, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000017, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x00000017, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x00060159, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000170, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x000600a1, 0x0004023f, 0x00000017, 0x000600a1, 0x000600a1, 0x00000017, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1, 0x000600a1,
+    0x00000017, 0x00000170, 0x00000000, 0x000401e3, 0x00000017, 0x00040211, 0x00000017, 0x00000017, 0x00000073, 0x000000b8, 0x00030045, 0x0004023f, 0x00000017, 0x0007002e, 0x0007002e, 0x00000017, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e, 0x0007002e,
+    0x00050187, 0x00050187, 0x00000000, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x0005019e, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187,
+    0x00050187, 0x00050187, 0x00000187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187, 0x00050187,
+    0x000501b5, 0x000501b5, 0x000001b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501cc, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5,
+    0x000501b5, 0x000501b5, 0x000001b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501cc, 0x000501b5, 0x000501b5, 0x00050017, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5, 0x000501b5,
+    0x000401e3, 0x000401e3, 0x00000000, 0x00040017, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401fa, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3,
+    0x000401e3, 0x000401e3, 0x000001e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3, 0x000401e3,
+    0x00040211, 0x00040211, 0x00000000, 0x00040211, 0x00040211, 0x00040017, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040228, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211,
+    0x00040211, 0x00040211, 0x00000211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211, 0x00040211,
+    0x0004023f, 0x0004023f, 0x00000000, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x00040017, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f, 0x0004023f,
+};
+static const u8 c_state_kinds[26] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 5, 5, 5, 4, 4, 4, 4, 4,
+};
+static const char* const c_words[69] = {
+    "auto", "break", "case", "const", "continue", "default", "do", "else",
+    "enum", "extern", "for", "goto", "if", "inline", "register", "restrict",
+    "return", "sizeof", "static", "struct", "switch", "typedef", "union", "volatile",
+    "while", "_Alignas", "_Alignof", "_Atomic", "_Generic", "_Noreturn", "_Static_assert", "_Thread_local",
+    "true", "false", "NULL", "char", "double", "float", "int", "long",
+    "short", "signed", "unsigned", "void", "bool", "_Bool", "size_t", "ptrdiff_t",
+    "int8_t", "int16_t", "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t",
+    "i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64",
+    "f32", "f64", "isize", "usize",
+    NULL,
+};
+static const u8 c_word_kinds[69] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2,
+    0,
+};
+static const i16 c_word_slots[256] = {
+    -1, -1, 7, 15, -1, -1, -1, -1, -1, -1, 43, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, 23, -1, -1, 58, -1, -1, -1, -1, -1, 40, 19,
+    35, 46, 33, -1, -1, -1, 59, 6, -1, -1, -1, -1, -1, -1, 3, -1,
+    -1, 24, 22, -1, 57, -1, -1, -1, -1, -1, 8, -1, -1, 27, 28, -1,
+    -1, 56, -1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5,
+    -1, -1, -1, 26, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 52, 53,
+    54, 55, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 45, 10, -1, -1, -1, 66,
+    13, -1, 31, 12, -1, -1, 11, -1, -1, -1, 34, 37, 29, 62, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 63, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, 18, 61, -1, -1, -1, -1, 25, 41,
+    -1, -1, -1, -1, -1, 60, -1, -1, -1, -1, -1, 30, 64, 17, -1, -1,
+    -1, -1, -1, -1, 2, 47, -1, -1, 4, 65, -1, 20, 0, -1, -1, -1,
+    1, -1, -1, 32, -1, -1, 16, 44, -1, -1, -1, -1, -1, 21, -1, -1,
+    -1, -1, -1, -1, -1, 36, 38, -1, -1, 39, 48, 49, 50, 51, -1, 42,
+    -1, -1, -1, 67, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+static const char* const c_extensions[] = {"c", "h", NULL};
+
+// src/grammars/python.grammar: 11 states, 12 byte classes
+static const u8 python_classes[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 4, 0, 0, 0, 5, 0, 0, 0, 6, 0, 6, 7, 0, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 0, 0, 0, 0, 0, 0,
+    0, 9, 9, 9, 9, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 11, 0, 0, 9,
+    0, 9, 9, 9, 9, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0, 0, 0, 0,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+};
+static const u32 python_next[132] = {
+    0x0000000c, 0x00000000, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x0000000c, 0x0000003c, 0x00030024, 0x00070018, 0x00070018, 0x0000000c,
+    0x0000000c, 0x0000000c, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x0000000c, 0x0000003c, 0x00030024, 0x00070018, 0x00070018, 0x0000000c,
+    0x0000000c, 0x0000000c, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x0000000c, 0x0000003c, 0x00070018, 0x00070018, 0x00070018, 0x0000000c,
+    0x0000000c, 0x0000000c, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x0000000c, 0x00030024, 0x00030024, 0x00030024, 0x00030030, 0x0000000c,
+    0x0000000c, 0x0000000c, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x00030024, 0x00030024, 0x00030024, 0x00030024, 0x00030030, 0x0000000c,
+    0x0000000c, 0x0000000c, 0x00000000, 0x00040054, 0x00050048, 0x0004006c, 0x0000000c, 0x0000003c, 0x01030024, 0x00070018, 0x00070018, 0x0000000c,
+    0x00050048, 0x00050048, 0x00000000, 0x00050048, 0x00050048, 0x00050048, 0x00050048, 0x00050048, 0x00050048, 0x00050048, 0x00050048, 0x00050048,
+    0x00040054, 0x00040054, 0x00000000, 0x0004000c, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040060,
+    0x00040054, 0x00040054, 0x00000054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054, 0x00040054,
+    0x0004006c, 0x0004006c, 0x00000000, 0x0004006c, 0x0004006c, 0x0004000c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x00040078,
+    0x0004006c, 0x0004006c, 0x0000006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c, 0x0004006c,
+};
+static const u8 python_state_kinds[11] = {
+    0, 0, 0, 0, 0, 0, 5, 4, 4, 4, 4,
+};
+static const char* const python_words[48] = {
+    "and", "as", "assert", "async", "await", "break", "class", "continue",
+    "def", "del", "elif", "else", "except", "finally", "for", "from",
+    "global", "if", "import", "in", "is", "lambda", "nonlocal", "not",
+    "or", "pass", "raise", "return", "try", "while", "with", "yield",
+    "True", "False", "None", "int", "float", "complex", "str", "bytes",
+    "bool", "list", "dict", "tuple", "set", "frozenset", "object",
+    NULL,
+};
+static const u8 python_word_kinds[48] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    0,
+};
+static const i16 python_word_slots[128] = {
+    -1, 23, 11, 17, -1, -1, -1, -1, 39, 10, -1, 36, -1, -1, 38, 45,
+    -1, 24, -1, 9, -1, -1, 26, -1, -1, -1, -1, -1, 44, -1, -1, -1,
+    -1, -1, -1, 46, -1, -1, -1, 6, -1, -1, -1, -1, -1, -1, -1, -1,
+    13, 29, -1, -1, -1, -1, -1, -1, -1, 25, 34, 19, -1, -1, -1, -1,
+    -1, 21, 33, -1, 41, 30, -1, -1, 7, -1, -1, -1, 37, 42, 22, -1,
+    5, -1, -1, -1, 43, -1, 27, 40, -1, 15, -1, -1, -1, -1, 20, 28,
+    -1, -1, -1, -1, -1, -1, 1, 35, 31, 8, 18, -1, -1, 12, -1, -1,
+    4, 2, -1, 16, 32, -1, -1, -1, -1, 3, -1, 14, -1, -1, 0, -1,
+};
+static const char* const python_extensions[] = {"py", "pyw", NULL};
+
+static const HighlightLanguage highlight_languages[] = {
+    {
+        .name = "c",
+        .extensions = c_extensions,
+        .classes = c_classes,
+        .class_count = 23,
+        .next = c_next,
+        .state_kinds = c_state_kinds,
+        .words = c_words,
+        .word_kinds = c_word_kinds,
+        .word_slots = c_word_slots,
+        .word_slot_mask = countof(c_word_slots) - 1,
+    },
+    {
+        .name = "python",
+        .extensions = python_extensions,
+        .classes = python_classes,
+        .class_count = 12,
+        .next = python_next,
+        .state_kinds = python_state_kinds,
+        .words = python_words,
+        .word_kinds = python_word_kinds,
+        .word_slots = python_word_slots,
+        .word_slot_mask = countof(python_word_slots) - 1,
+    },
+};
+
+#endif //HIGHLIGHT_TABLES_H_
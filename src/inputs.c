@@ -1,21 +1,64 @@
 #include "inputs.h"
 #include <raylib.h>
-#include "stringbuilder.h"
+#include "arraylist.h"
+#include "timer.h"
+#include "profiler.h"
+
+// keys that the os also reports as text through the char queue
+static bool inputs_is_text_key(int key) {
+    return (key >= KEY_SPACE && key <= KEY_GRAVE) || (key >= KEY_KP_0 && key <= KEY_KP_EQUAL);
+}
 
 void inputs_get_inputs(Inputs* inputs, float dt) {
-    for (isize i = 0; i < 384; i++) {
-        inputs->down[i] = IsKeyDown(i);
-        inputs->pressed_repeat[i] = inputs->pressed[i] = IsKeyPressed(i);
-        inputs->released[i] = IsKeyReleased(i);
-
-        if (inputs->down[i]) {
-            inputs->down_time[i] += dt;
-            if (inputs->down_time[i] > inputs->cooldown) {
-                inputs->down_time[i] -= inputs->repeat_rate;
-                inputs->pressed_repeat[i] = true;
+    PROFILE_BEGIN("inputs_get_inputs");
+    arrlist_setcount(inputs->events, 0);
+    i64 now = timer_now_ns();
+
+    inputs->cntrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    inputs->shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+    inputs->alt = IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT);
+
+    // repeat timers only run for the keys being held
+    for (isize i = 0; i < arrlist_count(inputs->held);) {
+        HeldKey* held = &inputs->held[i];
+        if (!IsKeyDown(held->key)) {
+            arrlist_remswap(inputs->held, i);
+            continue;
+        }
+        held->down_time += dt;
+        if (held->down_time > inputs->cooldown) {
+            held->down_time -= inputs->repeat_rate;
+            arrlist_append(inputs->events, ((InputEvent){.key = held->key, .repeat = true, .time = now}));
+        }
+        i++;
+    }
+
+    // raylib keeps key presses and characters in separate queues, a text key is
+    // followed by the character it produced so typing order is preserved
+    for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+        arrlist_append(inputs->events, ((InputEvent){.key = key, .time = now}));
+
+        bool already_held = false;
+        for (isize i = 0; i < arrlist_count(inputs->held); i++) {
+            if (inputs->held[i].key == key) {
+                inputs->held[i].down_time = 0.0f;
+                already_held = true;
             }
-        } else {
-            inputs->down_time[i] = 0.0f;
         }
+        if (!already_held) arrlist_append(inputs->held, ((HeldKey){.key = key}));
+
+        if (inputs_is_text_key(key) && !inputs->cntrl) {
+            Codepoint c = GetCharPressed();
+            if (c != 0) arrlist_append(inputs->events, ((InputEvent){.codepoint = c, .time = now}));
+        }
+    }
+    // os key repeats and ime commits only arrive as characters
+    for (Codepoint c = GetCharPressed(); c != 0; c = GetCharPressed()) {
+        arrlist_append(inputs->events, ((InputEvent){.codepoint = c, .time = now}));
     }
-}
\ No newline at end of file
+    PROFILE_END("inputs_get_inputs");
+}
+
+bool inputs_any_held(Inputs* inputs) {
+    return arrlist_count(inputs->held) > 0;
+}
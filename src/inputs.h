@@ -2,20 +2,72 @@
 #define INPUTS_H_
 
 #include "short_types.h"
+#include "stringbuilder.h"
 
-typedef struct Inputs {
-    bool pressed[384];
-    bool pressed_repeat[384];
+// key codes the editor acts on, they share raylib's (glfw's) numbering so inputs.c passes
+// raylib's key codes through untranslated and the editing core doesn't need raylib.h
+typedef enum InputKey {
+    INPUT_KEY_SPACE = 32,
+    INPUT_KEY_A = 'A', INPUT_KEY_B, INPUT_KEY_C, INPUT_KEY_D, INPUT_KEY_E, INPUT_KEY_F, INPUT_KEY_G,
+    INPUT_KEY_H, INPUT_KEY_I, INPUT_KEY_J, INPUT_KEY_K, INPUT_KEY_L, INPUT_KEY_M, INPUT_KEY_N,
+    INPUT_KEY_O, INPUT_KEY_P, INPUT_KEY_Q, INPUT_KEY_R, INPUT_KEY_S, INPUT_KEY_T, INPUT_KEY_U,
+    INPUT_KEY_V, INPUT_KEY_W, INPUT_KEY_X, INPUT_KEY_Y, INPUT_KEY_Z,
+    INPUT_KEY_GRAVE = 96,
+
+    INPUT_KEY_ESCAPE = 256,
+    INPUT_KEY_ENTER = 257,
+    INPUT_KEY_TAB = 258,
+    INPUT_KEY_BACKSPACE = 259,
+    INPUT_KEY_DELETE = 261,
+    INPUT_KEY_RIGHT = 262,
+    INPUT_KEY_LEFT = 263,
+    INPUT_KEY_DOWN = 264,
+    INPUT_KEY_UP = 265,
+    INPUT_KEY_PAGE_UP = 266,
+    INPUT_KEY_PAGE_DOWN = 267,
+    INPUT_KEY_HOME = 268,
+    INPUT_KEY_END = 269,
+    INPUT_KEY_F1 = 290,
+    INPUT_KEY_F2, INPUT_KEY_F3, INPUT_KEY_F4, INPUT_KEY_F5, INPUT_KEY_F6, INPUT_KEY_F7,
+    INPUT_KEY_F8, INPUT_KEY_F9, INPUT_KEY_F10, INPUT_KEY_F11, INPUT_KEY_F12,
+    INPUT_KEY_KP_0 = 320,
+    INPUT_KEY_KP_EQUAL = 336,
+    INPUT_KEY_LEFT_SHIFT = 340,
+    INPUT_KEY_LEFT_CONTROL = 341,
+    INPUT_KEY_LEFT_ALT = 342,
+    INPUT_KEY_RIGHT_SHIFT = 344,
+    INPUT_KEY_RIGHT_CONTROL = 345,
+    INPUT_KEY_RIGHT_ALT = 346,
+    INPUT_KEY_RIGHT_SUPER = 347,
+} InputKey;
+
+// one key press (or key repeat) or one unicode character of text input
+// key events and text events are interleaved in the order they were typed
+typedef struct InputEvent {
+    int key;             // raylib KeyboardKey, 0 for text input
+    Codepoint codepoint; // text input, 0 for key events
+    bool repeat;         // generated by the key repeat timer rather than a physical press
+    i64 time;            // timer_now_ns when the event was taken off raylib's queue
+} InputEvent;
 
-    bool released[384];
-    bool down[384];
+typedef struct HeldKey {
+    int key;
+    float down_time;
+} HeldKey;
+
+typedef struct Inputs {
+    InputEvent* events; // arraylist, this frame's events drained from raylib's key and char queues
+    HeldKey* held;      // arraylist, only the keys that are currently down
 
-    float down_time[384];
+    bool cntrl;
+    bool shift;
+    bool alt;
 
     float cooldown;
     float repeat_rate;
 } Inputs;
 
 void inputs_get_inputs(Inputs* inputs, float dt);
+bool inputs_any_held(Inputs* inputs);
 
-#endif //INPUTS_H_
\ No newline at end of file
+#endif //INPUTS_H_
@@ -0,0 +1,85 @@
+#include "latency.h"
+#include "timer.h"
+#include <stdio.h>
+
+void latency_input(LatencyTracker* latency, i64 timestamp) {
+    if (latency->input_time == 0 || timestamp < latency->input_time) {
+        latency->input_time = timestamp;
+    }
+}
+
+// records the time since the frame's oldest input event, the present stage ends the frame
+void latency_mark(LatencyTracker* latency, LatencyStage stage) {
+    if (latency->input_time == 0) return;
+
+    i64 elapsed = timer_now_ns() - latency->input_time;
+    LatencyHistogram* histogram = &latency->stages[stage];
+
+    i64 bucket = elapsed / LATENCY_BUCKET_NS;
+    if (bucket >= LATENCY_BUCKET_COUNT) bucket = LATENCY_BUCKET_COUNT - 1;
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    if (elapsed > histogram->max_ns) histogram->max_ns = elapsed;
+
+    if (stage == LATENCY_PRESENT) latency->input_time = 0;
+}
+
+bool latency_sampling(LatencyTracker* latency) {
+    return latency->input_time != 0;
+}
+
+// returns the upper bound of the bucket containing the percentile (0 - 100)
+i64 latency_percentile(LatencyHistogram* histogram, f64 percentile) {
+    if (histogram->count == 0) return 0;
+
+    i64 target = (i64)(histogram->count * percentile / 100.0);
+    if (target >= histogram->count) target = histogram->count - 1;
+
+    i64 seen = 0;
+    for (isize i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += histogram->buckets[i];
+        if (seen > target) {
+            i64 upper = (i + 1) * LATENCY_BUCKET_NS;
+            return upper < histogram->max_ns ? upper : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+const char* latency_stage_name(LatencyStage stage) {
+    switch (stage) {
+        case LATENCY_EDIT: return "edit";
+        case LATENCY_LAYOUT: return "layout";
+        case LATENCY_PRESENT: return "present";
+        default: return "unknown";
+    }
+}
+
+// summary lines followed by the non empty buckets of every stage, all times in microseconds
+void latency_write_file(LatencyTracker* latency, const char* filename) {
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        perror("Couldn't Open File: ");
+        return;
+    }
+    fprintf(f, "stage samples p50_us p99_us max_us\n");
+    for (isize i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencyHistogram* histogram = &latency->stages[i];
+        fprintf(f, "%s %lld %lld %lld %lld\n",
+            latency_stage_name(i),
+            (long long)histogram->count,
+            (long long)(latency_percentile(histogram, 50) / TIMER_NS_PER_US),
+            (long long)(latency_percentile(histogram, 99) / TIMER_NS_PER_US),
+            (long long)(histogram->max_ns / TIMER_NS_PER_US)
+        );
+    }
+    fprintf(f, "\nstage bucket_start_us count\n");
+    for (isize i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencyHistogram* histogram = &latency->stages[i];
+        for (isize j = 0; j < LATENCY_BUCKET_COUNT; j++) {
+            if (histogram->buckets[j] == 0) continue;
+            fprintf(f, "%s %lld %u\n", latency_stage_name(i), (long long)(j * LATENCY_BUCKET_NS / TIMER_NS_PER_US), histogram->buckets[j]);
+        }
+    }
+    fclose(f);
+}
@@ -0,0 +1,41 @@
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include "short_types.h"
+
+#define LATENCY_BUCKET_NS (100 * 1000)  // 0.1ms histogram resolution
+#define LATENCY_BUCKET_COUNT 1000       // covers 0 - 100ms, anything slower lands in the last bucket
+
+// how long after an input event each stage of the frame that handled it finished
+typedef enum LatencyStage {
+    LATENCY_EDIT,    // the events have been applied to the text
+    LATENCY_LAYOUT,  // the text has been laid out and drawn
+    LATENCY_PRESENT, // EndDrawing has swapped the frame onto the screen, it mustn't wait for events that frame
+    LATENCY_STAGE_COUNT,
+} LatencyStage;
+
+typedef struct LatencyHistogram {
+    u32 buckets[LATENCY_BUCKET_COUNT];
+    i64 count;
+    i64 max_ns;
+} LatencyHistogram;
+
+// one sample per frame that handled input, measured from the oldest event of the frame
+typedef struct LatencyTracker {
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+    i64 input_time; // timestamp of the oldest event of the current frame, 0 if there were none
+
+    bool overlay;
+} LatencyTracker;
+
+void latency_input(LatencyTracker* latency, i64 timestamp);
+void latency_mark(LatencyTracker* latency, LatencyStage stage);
+// true from the frame's first input event until its present is marked
+bool latency_sampling(LatencyTracker* latency);
+
+i64 latency_percentile(LatencyHistogram* histogram, f64 percentile);
+
+const char* latency_stage_name(LatencyStage stage);
+void latency_write_file(LatencyTracker* latency, const char* filename);
+
+#endif //LATENCY_H_
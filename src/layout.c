@@ -0,0 +1,320 @@
+#include "layout.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+TextCamera camera_default() {
+    return (TextCamera) {
+        .max_cols = 80,
+        .padding = 5.0,
+        .spacing = 1.0,
+
+        .left_margin = 20.0,
+        .bottom_margin = 10.0,
+    };
+}
+
+Codepoint camera_next_char(TextCamera* camera, Text* txt, FontMetrics metrics, CameraPosition* pos) {
+    float bottom = camera->height - camera->padding - camera->bottom_margin;
+
+    Codepoint c = gapbuf_next_codepoint(&txt->gapbuf, &pos->index);
+
+    if (c != '\n') {
+        pos->col++;
+        pos->screen_col++;
+
+        pos->width = metrics.advance(metrics.font, c) + camera->spacing;
+    }
+
+    if (pos->screen_col >= camera->max_cols || pos->position.x + pos->width > camera->width - camera->padding - camera->right_margin || c == '\n') {
+        pos->screen_col = 0;
+        pos->screen_line++;
+
+        pos->position.x = camera->padding + camera->left_margin;
+        pos->position.y += metrics.line_height;
+        
+        if (c == '\n') {
+            pos->line++;
+            pos->col = 0;
+        }
+        if (pos->position.y > bottom) return c;
+    }
+
+    return c;
+}
+
+// the rows a line has in the tree, as many as are known when it's only partly laid out
+static i64 wrap_line_value(WrapLine* line) {
+    return line->rows > 0 ? line->rows : arrlist_count(line->breaks) + 1;
+}
+
+static void wrap_tree_add(WrapIndex* wrap, isize line, i64 delta) {
+    isize count = arrlist_count(wrap->lines);
+    for (isize i = line + 1; i <= count; i += i & -i) wrap->tree[i] += delta;
+}
+
+// rows of the lines before line
+static i64 wrap_tree_prefix(WrapIndex* wrap, isize line) {
+    i64 rows = 0;
+    for (isize i = line; i > 0; i -= i & -i) rows += wrap->tree[i];
+    return rows;
+}
+
+// every node adds itself to the one above it, linear rather than n point updates
+static void wrap_tree_build(WrapIndex* wrap) {
+    isize count = arrlist_count(wrap->lines);
+    arrlist_setcount(wrap->tree, count + 1);
+    wrap->tree[0] = 0;
+    for (isize i = 1; i <= count; i++) wrap->tree[i] = wrap_line_value(&wrap->lines[i - 1]);
+    for (isize i = 1; i <= count; i++) {
+        isize parent = i + (i & -i);
+        if (parent <= count) wrap->tree[parent] += wrap->tree[i];
+    }
+}
+
+static void wrap_invalidate_all(WrapIndex* wrap) {
+    for (isize i = 0; i < arrlist_count(wrap->lines); i++) {
+        arrlist_free(wrap->lines[i].breaks);
+        wrap->lines[i].rows = 0;
+    }
+    wrap_tree_build(wrap);
+}
+
+// how many of the breaks start at or before offset from the line's start
+static isize wrap_breaks_through(WrapBreak* breaks, isize offset) {
+    isize lo = 0, hi = arrlist_count(breaks);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (breaks[mid].index <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// the same walk camera_draw does over the line, a new screen line before the newline is a wrap.
+// a long line is only laid out as far as the rows asked for: up to row and past index. the walk
+// picks up from the last row already known, the rows after it are counted once they're reached
+static void wrap_measure(WrapIndex* wrap, isize line, isize index, isize row) {
+    WrapLine* wrap_line = &wrap->lines[line];
+    if (wrap_line->rows > 0 || !wrap->configured) return;
+    Text* txt = wrap->txt;
+    isize begin = line > 0 ? txt->line_offsets[line - 1] : 0;
+    isize offset = index - begin;
+    isize known = arrlist_count(wrap_line->breaks);
+    if (known > 0 && known >= row && wrap_line->breaks[known - 1].index > offset) return;
+    PROFILE_BEGIN("wrap_measure");
+    TextCamera* camera = &wrap->camera;
+    i64 value = wrap_line_value(wrap_line);
+    isize end = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf);
+    CameraPosition pos = {
+        .position = {camera->padding + camera->left_margin, .y = camera->padding},
+        .line = line,
+        .index = begin,
+    };
+    // like camera_start_position the row's first codepoint was already counted on it
+    isize resumed = -1;
+    if (known > 0) {
+        resumed = wrap_line->breaks[known - 1].index;
+        pos.index = begin + resumed;
+        pos.col = wrap_line->breaks[known - 1].col;
+        pos.screen_col = -1;
+    }
+    bool done = true;
+    while (pos.index < end) {
+        WrapBreak at = {pos.index - begin, pos.col};
+        isize screen_line = pos.screen_line;
+        Codepoint c = camera_next_char(camera, txt, wrap->metrics, &pos);
+        if (c == '\n') break;
+        if (pos.screen_line != screen_line && at.index != resumed) {
+            arrlist_append(wrap_line->breaks, at);
+            if (arrlist_count(wrap_line->breaks) >= row && at.index > offset) {
+                done = false;
+                break;
+            }
+        }
+        if (c != '\r') pos.position.x += pos.width;
+    }
+    if (done) wrap_line->rows = arrlist_count(wrap_line->breaks) + 1;
+    wrap_tree_add(wrap, line, wrap_line_value(wrap_line) - value);
+    PROFILE_END("wrap_measure");
+}
+
+// line offsets still describe the text before the edit, the lines it touched are swapped for
+// as many lines as it left and those are laid out again when they're next needed. the rows of the
+// first one that start before the edit wrapped the same way, so they're kept
+static void wrap_on_edit(void* data, Text* txt, TextEdit edit) {
+    WrapIndex* wrap = data;
+    PROFILE_BEGIN("wrap_on_edit");
+    isize first = text_line_of(txt, edit.index);
+    isize last = text_line_of(txt, edit.index + edit.removed);
+    isize added = 0;
+    GapBufSlice inserted = gapbuf_slice(&txt->gapbuf, edit.index, edit.index + edit.inserted);
+    for (isize i = 0; i < inserted.l.count; i++) added += inserted.l.data[i] == '\n';
+    for (isize i = 0; i < inserted.r.count; i++) added += inserted.r.data[i] == '\n';
+
+    isize count = arrlist_count(wrap->lines);
+    isize removed_lines = last - first + 1;
+    isize inserted_lines = added + 1;
+    WrapLine* kept = &wrap->lines[first];
+    i64 kept_value = wrap_line_value(kept);
+    isize begin = first > 0 ? txt->line_offsets[first - 1] : 0;
+    if (kept->breaks) arrlist_setcount(kept->breaks, wrap_breaks_through(kept->breaks, edit.index - 1 - begin));
+    kept->rows = 0;
+    if (removed_lines == inserted_lines) {
+        wrap_tree_add(wrap, first, wrap_line_value(kept) - kept_value);
+        for (isize line = first + 1; line <= last; line++) {
+            wrap_tree_add(wrap, line, 1 - wrap_line_value(&wrap->lines[line]));
+            arrlist_free(wrap->lines[line].breaks);
+            wrap->lines[line].rows = 0;
+        }
+        PROFILE_END("wrap_on_edit");
+        return;
+    }
+    for (isize line = first + 1; line <= last; line++) arrlist_free(wrap->lines[line].breaks);
+    isize new_count = count - removed_lines + inserted_lines;
+    if (new_count > count) arrlist_setcount(wrap->lines, new_count);
+    memmove(wrap->lines + first + inserted_lines, wrap->lines + last + 1, (count - last - 1) * sizeof(WrapLine));
+    if (new_count < count) arrlist_setcount(wrap->lines, new_count);
+    memset(wrap->lines + first + 1, 0, (inserted_lines - 1) * sizeof(WrapLine));
+    // every line after the edit moved, the tree is built again in one linear pass
+    wrap_tree_build(wrap);
+    PROFILE_END("wrap_on_edit");
+}
+
+void wrap_index_attach(WrapIndex* wrap, Text* txt) {
+    wrap_index_free(wrap);
+    wrap->txt = txt;
+    arrlist_setcount(wrap->lines, arrlist_count(txt->line_offsets) + 1);
+    memset(wrap->lines, 0, arrlist_count(wrap->lines) * sizeof(WrapLine));
+    wrap_tree_build(wrap);
+    text_add_listener(txt, (TextListener){wrap_on_edit, wrap});
+}
+
+void wrap_index_free(WrapIndex* wrap) {
+    if (wrap->txt) text_remove_listener(wrap->txt, wrap);
+    for (isize i = 0; i < arrlist_count(wrap->lines); i++) arrlist_free(wrap->lines[i].breaks);
+    arrlist_free(wrap->lines);
+    arrlist_free(wrap->tree);
+    *wrap = (WrapIndex){0};
+}
+
+void wrap_index_configure(WrapIndex* wrap, const TextCamera* camera, FontMetrics metrics) {
+    if (wrap->txt == NULL) return;
+    bool same = wrap->configured
+        && wrap->camera.max_cols == camera->max_cols
+        && wrap->camera.width == camera->width
+        && wrap->camera.padding == camera->padding
+        && wrap->camera.left_margin == camera->left_margin
+        && wrap->camera.right_margin == camera->right_margin
+        && wrap->camera.spacing == camera->spacing
+        && wrap->metrics.font == metrics.font
+        && wrap->metrics.advance == metrics.advance;
+    wrap->camera = *camera;
+    wrap->metrics = metrics;
+    if (same) return;
+    wrap->configured = true;
+    wrap_invalidate_all(wrap);
+}
+
+isize wrap_index_line_rows(WrapIndex* wrap, isize line) {
+    if (wrap->txt == NULL) return 1;
+    wrap_measure(wrap, line, ISIZE_MAX, ISIZE_MAX);
+    return wrap_line_value(&wrap->lines[line]);
+}
+
+isize wrap_index_row_in_line(WrapIndex* wrap, isize line, isize index) {
+    if (wrap->txt == NULL) return 0;
+    wrap_measure(wrap, line, index, 0);
+    return wrap_breaks_through(wrap->lines[line].breaks, index - (line > 0 ? wrap->txt->line_offsets[line - 1] : 0));
+}
+
+WrapBreak wrap_index_row_start(WrapIndex* wrap, isize line, isize row) {
+    Text* txt = wrap->txt;
+    WrapBreak start = {line > 0 ? txt->line_offsets[line - 1] : 0, 0};
+    if (row <= 0) return start;
+    wrap_measure(wrap, line, -1, row);
+    WrapBreak* breaks = wrap->lines[line].breaks;
+    if (arrlist_count(breaks) == 0) return start;
+    WrapBreak at = row <= arrlist_count(breaks) ? breaks[row - 1] : breaks[arrlist_count(breaks) - 1];
+    return (WrapBreak){start.index + at.index, at.col};
+}
+
+bool wrap_index_has_row(WrapIndex* wrap, isize line, isize row) {
+    if (row <= 0) return true;
+    if (wrap->txt == NULL) return false;
+    wrap_measure(wrap, line, -1, row);
+    return arrlist_count(wrap->lines[line].breaks) >= row;
+}
+
+isize wrap_index_row_of(WrapIndex* wrap, isize line) {
+    if (wrap->txt == NULL) return line;
+    return wrap_tree_prefix(wrap, line);
+}
+
+// walks down the tree taking every node whose rows all come before row
+isize wrap_index_line_at(WrapIndex* wrap, isize row, isize* row_in_line) {
+    isize count = arrlist_count(wrap->lines);
+    if (wrap->txt == NULL || count == 0) {
+        *row_in_line = 0;
+        return row;
+    }
+    isize step = 1;
+    while (step * 2 <= count) step *= 2;
+    isize line = 0;
+    i64 left = row < 0 ? 0 : row;
+    for (; step > 0; step /= 2) {
+        if (line + step <= count && wrap->tree[line + step] <= left) {
+            line += step;
+            left -= wrap->tree[line];
+        }
+    }
+    if (line >= count) {
+        line = count - 1;
+        *row_in_line = wrap_index_line_rows(wrap, line) - 1;
+        return line;
+    }
+    // laying the line out only adds rows after its first, so row is still on it
+    *row_in_line = wrap_index_has_row(wrap, line, left) ? left : wrap_index_line_rows(wrap, line) - 1;
+    return line;
+}
+
+void wrap_index_scroll(WrapIndex* wrap, isize* line, isize* row_in_line, isize delta) {
+    isize last = wrap->txt ? arrlist_count(wrap->lines) - 1 : *line;
+    isize at = *line < 0 ? 0 : *line > last ? last : *line;
+    isize row = *row_in_line + delta;
+    while (row < 0 && at > 0) {
+        at--;
+        row += wrap_index_line_rows(wrap, at);
+    }
+    // a line without the row was laid out to its end looking for it, so its rows are known
+    while (at < last && !wrap_index_has_row(wrap, at, row)) {
+        row -= wrap_index_line_rows(wrap, at);
+        at++;
+    }
+    if (!wrap_index_has_row(wrap, at, row)) row = wrap_index_line_rows(wrap, at) - 1;
+    if (row < 0) row = 0;
+    *line = at;
+    *row_in_line = row;
+}
+
+CameraPosition camera_start_position(TextCamera* camera, Text* txt, WrapIndex* wrap) {
+    if (camera->row < 0) camera->row = 0;
+    if (camera->row > arrlist_count(txt->line_offsets)) camera->row = arrlist_count(txt->line_offsets);
+    WrapBreak start = {camera->row != 0 ? txt->line_offsets[camera->row - 1] : 0, 0};
+    if (wrap && wrap->configured) {
+        if (camera->wrap_row < 0) camera->wrap_row = 0;
+        if (!wrap_index_has_row(wrap, camera->row, camera->wrap_row)) camera->wrap_row = wrap_index_line_rows(wrap, camera->row) - 1;
+        start = wrap_index_row_start(wrap, camera->row, camera->wrap_row);
+    } else {
+        camera->wrap_row = 0;
+    }
+    // the codepoint a row starts with was counted on it when it wrapped there, it's counted again here
+    return (CameraPosition){
+        .position = {camera->padding + camera->left_margin, .y = camera->padding},
+        .line = camera->row,
+        .col = start.col,
+        .screen_col = camera->wrap_row > 0 ? -1 : 0,
+        .index = start.index,
+    };
+}
@@ -0,0 +1,105 @@
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include "short_types.h"
+#include "text.h"
+
+// measurements of the font supplied by the frontend so layout doesn't depend on raylib
+typedef struct FontMetrics {
+    void* font;
+    float (*advance)(void* font, Codepoint c); // horizontal advance of a codepoint in pixels
+    float line_height;
+} FontMetrics;
+
+typedef struct LayoutVector {
+    float x, y;
+} LayoutVector;
+
+typedef struct TextCamera {
+    isize row;
+    isize wrap_row; // display row of the line at row that's drawn first, when the line wraps
+
+    float padding;
+    float left_margin;
+    float right_margin;
+    float bottom_margin;
+
+    float spacing;
+    int max_cols;
+
+    // size of the viewport in pixels, the frontend updates it every frame
+    float width;
+    float height;
+} TextCamera;
+
+typedef struct CameraPosition {
+    isize line, col;
+    isize screen_line, screen_col;
+
+    isize index;
+    LayoutVector position;
+    float width;
+} CameraPosition;
+
+typedef struct MouseCursorPosition {
+    CursorPosition pos;
+    bool exists;
+} MouseCursorPosition;
+
+// where a display row of a wrapped line starts, col is how many codepoints of the line come before it
+typedef struct WrapBreak {
+    isize index;
+    isize col;
+} WrapBreak;
+
+typedef struct WrapLine {
+    i32 rows;          // 0 until the line is laid out to its end
+    WrapBreak* breaks; // arraylist, the start of every display row after the first from the line's start, as far as it's laid out
+} WrapLine;
+
+// the display rows of every line as camera_next_char wraps them. lines are only laid out when a
+// query reaches them and only as far as the rows it asks for, so a megabyte long line is read
+// around the viewport rather than whole. an edit only drops the rows after it on the lines it
+// changed, a new wrapping width drops all. a fenwick tree over the rows of each line (the ones laid
+// out so far for the rest) maps display rows to lines and back in O(log n), and the breaks of a
+// line find the row of any byte in it. an edit within lines updates the tree in O(log n), one that
+// adds or removes lines shifts the lines after it and builds the tree again in O(lines) like the
+// text does its line offsets
+typedef struct WrapIndex {
+    Text* txt;
+    TextCamera camera;   // the layout the rows were counted for
+    FontMetrics metrics;
+    bool configured;
+    WrapLine* lines;     // arraylist, one for every line of the text
+    i64* tree;           // arraylist, 1 based fenwick tree of the rows of each line
+} WrapIndex;
+
+TextCamera camera_default();
+
+Codepoint camera_next_char(TextCamera* camera, Text* txt, FontMetrics metrics, CameraPosition* pos);
+
+void wrap_index_attach(WrapIndex* wrap, Text* txt);
+void wrap_index_free(WrapIndex* wrap);
+// called before every layout, the rows are only counted again when the wrapping width or font changed
+void wrap_index_configure(WrapIndex* wrap, const TextCamera* camera, FontMetrics metrics);
+// how many display rows the line has
+isize wrap_index_line_rows(WrapIndex* wrap, isize line);
+// the display row of the line index is on
+isize wrap_index_row_in_line(WrapIndex* wrap, isize line, isize index);
+// where a display row of the line starts, its last row's start when it has fewer
+WrapBreak wrap_index_row_start(WrapIndex* wrap, isize line, isize row);
+// whether the line wraps onto at least row + 1 rows, only lays it out as far as that row
+bool wrap_index_has_row(WrapIndex* wrap, isize line, isize row);
+// the display row the line starts on, lines above that aren't laid out yet count as one row
+isize wrap_index_row_of(WrapIndex* wrap, isize line);
+// the line a display row is on and which of its rows it is, exact when the lines above are laid out
+isize wrap_index_line_at(WrapIndex* wrap, isize row, isize* row_in_line);
+// moves line and row_in_line by delta display rows, every line passed over is laid out so this
+// is exact however the lines around it wrap
+void wrap_index_scroll(WrapIndex* wrap, isize* line, isize* row_in_line, isize delta);
+
+// the first position drawn, camera->row and camera->wrap_row are kept inside the text. wrap can
+// be NULL or not configured, drawing starts at the line's start then
+CameraPosition camera_start_position(TextCamera* camera, Text* txt, WrapIndex* wrap);
+
+#endif //LAYOUT_H_
@@ -1,99 +1,69 @@
 #include <raylib.h>
 #include <raymath.h>
-#define STRINGBUILDER_IMPLEMENTATION
 #include "stringbuilder.h"
-#define ARENA_IMPLEMENTATION
 #include "arena.h"
-#define ARRAYLIST_IMPLEMENTATION
 #include "arraylist.h"
 
 #include "short_types.h"
 
-#define GAPBUFFER_IMPLEMENTATION
 #include "gapbuffer.h"
 
 #include "text.h"
 #include "undo.h"
 #include "inputs.h"
 #include "camera.h"
-
-
-int keys[] = {KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z, KEY_ZERO, KEY_ONE, KEY_TWO, KEY_THREE, KEY_FOUR, KEY_FIVE, KEY_SIX, KEY_SEVEN, KEY_EIGHT, KEY_NINE, KEY_EQUAL, KEY_MINUS, KEY_COMMA, KEY_PERIOD, KEY_LEFT_BRACKET, KEY_RIGHT_BRACKET, KEY_SLASH, KEY_GRAVE, KEY_SEMICOLON, KEY_APOSTROPHE, KEY_TAB, KEY_SPACE, KEY_ENTER};
-
-char* keycode_to_char(KeyboardKey key, bool upper) {
-    switch (key)
-    {
-        case KEY_A: return upper ? "A" : "a";
-        case KEY_B: return upper ? "B" : "b";
-        case KEY_C: return upper ? "C" : "c";
-        case KEY_D: return upper ? "D" : "d";
-        case KEY_E: return upper ? "E" : "e";
-        case KEY_F: return upper ? "F" : "f";
-        case KEY_G: return upper ? "G" : "g";
-        case KEY_H: return upper ? "H" : "h";
-        case KEY_I: return upper ? "I" : "i";
-        case KEY_J: return upper ? "J" : "j";
-        case KEY_K: return upper ? "K" : "k";
-        case KEY_L: return upper ? "L" : "l";
-        case KEY_M: return upper ? "M" : "m";
-        case KEY_N: return upper ? "N" : "n";
-        case KEY_O: return upper ? "O" : "o";
-        case KEY_P: return upper ? "P" : "p";
-        case KEY_Q: return upper ? "Q" : "q";
-        case KEY_R: return upper ? "R" : "r";
-        case KEY_S: return upper ? "S" : "s";
-        case KEY_T: return upper ? "T" : "t";
-        case KEY_U: return upper ? "U" : "u";
-        case KEY_V: return upper ? "V" : "v";
-        case KEY_W: return upper ? "W" : "w";
-        case KEY_X: return upper ? "X" : "x";
-        case KEY_Y: return upper ? "Y" : "y";
-        case KEY_Z: return upper ? "Z" : "z";
-
-        case KEY_ONE:   return upper ? "!" : "1";
-        case KEY_TWO:   return upper ? "@" : "2";
-        case KEY_THREE: return upper ? "#" : "3";
-        case KEY_FOUR:  return upper ? "$" : "4";
-        case KEY_FIVE:  return upper ? "%" : "5";
-        case KEY_SIX:   return upper ? "^" : "6";
-        case KEY_SEVEN: return upper ? "&" : "7";
-        case KEY_EIGHT: return upper ? "*" : "8";
-        case KEY_NINE:  return upper ? "(" : "9";
-        case KEY_ZERO:  return upper ? ")" : "0";
-
-        case KEY_EQUAL:  return upper ? "+" : "=";
-        case KEY_MINUS:  return upper ? "_" : "-";
-        case KEY_COMMA: return upper ? "<" : ",";
-        case KEY_PERIOD: return upper ? ">" : ".";
-
-        case KEY_LEFT_BRACKET: return upper ? "{" : "[";
-        case KEY_RIGHT_BRACKET: return upper ? "}" : "]";
-        case KEY_BACKSLASH: return upper ? "|" : "\\";
-        case KEY_SLASH: return upper ? "?" : "/";
-        case KEY_GRAVE: return upper ? "~" : "`";
-        case KEY_SEMICOLON: return upper ? ":" : ";";
-        case KEY_APOSTROPHE: return upper ? "\"" : "\'";
-        case KEY_TAB: return "    ";
-        case KEY_SPACE: return " ";
-        case KEY_ENTER: return "\n";
-
-        default: return NULL; 
-    }
+#include "editor.h"
+#include "trace.h"
+#include "latency.h"
+#include "timer.h"
+#include "profiler.h"
+
+
+// raylib bundles glfw without wrapping this. it's safe from any thread, so background workers
+// call it when they have results to end the wait for input events
+void glfwPostEmptyEvent(void);
+
+// true while a timer needs frames without input events (key repeat, drag selecting) or a search
+// is still going. its buffer is copied a slice a frame and the matches it streams in, and the
+// selection waiting for them, show up as they come instead of with the next key
+bool wants_polling(Inputs* inputs, Editor* editor) {
+    Find* find = &editor->find;
+    return IsMouseButtonDown(MOUSE_BUTTON_LEFT) || inputs_any_held(inputs) || searcher_running(&find->searcher) || find->pending || find->restart;
 }
 
-bool still_word(Codepoint c) {
-    if (string_is_ascii_alpha(c) || string_is_digit(c, NULL) || c == '_') {
-        return false;
-    }
-    return true;
-}
-
-bool is_alpha_numeric(Codepoint c) {
-    if (string_is_ascii_alpha(c) || string_is_digit(c, NULL) || c == '_') {
-        return true;
+#ifdef PROFILER
+// one bar per zone of the last frame, nested zones are drawn below their parents
+void draw_frame_graph(Font font) {
+    static ProfilerZone zones[256];
+    i64 frame_begin, frame_end;
+    isize count = profiler_last_frame(zones, countof(zones), &frame_begin, &frame_end);
+    if (frame_end <= frame_begin) return;
+
+    float width = GetScreenWidth() / 2.0;
+    float x = GetScreenWidth() - width;
+    float y = GetScreenHeight() / 2.0;
+    float row_height = font.baseSize + 2;
+    f64 scale = width / (f64)(frame_end - frame_begin);
+
+    DrawRectangle(x, y, width, row_height * 6, GetColor(0xffffffe0));
+    DrawTextEx(font, TextFormat("frame %.2fms", (frame_end - frame_begin) / (f64)TIMER_NS_PER_MS), (Vector2){x, y}, font.baseSize, 1.0, BLACK);
+    for (isize i = 0; i < count; i++) {
+        ProfilerZone zone = zones[i];
+        Rectangle bar = {
+            .x = x + (zone.begin - frame_begin) * scale,
+            .y = y + (zone.depth + 1) * row_height,
+            .width = (zone.end - zone.begin) * scale,
+            .height = row_height - 1,
+        };
+        if (bar.width < 1) bar.width = 1;
+        DrawRectangleRec(bar, GetColor(0x6a83fcff));
+        const char* label = TextFormat("%s %.2fms", zone.name, (zone.end - zone.begin) / (f64)TIMER_NS_PER_MS);
+        if (MeasureTextEx(font, label, font.baseSize, 1.0).x < bar.width) {
+            DrawTextEx(font, label, (Vector2){bar.x, bar.y}, font.baseSize, 1.0, BLACK);
+        }
     }
-    return false;
 }
+#endif
 
 int main(i32 argc, char** argv) {
     SetTraceLogLevel(LOG_ERROR);
@@ -103,233 +73,215 @@ int main(i32 argc, char** argv) {
 
     int font_size = 20;
     
-    Text txt = {0};
-    TextCamera camera = {
-        .max_cols = 80,
-        .spacing = 1.0,
-        
-        .padding = font_size / 4,
-        .bottom_margin = font_size,
-        .left_margin = font_size * 3,
+    Editor editor = {
+        .txt = {.set_clipboard = SetClipboardText},
+        .camera = {
+            .max_cols = 80,
+            .spacing = 1.0,
+            
+            .padding = font_size / 4,
+            .bottom_margin = font_size,
+            .left_margin = font_size * 3,
+            .right_margin = MINIMAP_CELLS * MINIMAP_PIXEL_WIDTH,
+        },
+        .get_clipboard = GetClipboardText,
     };
+    editor.find.searcher.wake = glfwPostEmptyEvent;
+    Text* txt = &editor.txt;
+    TextCamera* camera = &editor.camera;
     Inputs inputs = {.cooldown = 0.5, .repeat_rate = 0.05};
-    Font font = LoadFontEx("fonts/ComicMono.ttf", font_size, NULL, 0);
+    // only ascii is rasterized up front, the rest of the glyphs as the text first uses them
+    GlyphAtlas atlas = {0};
+    glyph_atlas_load(&atlas, "fonts/ComicMono.ttf", font_size);
+    Font font = atlas.font;
     
-    if (argc > 1) {
-        text_load_file(&txt, argv[1]);
+    const char* latency_filename = NULL;
+    const char* trace_filename = NULL;
+    TraceWriter recording = {0};
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            latency_filename = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_filename = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            trace_writer_open(&recording, argv[++i]);
+        } else if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            const char* watch_filename = argv[++i];
+            if (!watchlist_load(&editor.watchlist, txt, watch_filename)) fprintf(stderr, "failed to read watchlist %s\n", watch_filename);
+        } else {
+            text_load_file(txt, argv[i]);
+        }
     }
-
-    bool alpha_num_streak = false;
-    bool space_streak = false;
-    bool delete_streak = false;
-
+    highlight_attach(&editor.highlighter, txt, highlight_language_for(txt->filename.data));
+    bracket_index_attach(&editor.brackets, txt, editor.highlighter.language);
+    marker_set_attach(&editor.bookmarks, txt);
+    wrap_index_attach(&editor.wrap, txt);
+    minimap_attach(&editor.minimap, txt, editor.highlighter.language);
+    editor.minimap.wake = glfwPostEmptyEvent;
+    MinimapView minimap_view = {0};
+    bool minimap_drag = false; // the left button went down on the minimap, the camera follows the mouse until it's released
+    LatencyTracker latency = {0};
+    bool frame_graph = false;
+
+    EnableEventWaiting();
     while(!WindowShouldClose()) {
+        PROFILE_FRAME();
+        glyph_atlas_next_frame(&atlas);
         float dt = GetFrameTime();
         inputs_get_inputs(&inputs, dt);
 
-        
-        bool cntrl = inputs.down[KEY_LEFT_CONTROL] || inputs.down[KEY_RIGHT_CONTROL];
-        bool shift = inputs.down[KEY_LEFT_SHIFT] || inputs.down[KEY_RIGHT_SHIFT];
-
-        if (cntrl && inputs.pressed[KEY_S]) {
-            text_save_file(&txt);
-        } else if (cntrl && inputs.pressed[KEY_L]) {
-            StringBuilder sb = {0};
-            text_prompt_filename(&sb);
-            text_load_file(&txt, sb.data);
-            reset_command(&txt.commands);
-            string_free(&sb);
-
-            alpha_num_streak = false;
-            space_streak = false;
-            delete_streak = false;
-        } else if (cntrl && inputs.pressed_repeat[KEY_V]) {
-            text_begin_command(&txt);
-
-            const char* str = GetClipboardText();
-
-            text_cursor_insert(&txt, string_from_cstring(str));
-            text_end_command(&txt);
-        } else if (cntrl && inputs.pressed[KEY_X]) {
-            text_begin_command(&txt);
-            text_copy_and_delete_selection_to_clipboard(&txt);
-            text_end_command(&txt);
-        } else if (cntrl && inputs.pressed[KEY_C]) {
-            // ctrl c
-            text_copy_selection_to_clipboard(&txt);
-        } else if (cntrl && inputs.pressed_repeat[KEY_Z]) {
-            alpha_num_streak = false;
-            space_streak = false;
-            delete_streak = false;
-            text_undo(&txt);
-        } else if (cntrl && inputs.pressed_repeat[KEY_Y]) {
-            text_redo(&txt);
-        } else if (cntrl && inputs.pressed[KEY_A]) {
-            text_cursor_moveto(&txt, 0, 0);
-            text_select_begin(&txt);
-            txt.selection_end = gapbuf_count(&txt.gapbuf);
-        }
-
-        text_cursor_update_position(&txt);
-        float mousewheel_movement = GetMouseWheelMove();
-        if (mousewheel_movement != 0) {
-            camera.row -= mousewheel_movement;
-        }
-
-        bool cursor_moved = false;
-
-        if (inputs.pressed_repeat[KEY_LEFT]) {
-            if (txt.selected && !shift && txt.selection_begin != txt.selection_end) { 
-                text_cursor_move_to_selected(&txt, false);
-                cursor_moved = true;
-            } else if (cntrl) {
-                text_cursor_move_until(&txt, false, still_word);
-                cursor_moved = true;
-            } else {
-                text_cursor_move_codepoints(&txt, -1);
-                cursor_moved = true;
-            }
-        } else if (inputs.pressed_repeat[KEY_RIGHT]) {
-            if (txt.selected && !shift && txt.selection_begin != txt.selection_end) { 
-                text_cursor_move_to_selected(&txt, true);
-                cursor_moved = true;
-            } else if (cntrl) {
-                text_cursor_move_until(&txt, true, still_word);
-                cursor_moved = true;
-            } else {
-                text_cursor_move_codepoints(&txt, 1);
-                cursor_moved = true;
-            }
-        } else if (inputs.pressed_repeat[KEY_UP]) {
-            if (cntrl) {
-                camera.row--;
-            } else if (txt.selected && !shift && txt.selection_begin != txt.selection_end) {
-                text_cursor_move_to_selected(&txt, false);
-                cursor_moved = true;
-            } else {
-                text_cursor_moveto(&txt, txt.cursor_col, txt.cursor_line - 1);
-                cursor_moved = true;
-            }
-        } else if (inputs.pressed_repeat[KEY_DOWN]) {
-            if (cntrl) {
-                camera.row++;
-            } else if (txt.selected && !shift && txt.selection_begin != txt.selection_end) {
-                text_cursor_move_to_selected(&txt, true);
-                cursor_moved = true;
-            } else {
-                text_cursor_moveto(&txt, txt.cursor_col, txt.cursor_line + 1);
-                cursor_moved = true;
-            }
-        } else if (inputs.pressed_repeat[KEY_HOME]) {
-            text_cursor_moveto(&txt, 0, txt.cursor_line); cursor_moved = true; 
-        } else if (inputs.pressed_repeat[KEY_END]) {
-            text_cursor_moveto(&txt, ISIZE_MAX, txt.cursor_line); cursor_moved = true; 
-        } else if (inputs.pressed_repeat[KEY_PAGE_UP]) {
-            if (cntrl) {
-                camera.row -= 20;
-            } else {
-                text_cursor_moveto(&txt, txt.cursor_col, txt.cursor_line - 20);
-                cursor_moved = true;
+        camera->width = GetScreenWidth();
+        camera->height = GetScreenHeight();
+
+        // keys that act on the window and files rather than the text
+        for (isize i = 0; i < arrlist_count(inputs.events); i++) {
+            InputEvent event = inputs.events[i];
+            latency_input(&latency, event.time);
+            if (event.repeat) continue;
+
+            if (event.key == KEY_S && inputs.cntrl) {
+                text_save_file(txt);
+            } else if (event.key == KEY_L && inputs.cntrl) {
+                StringBuilder sb = {0};
+                text_prompt_filename(&sb);
+                text_load_file(txt, sb.data);
+                highlight_set_language(&editor.highlighter, highlight_language_for(txt->filename.data));
+                // loading was an edit like any other, the brackets only need indexing again for a new language
+                if (editor.brackets.language != editor.highlighter.language) bracket_index_set_language(&editor.brackets, editor.highlighter.language);
+                // the old file's bookmarks would all have collapsed onto the start of the new one
+                marker_set_attach(&editor.bookmarks, txt);
+                minimap_set_language(&editor.minimap, editor.highlighter.language);
+                reset_command(&txt->commands);
+                string_free(&sb);
+
+                editor.streak = (UndoStreak){0};
+            } else if (event.key == KEY_F12) {
+                latency.overlay = !latency.overlay;
+            } else if (event.key == KEY_F11) {
+                frame_graph = !frame_graph;
             }
-        } else if (inputs.pressed_repeat[KEY_PAGE_DOWN]) {
-            if (cntrl) {
-                camera.row += 20;
-            } else {
-                text_cursor_moveto(&txt, txt.cursor_col, txt.cursor_line + 20);
-                cursor_moved = true;
-            } 
         }
 
-        if (shift) {
-            text_select_end(&txt);
-        }
-        text_update_line_offsets(&txt);
-        text_cursor_update_position(&txt);
-
-        if (inputs.pressed_repeat[KEY_BACKSPACE] || inputs.pressed_repeat[KEY_DELETE]) {
-            if (!delete_streak) {
-                text_begin_command(&txt);
-            }
-            
-            if (inputs.pressed_repeat[KEY_BACKSPACE]) {
-                text_cursor_remove_before(&txt, 1);
-            } else if (inputs.pressed_repeat[KEY_DELETE]) {
-                text_cursor_remove_after(&txt, 1);
+        EditorInput input = {
+            .events = inputs.events,
+            .event_count = arrlist_count(inputs.events),
+            .cntrl = inputs.cntrl,
+            .shift = inputs.shift,
+            .alt = inputs.alt,
+            .wheel = GetMouseWheelMove(),
+        };
+        editor_update(&editor, input);
+        // the rows the worker laid out since the last frame, an edit this frame already started the next one
+        minimap_poll(&editor.minimap);
+        latency_mark(&latency, LATENCY_EDIT);
+
+        // clicking or dragging on the minimap centres its line, the text under it isn't selected
+        Vector2 mouse_at = GetMousePosition();
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) minimap_drag = camera_minimap_line(&editor, mouse_at) >= 0;
+        if (!IsMouseButtonDown(MOUSE_BUTTON_LEFT)) minimap_drag = false;
+        if (minimap_drag) {
+            isize line = camera_minimap_line(&editor, (Vector2){GetScreenWidth() - 1, mouse_at.y < 0 ? 0 : mouse_at.y});
+            if (line >= 0) {
+                line -= (GetScreenHeight() - camera->bottom_margin) / font.baseSize / 2;
+                camera->row = line > 0 ? line : 0;
+                camera->wrap_row = 0;
             }
-
-            delete_streak = true;
-            alpha_num_streak = false;
-            space_streak = false;
-        }
-        
-        if (!txt.selected && shift) {
-            text_select_begin(&txt);
         }
 
-        for (isize i = 0; i < countof(keys); i++) {
-            int key = keys[i];
-            if (inputs.pressed_repeat[key]) {
-                char* s = keycode_to_char(key, shift);            
-                if (s != NULL && !cntrl) {
-                    if (alpha_num_streak && (is_alpha_numeric(*s))) {}
-                    else if (space_streak && (string_is_ascii_whitespace(*s))) {}
-                    else text_begin_command(&txt);
-
-                    text_cursor_insert(&txt, string_from_cstring(s));
-
-                    alpha_num_streak = false;
-                    space_streak = false;
-                    delete_streak = false;
-
-                    if (is_alpha_numeric(*s)) alpha_num_streak = true;
-                    if (string_is_ascii_whitespace(*s)) space_streak = true;
-                    cursor_moved = true;
-                }
-            }
-        }
+        BeginDrawing();
+        EditorMouse mouse = {
+            .pos = camera_mouse_pos(camera, txt, &editor.wrap, &atlas),
+            .pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT),
+            .down = IsMouseButtonDown(MOUSE_BUTTON_LEFT),
+            .shift = inputs.shift,
+            .alt = inputs.alt,
+        };
+        if (minimap_drag) mouse = (EditorMouse){.shift = inputs.shift, .alt = inputs.alt};
+        camera_draw(&editor, &atlas);
+        camera_draw_minimap(&editor, &minimap_view, font);
+        latency_mark(&latency, LATENCY_LAYOUT);
+
+        editor_mouse(&editor, mouse);
+        trace_write_frame(&recording, input, mouse);
+
+        float y_top = GetScreenHeight() - camera->bottom_margin;
 
-        if (cursor_moved) {
-            if (txt.cursor_line < camera.row) {
-                camera.row = txt.cursor_line;
-            } else if (txt.cursor_line > camera.row + 20) {
-                camera.row = txt.cursor_line - 20;
+        DrawLine(0, y_top, GetScreenWidth(), y_top, BLACK);
+        DrawLine(camera->left_margin, 0, camera->left_margin, GetScreenHeight() - camera->bottom_margin, BLACK);
+        DrawLine(GetScreenWidth() - camera->right_margin, 0, GetScreenWidth() - camera->right_margin, GetScreenHeight() - camera->bottom_margin, BLACK);
+        
+        DrawTextEx(font, TextFormat("(%ld, %ld) %s", txt->cursor_line + 1, txt->cursor_col + 1, txt->filename.data ? txt->filename.data : "(unnamed file)"), (Vector2){camera->padding, GetScreenHeight() - camera->bottom_margin + camera->padding}, font.baseSize, 1.0, BLACK);
+        if (editor.find.active) {
+            Find* find = &editor.find;
+            const char* detail = find->found || find->query.count == 0 ? "" : "  (not found)";
+            if (find->pending) detail = "  (searching)";
+            if (find->regex && find->compiled.error != NULL && find->query.count > 0) detail = TextFormat("  (%s)", find->compiled.error);
+            if (find->found && find->matches.valid) {
+                isize current = match_index_find(&find->matches, txt->selection_begin < txt->selection_end ? txt->selection_begin : txt->selection_end);
+                detail = TextFormat("  %ld of %ld%s", current + 1, (isize)arrlist_count(find->matches.matches), searcher_running(&find->searcher) ? "+" : "");
             }
-
-            if (!shift) {
-                txt.selected = false;
+            const char* status = TextFormat("%s: %.*s%s", find->regex ? "regex" : "find", (int)find->query.count, find->query.data ? find->query.data : "", detail);
+            if (find->replacing || find->replacement.count > 0) {
+                // the field typing goes to ends in an underscore
+                status = TextFormat("%s  replace with: %.*s%s", status, (int)find->replacement.count, find->replacement.data ? find->replacement.data : "", find->replacing ? "_" : "");
             }
+            float width = MeasureTextEx(font, status, font.baseSize, 1.0).x;
+            DrawTextEx(font, status, (Vector2){GetScreenWidth() - width - camera->padding, GetScreenHeight() - camera->bottom_margin + camera->padding}, font.baseSize, 1.0, find->found || find->query.count == 0 ? BLACK : RED);
         }
-        
-        text_update_line_offsets(&txt);
-        text_cursor_update_position(&txt);
-
-        BeginDrawing();
-        MouseCursorPosition mouse_pos = camera_mouse_pos(&camera, &txt, font);
-        camera_draw(&camera, &txt, font);
-
-        if (mouse_pos.exists && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            text_cursor_moveto(&txt, mouse_pos.pos.col, mouse_pos.pos.line);
-            if (shift) {
-                text_select_end(&txt);
-            } else {
-                text_select_begin(&txt);
+    
+        if (latency.overlay) {
+            for (isize i = 0; i < LATENCY_STAGE_COUNT; i++) {
+                LatencyHistogram* histogram = &latency.stages[i];
+                const char* line = TextFormat("%-8s p50 %5.1fms  p99 %5.1fms  max %5.1fms", latency_stage_name(i),
+                    latency_percentile(histogram, 50) / (f64)TIMER_NS_PER_MS,
+                    latency_percentile(histogram, 99) / (f64)TIMER_NS_PER_MS,
+                    histogram->max_ns / (f64)TIMER_NS_PER_MS
+                );
+                float width = MeasureTextEx(font, line, font.baseSize, 1.0).x;
+                DrawTextEx(font, line, (Vector2){GetScreenWidth() - width - camera->padding, camera->padding + i * font.baseSize}, font.baseSize, 1.0, RED);
             }
         }
-        if (mouse_pos.exists && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            text_cursor_moveto(&txt, mouse_pos.pos.col, mouse_pos.pos.line);
-            text_select_end(&txt);
-        }
-
-        float y_top = GetScreenHeight() - camera.bottom_margin;
-
-        DrawLine(0, y_top, GetScreenWidth(), y_top, BLACK);
-        DrawLine(camera.left_margin, 0, camera.left_margin, GetScreenHeight() - camera.bottom_margin, BLACK);
-        
-        DrawTextEx(font, TextFormat("(%ld, %ld) %s", txt.cursor_line + 1, txt.cursor_col + 1, txt.filename.data ? txt.filename.data : "(unnamed file)"), (Vector2){camera.padding, GetScreenHeight() - camera.bottom_margin + camera.padding}, font.baseSize, 1.0, BLACK);
+        #ifdef PROFILER
+        if (frame_graph) draw_frame_graph(font);
+        #endif
     
         ClearBackground(WHITE);
+
+        // escape closes find, and then clears its highlights, before it closes the window
+        SetExitKey(editor.find.active || editor.find.matches.valid ? KEY_NULL : KEY_ESCAPE);
+
+        // only keep polling while something is animating (held keys repeat, mouse drags) or a search
+        // runs, otherwise EndDrawing blocks until the next input event arrives. it's decided before
+        // EndDrawing since that's where this frame waits. the minimap's worker ends the wait itself.
+        // a frame that handled input doesn't wait either, the idle time until the next event would
+        // be counted as its present latency. the frame after it waits instead
+        if (wants_polling(&inputs, &editor) || latency_sampling(&latency)) {
+            DisableEventWaiting();
+        } else {
+            EnableEventWaiting();
+        }
+
+        PROFILE_BEGIN("EndDrawing");
         EndDrawing();
+        PROFILE_END("EndDrawing");
+        latency_mark(&latency, LATENCY_PRESENT);
+    }
+    // the workers are joined first, the profiler reads their rings without locking
+    searcher_free(&editor.find.searcher);
+    minimap_free(&editor.minimap);
+    trace_writer_close(&recording);
+    if (latency_filename) {
+        latency_write_file(&latency, latency_filename);
+    }
+    #ifdef PROFILER
+    if (trace_filename) {
+        profiler_write_trace(trace_filename);
     }
+    #else
+    (void)trace_filename;
+    (void)frame_graph;
+    #endif
+    glyph_atlas_unload(&atlas);
     CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "markers.h"
+#include "profiler.h"
+#include <assert.h>
+
+static void marker_on_edit(void* data, Text* txt, TextEdit edit) {
+    (void)txt;
+    MarkerSet* set = data;
+    PROFILE_BEGIN("marker_on_edit");
+    gaptreap_edit(&set->tree, edit.index, edit.removed, edit.inserted);
+    PROFILE_END("marker_on_edit");
+}
+
+void marker_set_attach(MarkerSet* set, Text* txt) {
+    marker_set_free(set);
+    set->txt = txt;
+    gaptreap_init(&set->tree, NULL, NULL);
+    text_add_listener(txt, (TextListener){marker_on_edit, set});
+}
+
+void marker_set_free(MarkerSet* set) {
+    if (set->txt) text_remove_listener(set->txt, set);
+    gaptreap_free(&set->tree);
+    *set = (MarkerSet){0};
+}
+
+isize marker_count(MarkerSet* set) {
+    return gaptreap_count(&set->tree);
+}
+
+Marker marker_add(MarkerSet* set, isize index) {
+    assert(set->txt && "marker set isn't attached");
+    return gaptreap_insert(&set->tree, index);
+}
+
+void marker_remove(MarkerSet* set, Marker marker) {
+    gaptreap_remove(&set->tree, marker);
+}
+
+isize marker_index(MarkerSet* set, Marker marker) {
+    return gaptreap_position(&set->tree, marker);
+}
+
+Marker marker_next(MarkerSet* set, isize from, isize* index) {
+    i64 at = 0;
+    Marker found = gaptreap_next(&set->tree, from, &at);
+    if (found != 0) *index = at;
+    return found;
+}
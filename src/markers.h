@@ -0,0 +1,35 @@
+#ifndef MARKERS_H_
+#define MARKERS_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "gaptreap.h"
+
+// positions in the text that move with its edits, for bookmarks, diagnostics or anything else that
+// has to point at the same bytes however the text around them changes.
+//
+// the markers are nodes of a gap treap (gaptreap.h), an edit moves every marker after it by changing
+// one gap and adding, removing or finding a marker is O(log n) however many there are. a marker in
+// bytes an edit removes ends up where the edit was, a marker exactly where text is inserted ends up
+// after it like the cursor
+
+typedef i32 Marker; // 0 is no marker
+
+typedef struct MarkerSet {
+    Text* txt;
+    GapTreap tree; // markers are their node's index
+} MarkerSet;
+
+// starts an empty set that keeps up with txt's edits, any markers from before are dropped
+void marker_set_attach(MarkerSet* set, Text* txt);
+void marker_set_free(MarkerSet* set);
+
+isize marker_count(MarkerSet* set);
+Marker marker_add(MarkerSet* set, isize index);
+void marker_remove(MarkerSet* set, Marker marker);
+// where the marker is in the text now
+isize marker_index(MarkerSet* set, Marker marker);
+// the first marker at or after from and where it is, 0 when there's none
+Marker marker_next(MarkerSet* set, isize from, isize* index);
+
+#endif //MARKERS_H_
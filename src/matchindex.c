@@ -0,0 +1,176 @@
+#include "matchindex.h"
+#include "search.h"
+#include "thread.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+// the matches starting in [begin, end), a chunk reads needle.count - 1 bytes past its end
+// so matches crossing into the next chunk belong to this one and none are lost
+typedef struct MatchChunk {
+    GapBuffer* gapbuf;
+    String needle;
+    isize begin;
+    isize end;
+    MatchRange* matches;
+} MatchChunk;
+
+static void match_chunk_search(void* arg) {
+    MatchChunk* chunk = arg;
+    isize at = search_find_before(chunk->gapbuf, chunk->needle, chunk->begin, chunk->end);
+    while (at >= 0) {
+        arrlist_append(chunk->matches, ((MatchRange){at, at + chunk->needle.count}));
+        at = search_find_before(chunk->gapbuf, chunk->needle, at + 1, chunk->end);
+    }
+}
+
+void match_index_reset(MatchIndex* index, String needle, Regex* regex) {
+    arrlist_setcount(index->matches, 0);
+    string_clear(&index->needle);
+    string_append_string(&index->needle, needle);
+    index->regex = regex;
+    index->valid = true;
+}
+
+// splits the range into one chunk per core, the gap buffer is only read so the workers share it
+void match_index_search(GapBuffer* gapbuf, String needle, isize begin, isize end, MatchRange** matches) {
+    if (needle.count == 0 || begin >= end) return;
+    isize count = end - begin;
+    isize chunk_count = count < MATCH_INDEX_PARALLEL_MIN ? 1 : thread_cpu_count();
+    if (chunk_count > MATCH_INDEX_MAX_THREADS) chunk_count = MATCH_INDEX_MAX_THREADS;
+
+    MatchChunk chunks[MATCH_INDEX_MAX_THREADS];
+    Thread threads[MATCH_INDEX_MAX_THREADS];
+    bool started[MATCH_INDEX_MAX_THREADS] = {0};
+    for (isize i = 0; i < chunk_count; i++) {
+        chunks[i] = (MatchChunk){gapbuf, needle, begin + count * i / chunk_count, begin + count * (i + 1) / chunk_count, NULL};
+    }
+    chunks[0].matches = *matches;
+    for (isize i = 1; i < chunk_count; i++) {
+        started[i] = thread_start(&threads[i], match_chunk_search, &chunks[i]);
+    }
+    match_chunk_search(&chunks[0]);
+
+    // the chunks are in buffer order so appending them one after the other keeps the matches sorted
+    *matches = chunks[0].matches;
+    for (isize i = 1; i < chunk_count; i++) {
+        if (started[i]) thread_join(threads[i]);
+        else match_chunk_search(&chunks[i]);
+
+        isize found = arrlist_count(chunks[i].matches);
+        if (found == 0) continue;
+        isize at = arrlist_count(*matches);
+        arrlist_setcount(*matches, at + found);
+        memcpy(*matches + at, chunks[i].matches, found * sizeof(MatchRange));
+        arrlist_free(chunks[i].matches);
+    }
+}
+
+void match_index_build(MatchIndex* index, GapBuffer* gapbuf, String needle) {
+    PROFILE_BEGIN("match_index_build");
+    match_index_reset(index, needle, NULL);
+    match_index_search(gapbuf, needle, 0, gapbuf_count(gapbuf), &index->matches);
+    PROFILE_END("match_index_build");
+}
+
+bool match_index_narrow(MatchIndex* index, GapBuffer* gapbuf, String needle) {
+    String indexed = string_build(index->needle);
+    if (!index->valid || index->regex || indexed.count == 0 || needle.count < indexed.count) return false;
+    if (memcmp(needle.data, indexed.data, indexed.count) != 0) return false;
+
+    PROFILE_BEGIN("match_index_narrow");
+    // the first indexed.count bytes are known to match already
+    String rest = {needle.data + indexed.count, needle.count - indexed.count};
+    isize kept = 0;
+    for (isize i = 0; i < arrlist_count(index->matches); i++) {
+        isize begin = index->matches[i].begin;
+        if (rest.count == 0 || search_match_at(gapbuf, rest, begin + indexed.count)) {
+            index->matches[kept++] = (MatchRange){begin, begin + needle.count};
+        }
+    }
+    arrlist_setcount(index->matches, kept);
+    string_append_string(&index->needle, rest);
+    PROFILE_END("match_index_narrow");
+    return true;
+}
+
+void match_index_build_regex(MatchIndex* index, GapBuffer* gapbuf, Regex* regex) {
+    PROFILE_BEGIN("match_index_build_regex");
+    match_index_reset(index, (String){0}, regex);
+
+    RegexMatch* found = NULL;
+    regex_find_all(regex, gapbuf, &found);
+    for (isize i = 0; i < arrlist_count(found); i++) {
+        arrlist_append(index->matches, ((MatchRange){found[i].begin, found[i].end}));
+    }
+    arrlist_free(found);
+    PROFILE_END("match_index_build_regex");
+}
+
+void match_index_clear(MatchIndex* index) {
+    arrlist_setcount(index->matches, 0);
+    index->regex = NULL;
+    index->valid = false;
+}
+
+void match_index_free(MatchIndex* index) {
+    arrlist_free(index->matches);
+    string_free(&index->needle);
+    *index = (MatchIndex){0};
+}
+
+isize match_index_next(MatchIndex* index, isize position) {
+    isize lo = 0, hi = arrlist_count(index->matches);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (index->matches[mid].begin < position) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+isize match_index_find(MatchIndex* index, isize position) {
+    isize lo = 0, hi = arrlist_count(index->matches);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (index->matches[mid].end <= position) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void match_index_edit(MatchIndex* index, GapBuffer* gapbuf, TextEdit edit) {
+    if (!index->valid) return;
+    if (index->regex) {
+        match_index_build_regex(index, gapbuf, index->regex);
+        return;
+    }
+    String needle = string_build(index->needle);
+    if (needle.count == 0) return;
+    PROFILE_BEGIN("match_index_edit");
+
+    // matches overlapping the removed bytes, or around the point where bytes were inserted, are gone
+    isize first = match_index_next(index, edit.index - needle.count + 1);
+    isize last = match_index_next(index, edit.index + edit.removed);
+
+    // new ones have to overlap the inserted bytes, or join the text on both sides of a removal
+    MatchChunk window = {gapbuf, needle, edit.index - needle.count + 1, edit.index + edit.inserted, NULL};
+    match_chunk_search(&window);
+    isize found = arrlist_count(window.matches);
+
+    isize old_count = arrlist_count(index->matches);
+    isize new_count = old_count - (last - first) + found;
+    if (new_count > old_count) arrlist_setcount(index->matches, new_count);
+    memmove(index->matches + first + found, index->matches + last, (old_count - last) * sizeof(MatchRange));
+    if (found > 0) memcpy(index->matches + first, window.matches, found * sizeof(MatchRange));
+    arrlist_setcount(index->matches, new_count);
+    arrlist_free(window.matches);
+
+    isize delta = edit.inserted - edit.removed;
+    for (isize i = first + found; i < new_count; i++) {
+        index->matches[i].begin += delta;
+        index->matches[i].end += delta;
+    }
+    PROFILE_END("match_index_edit");
+}
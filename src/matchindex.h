@@ -0,0 +1,51 @@
+#ifndef MATCHINDEX_H_
+#define MATCHINDEX_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "regexp.h"
+
+// every match of the find query in the buffer sorted by where it starts, used to highlight
+// matches on screen and count them
+//
+// plain text queries index every occurrence, overlapping ones included, so whether a match
+// exists only depends on the bytes under it and an edit is patched in by searching around
+// it again. regex matches can depend on text far away (leftmost longest, ^ and $) so those
+// are searched again from scratch after every edit
+
+#define MATCH_INDEX_PARALLEL_MIN (1 << 20) // smaller buffers are searched on the calling thread
+#define MATCH_INDEX_MAX_THREADS 16
+
+typedef TextRange MatchRange;
+
+typedef struct MatchIndex {
+    MatchRange* matches; // arraylist
+    bool valid;
+
+    StringBuilder needle;
+    Regex* regex; // not owned, the index is rebuilt with it when set
+} MatchIndex;
+
+// empties the index and sets what it holds the matches of, for filling it in piece by piece
+void match_index_reset(MatchIndex* index, String needle, Regex* regex);
+// appends the matches of needle starting in [begin, end) to the matches arraylist, large ranges are split across threads
+void match_index_search(GapBuffer* gapbuf, String needle, isize begin, isize end, MatchRange** matches);
+
+void match_index_build(MatchIndex* index, GapBuffer* gapbuf, String needle);
+// when needle only adds to the end of the indexed one its matches are a subset of the ones
+// indexed, those are checked against it instead of searching the buffer again. returns false
+// (and leaves the index alone) if the index can't be narrowed to needle
+bool match_index_narrow(MatchIndex* index, GapBuffer* gapbuf, String needle);
+void match_index_build_regex(MatchIndex* index, GapBuffer* gapbuf, Regex* regex);
+void match_index_clear(MatchIndex* index);
+void match_index_free(MatchIndex* index);
+
+// moves the matches after the edit and searches the edited window again
+void match_index_edit(MatchIndex* index, GapBuffer* gapbuf, TextEdit edit);
+
+// index of the first match that ends after position, the match count if there is none
+isize match_index_find(MatchIndex* index, isize position);
+// index of the first match that starts at or after position, the match count if there is none
+isize match_index_next(MatchIndex* index, isize position);
+
+#endif //MATCHINDEX_H_
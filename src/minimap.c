@@ -0,0 +1,303 @@
+#include "minimap.h"
+#include "thread.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// owned by the minimap and the worker, whichever lets go last frees it
+struct MinimapJob {
+    atomic_int refs;
+    atomic_bool cancelled;
+    atomic_bool done;
+
+    const HighlightLanguage* language;
+    void (*wake)(void);
+    isize first;           // the line the copy starts with
+    isize count;           // lines copied
+    isize clean;           // lines from here on were right before the edits
+    LexState start;
+    char* bytes;           // the lines with their newlines
+    isize* ends;           // where every line ends in bytes
+    LexState* old_states;  // what the lines ended in before
+
+    // written by the worker
+    MinimapCell* cells;    // MINIMAP_CELLS for every line
+    LexState* states;
+    isize laid_out;        // fewer than count when it caught up with the old states
+    bool caught_up;
+};
+
+static void minimap_job_release(void* arg) {
+    MinimapJob* job = arg;
+    if (atomic_fetch_sub(&job->refs, 1) != 1) return;
+    free(job->bytes);
+    free(job->ends);
+    free(job->old_states);
+    free(job->cells);
+    free(job->states);
+    free(job);
+}
+
+static bool minimap_blank(u8 c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// the columns the cells show are lexed for their spans, the rest of the line only for the state it
+// ends in. a continuation byte doesn't start a column
+static LexState minimap_lay_out_line(const HighlightLanguage* language, LexState state, const char* data, isize count, MinimapCell* cells, HighlightSpan** spans) {
+    isize shown = 0;
+    for (isize cols = 0; shown < count; shown++) {
+        if (((u8)data[shown] & 0xc0) == 0x80) continue;
+        if (cols++ == MINIMAP_CELLS * MINIMAP_CELL_COLS) break;
+    }
+    arrlist_setcount(*spans, 0);
+    if (language) {
+        state = highlight_lex_line(language, state, data, shown, spans);
+        state = highlight_lex_line(language, state, data + shown, count - shown, NULL);
+    }
+
+    u8 ink[MINIMAP_CELLS] = {0};
+    u8 kinds[MINIMAP_CELLS][HIGHLIGHT_KIND_COUNT] = {0};
+    isize span = 0, span_count = arrlist_count(*spans);
+    isize col = 0;
+    for (isize i = 0; i < shown; i++) {
+        u8 c = data[i];
+        if ((c & 0xc0) == 0x80) continue;
+        isize cell = col++ / MINIMAP_CELL_COLS;
+        if (minimap_blank(c)) continue;
+        while (span < span_count && (*spans)[span].end <= i) span++;
+        HighlightKind kind = span < span_count && (*spans)[span].begin <= i ? (*spans)[span].kind : HIGHLIGHT_TEXT;
+        ink[cell]++;
+        kinds[cell][kind]++;
+    }
+    for (isize cell = 0; cell < MINIMAP_CELLS; cell++) {
+        u8 best = HIGHLIGHT_TEXT;
+        for (u8 kind = 0; kind < HIGHLIGHT_KIND_COUNT; kind++) {
+            if (kinds[cell][kind] > kinds[cell][best]) best = kind;
+        }
+        cells[cell] = best << 4 | ink[cell];
+    }
+    return state;
+}
+
+// a line after the ones that were edited starts in the state the line before it ends in, once
+// that's the same as before the edits every line after it is still right
+static void minimap_job_main(void* arg) {
+    MinimapJob* job = arg;
+    PROFILE_BEGIN("minimap_job");
+    HighlightSpan* spans = NULL;
+    LexState state = job->start;
+    isize begin = 0;
+    for (isize i = 0; i < job->count && !atomic_load_explicit(&job->cancelled, memory_order_relaxed); i++) {
+        state = minimap_lay_out_line(job->language, state, job->bytes + begin, job->ends[i] - begin, job->cells + i * MINIMAP_CELLS, &spans);
+        job->states[i] = state;
+        job->laid_out = i + 1;
+        begin = job->ends[i];
+        if (i + 1 >= job->clean && state == job->old_states[i]) {
+            job->caught_up = true;
+            break;
+        }
+    }
+    arrlist_free(spans);
+    atomic_store_explicit(&job->done, true, memory_order_release);
+    if (job->wake && !atomic_load_explicit(&job->cancelled, memory_order_relaxed)) job->wake();
+    PROFILE_END("minimap_job");
+}
+
+static isize minimap_line_begin(Text* txt, isize line) {
+    return line > 0 ? txt->line_offsets[line - 1] : 0;
+}
+
+static isize minimap_line_end(Text* txt, isize line) {
+    return line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf);
+}
+
+// copies the out of date lines from the first one on, as many as fit in MINIMAP_JOB_BYTES
+static void minimap_start_job(Minimap* map) {
+    PROFILE_BEGIN("minimap_start_job");
+    Text* txt = map->txt;
+    isize lines = arrlist_count(map->states);
+    isize first = map->dirty_begin;
+    isize begin = minimap_line_begin(txt, first);
+    isize count = 0;
+    while (first + count < lines && (count == 0 || minimap_line_end(txt, first + count - 1) - begin < MINIMAP_JOB_BYTES)) count++;
+    isize end = minimap_line_end(txt, first + count - 1);
+
+    MinimapJob* job = calloc(1, sizeof(MinimapJob));
+    assert(job && "calloc failed");
+    atomic_init(&job->refs, 1);
+    job->language = map->language;
+    job->wake = map->wake;
+    job->first = first;
+    job->count = count;
+    job->clean = map->dirty_end - first;
+    job->start = first > 0 ? map->states[first - 1] : LEX_LINE_START;
+    job->bytes = malloc(end - begin + 1);
+    job->ends = malloc(count * sizeof(isize));
+    job->old_states = malloc(count);
+    job->cells = malloc(count * MINIMAP_CELLS);
+    job->states = malloc(count);
+    assert(job->bytes && job->ends && job->old_states && job->cells && job->states && "malloc failed");
+    GapBufSlice bytes = gapbuf_slice(&txt->gapbuf, begin, end);
+    if (bytes.l.count > 0) memcpy(job->bytes, bytes.l.data, bytes.l.count);
+    if (bytes.r.count > 0) memcpy(job->bytes + bytes.l.count, bytes.r.data, bytes.r.count);
+    for (isize i = 0; i < count; i++) job->ends[i] = minimap_line_end(txt, first + i) - begin;
+    memcpy(job->old_states, map->states + first, count);
+
+    map->job = job;
+    if (map->worker == NULL) map->worker = worker_start(minimap_job_release);
+    if (map->worker) {
+        atomic_fetch_add(&job->refs, 1); // the worker's
+        worker_post(map->worker, minimap_job_main, job);
+    } else {
+        job->wake = NULL;
+        minimap_job_main(job); // no thread to be had, lay them out right here instead
+    }
+    PROFILE_END("minimap_start_job");
+}
+
+static void minimap_mark(Minimap* map, isize begin, isize end) {
+    if (map->dirty_begin == map->dirty_end) {
+        map->dirty_begin = begin;
+        map->dirty_end = end;
+        return;
+    }
+    if (begin < map->dirty_begin) map->dirty_begin = begin;
+    if (end > map->dirty_end) map->dirty_end = end;
+}
+
+// the worker copied the text from before the edit, its lines are laid out again with the edited ones
+static void minimap_cancel(Minimap* map) {
+    MinimapJob* job = map->job;
+    if (job == NULL) return;
+    minimap_mark(map, job->first, job->first + job->count);
+    atomic_store(&job->cancelled, true);
+    minimap_job_release(job);
+    map->job = NULL;
+}
+
+// where an out of date range ends up: lines before the edit stay, the ones after move with it and
+// the ones it replaced are its new lines
+static isize minimap_shift_line(isize line, isize first, isize last, isize inserted_lines, bool end) {
+    if (line > last) return line + inserted_lines - (last - first + 1);
+    if (line > first) return end ? first + inserted_lines : first;
+    return line;
+}
+
+// line offsets still describe the text before the edit. the rows it touched are swapped for as many
+// blank ones as it left, the last of them keeps the state the old last line ended in so the worker
+// can tell when the lines after it are right again
+static void minimap_on_edit(void* data, Text* txt, TextEdit edit) {
+    Minimap* map = data;
+    PROFILE_BEGIN("minimap_on_edit");
+    minimap_cancel(map);
+    isize first = text_line_of(txt, edit.index);
+    isize last = text_line_of(txt, edit.index + edit.removed);
+    isize added = 0;
+    GapBufSlice inserted = gapbuf_slice(&txt->gapbuf, edit.index, edit.index + edit.inserted);
+    for (isize i = 0; i < inserted.l.count; i++) added += inserted.l.data[i] == '\n';
+    for (isize i = 0; i < inserted.r.count; i++) added += inserted.r.data[i] == '\n';
+
+    isize count = arrlist_count(map->states);
+    isize removed_lines = last - first + 1;
+    isize inserted_lines = added + 1;
+    LexState carried = map->states[last];
+    if (removed_lines != inserted_lines) {
+        isize new_count = count - removed_lines + inserted_lines;
+        if (new_count > count) {
+            arrlist_setcount(map->states, new_count);
+            arrlist_setcount(map->cells, new_count * MINIMAP_CELLS);
+        }
+        memmove(map->states + first + inserted_lines, map->states + last + 1, count - last - 1);
+        memmove(map->cells + (first + inserted_lines) * MINIMAP_CELLS, map->cells + (last + 1) * MINIMAP_CELLS, (count - last - 1) * MINIMAP_CELLS);
+        if (new_count < count) {
+            arrlist_setcount(map->states, new_count);
+            arrlist_setcount(map->cells, new_count * MINIMAP_CELLS);
+        }
+    }
+    memset(map->states + first, LEX_LINE_START, inserted_lines);
+    memset(map->cells + first * MINIMAP_CELLS, 0, inserted_lines * MINIMAP_CELLS);
+    map->states[first + inserted_lines - 1] = carried;
+
+    if (map->dirty_begin != map->dirty_end) {
+        map->dirty_begin = minimap_shift_line(map->dirty_begin, first, last, inserted_lines, false);
+        map->dirty_end = minimap_shift_line(map->dirty_end, first, last, inserted_lines, true);
+    }
+    minimap_mark(map, first, first + inserted_lines);
+    map->version++;
+    PROFILE_END("minimap_on_edit");
+}
+
+void minimap_attach(Minimap* map, Text* txt, const HighlightLanguage* language) {
+    minimap_free(map);
+    map->txt = txt;
+    map->language = language;
+    isize lines = arrlist_count(txt->line_offsets) + 1;
+    arrlist_setcount(map->states, lines);
+    arrlist_setcount(map->cells, lines * MINIMAP_CELLS);
+    memset(map->states, LEX_LINE_START, lines);
+    memset(map->cells, 0, lines * MINIMAP_CELLS);
+    map->dirty_begin = 0;
+    map->dirty_end = lines;
+    text_add_listener(txt, (TextListener){minimap_on_edit, map});
+}
+
+void minimap_set_language(Minimap* map, const HighlightLanguage* language) {
+    minimap_cancel(map);
+    map->language = language;
+    map->dirty_begin = 0;
+    map->dirty_end = arrlist_count(map->states);
+}
+
+void minimap_free(Minimap* map) {
+    if (map->txt) text_remove_listener(map->txt, map);
+    minimap_cancel(map);
+    worker_stop(map->worker);
+    arrlist_free(map->cells);
+    arrlist_free(map->states);
+    *map = (Minimap){0};
+}
+
+bool minimap_poll(Minimap* map) {
+    if (map->txt == NULL) return true;
+    MinimapJob* job = map->job;
+    if (job) {
+        if (!atomic_load_explicit(&job->done, memory_order_acquire)) return false;
+        PROFILE_BEGIN("minimap_poll");
+        // an edit since the copy would have cancelled the job, so its lines are still where they were
+        memcpy(map->cells + job->first * MINIMAP_CELLS, job->cells, job->laid_out * MINIMAP_CELLS);
+        memcpy(map->states + job->first, job->states, job->laid_out);
+        map->dirty_begin = job->first + job->laid_out;
+        if (job->caught_up) {
+            map->dirty_begin = map->dirty_end;
+        } else if (map->dirty_begin >= map->dirty_end) {
+            // the line after starts in a different state than it did, it's out of date too
+            map->dirty_end = map->dirty_begin < arrlist_count(map->states) ? map->dirty_begin + 1 : map->dirty_begin;
+        }
+        map->version++;
+        minimap_job_release(job);
+        map->job = NULL;
+        PROFILE_END("minimap_poll");
+    }
+    if (map->dirty_begin < map->dirty_end) minimap_start_job(map);
+    return map->job == NULL;
+}
+
+isize minimap_lines(Minimap* map) {
+    return arrlist_count(map->states);
+}
+
+MinimapCell* minimap_row(Minimap* map, isize line) {
+    return map->cells + line * MINIMAP_CELLS;
+}
+
+isize minimap_top(Minimap* map, isize camera_row, isize rows) {
+    isize lines = minimap_lines(map);
+    if (lines <= rows) return 0;
+    if (camera_row < 0) camera_row = 0;
+    if (camera_row > lines - 1) camera_row = lines - 1;
+    return (i64)camera_row * (lines - rows) / (lines - 1);
+}
@@ -0,0 +1,61 @@
+#ifndef MINIMAP_H_
+#define MINIMAP_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "highlight.h"
+#include "thread.h"
+
+// the whole document at one pixel row per line, for a panel next to the text
+//
+// every line is summed up in MINIMAP_CELLS pixels of MINIMAP_CELL_COLS columns each: how many of
+// the columns aren't blank and the highlight kind most of those are. the rows are kept as the
+// cached image and an edit only marks its lines out of date. those are laid out again on a worker
+// thread from a copy of their bytes, lexing on past them only until a line ends in the state it
+// did before like the highlighter. one worker thread is kept for all of them, an edit only posts
+// it the next job. the frontend polls once a frame and turns the rows it shows into a texture, so
+// drawing costs the panel's height whatever the length of the file
+
+#define MINIMAP_CELLS 32
+#define MINIMAP_CELL_COLS 4
+#define MINIMAP_JOB_BYTES (1 << 20) // bytes of lines a worker lays out before it hands them back
+
+// kind << 4 | how many of the cell's columns aren't blank
+typedef u8 MinimapCell;
+#define MINIMAP_KIND(cell) ((cell) >> 4)
+#define MINIMAP_INK(cell) ((cell) & 0xf)
+
+typedef struct MinimapJob MinimapJob;
+
+typedef struct Minimap {
+    Text* txt;
+    const HighlightLanguage* language; // every cell is text without one
+    MinimapCell* cells; // arraylist, MINIMAP_CELLS for every line
+    LexState* states;   // arraylist, the state every line ends in
+    isize dirty_begin;  // lines from dirty_begin up to dirty_end are out of date
+    isize dirty_end;
+    MinimapJob* job;    // NULL when no job is running
+    Worker* worker;     // started with the first job
+    u64 version;        // counts changes to the rows, the frontend draws its texture again when it moves
+
+    // supplied by the frontend, called from the worker when a job is done and the next poll has rows for it
+    void (*wake)(void);
+} Minimap;
+
+// every line starts out of date, the first poll sets a worker on them
+void minimap_attach(Minimap* map, Text* txt, const HighlightLanguage* language);
+// every line is coloured again with the new language
+void minimap_set_language(Minimap* map, const HighlightLanguage* language);
+void minimap_free(Minimap* map);
+
+// takes the rows of a finished worker and starts the next one, returns true once every row is up to date
+bool minimap_poll(Minimap* map);
+
+isize minimap_lines(Minimap* map);
+// the MINIMAP_CELLS cells of the line
+MinimapCell* minimap_row(Minimap* map, isize line);
+// the first line on a panel rows tall. either every line fits or the panel scrolls in proportion
+// to the camera, so the line at camera_row is always on it and a pixel row is top + y
+isize minimap_top(Minimap* map, isize camera_row, isize rows);
+
+#endif //MINIMAP_H_
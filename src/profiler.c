@@ -0,0 +1,153 @@
+#include "profiler.h"
+
+#ifdef PROFILER
+#include "timer.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+typedef struct ProfilerThread {
+    ProfilerZone ring[PROFILER_RING_SIZE];
+    i64 written; // zones ever written, the newest is at (written - 1) % PROFILER_RING_SIZE
+
+    ProfilerZone stack[PROFILER_MAX_DEPTH];
+    i32 depth;
+
+    i64 frame_begin;
+    i64 last_frame_begin;
+    i32 id;
+    atomic_bool taken; // false once its thread exited, the next new thread records into it
+} ProfilerThread;
+
+// buffers are never freed so zones of threads which have exited still get written out. a new
+// thread carries on in the ring of one that exited, so short lived workers don't use up the slots
+static ProfilerThread* _Atomic profiler_threads[PROFILER_MAX_THREADS];
+static atomic_int profiler_thread_count;
+static _Thread_local ProfilerThread* profiler_thread;
+static _Thread_local bool profiler_dropped; // stays set so a zone is never begun and ended in different rings
+
+// NULL once PROFILER_MAX_THREADS threads are recording at the same time, the zones of any more are dropped
+static ProfilerThread* profiler_get_thread(void) {
+    if (profiler_thread || profiler_dropped) return profiler_thread;
+
+    int count = atomic_load(&profiler_thread_count);
+    for (int id = 0; id < count && id < PROFILER_MAX_THREADS; id++) {
+        ProfilerThread* thread = atomic_load(&profiler_threads[id]);
+        bool taken = false;
+        if (thread && atomic_compare_exchange_strong(&thread->taken, &taken, true)) {
+            thread->depth = 0;
+            profiler_thread = thread;
+            return thread;
+        }
+    }
+
+    int id = atomic_fetch_add(&profiler_thread_count, 1);
+    if (id >= PROFILER_MAX_THREADS) {
+        profiler_dropped = true;
+        return NULL;
+    }
+    ProfilerThread* thread = calloc(1, sizeof(ProfilerThread));
+    assert(thread && "calloc failed");
+    thread->id = id;
+    atomic_init(&thread->taken, true);
+    atomic_store(&profiler_threads[id], thread);
+    profiler_thread = thread;
+    return thread;
+}
+
+void profiler_thread_exit(void) {
+    profiler_dropped = false;
+    if (profiler_thread == NULL) return;
+    atomic_store(&profiler_thread->taken, false);
+    profiler_thread = NULL;
+}
+
+void profiler_begin(const char* name) {
+    ProfilerThread* thread = profiler_get_thread();
+    if (thread == NULL) return;
+    assert(thread->depth < PROFILER_MAX_DEPTH && "profiler zones nested too deep");
+
+    thread->stack[thread->depth] = (ProfilerZone) {
+        .name = name,
+        .depth = thread->depth,
+        .begin = timer_now_ns(),
+    };
+    thread->depth++;
+}
+void profiler_end(const char* name) {
+    i64 now = timer_now_ns();
+    ProfilerThread* thread = profiler_get_thread();
+    if (thread == NULL) return;
+    assert(thread->depth > 0 && "PROFILE_END without PROFILE_BEGIN");
+
+    thread->depth--;
+    ProfilerZone zone = thread->stack[thread->depth];
+    assert(strcmp(zone.name, name) == 0 && "PROFILE_END doesn't match the innermost PROFILE_BEGIN");
+    (void)name;
+
+    zone.end = now;
+    thread->ring[thread->written % PROFILER_RING_SIZE] = zone;
+    thread->written++;
+}
+
+void profiler_frame(void) {
+    ProfilerThread* thread = profiler_get_thread();
+    if (thread == NULL) return;
+    thread->last_frame_begin = thread->frame_begin;
+    thread->frame_begin = timer_now_ns();
+}
+isize profiler_last_frame(ProfilerZone* out, isize max, i64* frame_begin, i64* frame_end) {
+    ProfilerThread* thread = profiler_get_thread();
+    if (thread == NULL) {
+        *frame_begin = *frame_end = 0;
+        return 0;
+    }
+    *frame_begin = thread->last_frame_begin;
+    *frame_end = thread->frame_begin;
+
+    // walks back from the newest zone until it reaches zones from before the last frame
+    isize count = 0;
+    i64 oldest = thread->written > PROFILER_RING_SIZE ? thread->written - PROFILER_RING_SIZE : 0;
+    for (i64 i = thread->written - 1; i >= oldest && count < max; i--) {
+        ProfilerZone zone = thread->ring[i % PROFILER_RING_SIZE];
+        if (zone.end < thread->last_frame_begin) break;
+        if (zone.begin >= thread->last_frame_begin && zone.end <= thread->frame_begin) {
+            out[count++] = zone;
+        }
+    }
+    return count;
+}
+
+// call once the other profiled threads have finished, their buffers are read without locking
+void profiler_write_trace(const char* filename) {
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        perror("Couldn't Open File: ");
+        return;
+    }
+    fprintf(f, "{\"traceEvents\":[\n");
+    bool first = true;
+    int thread_count = atomic_load(&profiler_thread_count);
+    for (int t = 0; t < thread_count && t < PROFILER_MAX_THREADS; t++) {
+        ProfilerThread* thread = atomic_load(&profiler_threads[t]);
+        if (!thread) continue;
+
+        i64 oldest = thread->written > PROFILER_RING_SIZE ? thread->written - PROFILER_RING_SIZE : 0;
+        for (i64 i = oldest; i < thread->written; i++) {
+            ProfilerZone zone = thread->ring[i % PROFILER_RING_SIZE];
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n",
+                zone.name,
+                thread->id,
+                zone.begin / (f64)TIMER_NS_PER_US,
+                (zone.end - zone.begin) / (f64)TIMER_NS_PER_US
+            );
+            first = false;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+}
+#endif // PROFILER
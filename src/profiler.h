@@ -0,0 +1,53 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "short_types.h"
+
+// zone based profiler, build with -D PROFILER to enable it
+// without PROFILER the macros expand to nothing and profiler.c compiles to an empty object
+//
+// PROFILE_BEGIN("name");
+// ... timed code ...
+// PROFILE_END("name");
+//
+// zones nest, every thread records into its own ring buffer so only the newest
+// PROFILER_RING_SIZE zones of each thread are kept. a thread that exits hands its ring on to the
+// next thread that starts, past PROFILER_MAX_THREADS threads at once the rest aren't recorded
+
+#define PROFILER_RING_SIZE 0x10000
+#define PROFILER_MAX_DEPTH 64
+#define PROFILER_MAX_THREADS 64
+
+typedef struct ProfilerZone {
+    const char* name; // must be a string literal, only the pointer is stored
+    i64 begin;        // timer_now_ns
+    i64 end;
+    i32 depth;
+} ProfilerZone;
+
+#ifdef PROFILER
+#define PROFILE_BEGIN(name) profiler_begin(name)
+#define PROFILE_END(name) profiler_end(name)
+#define PROFILE_FRAME() profiler_frame()
+#define PROFILE_THREAD_EXIT() profiler_thread_exit()
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD_EXIT() ((void)0)
+#endif
+
+void profiler_begin(const char* name);
+void profiler_end(const char* name);
+
+// the calling thread is done recording, thread.c calls it when a thread's function returns
+void profiler_thread_exit(void);
+// marks the start of a new frame on the calling thread
+void profiler_frame(void);
+// copies the zones of the calling thread's last complete frame into out, returns how many were copied
+isize profiler_last_frame(ProfilerZone* out, isize max, i64* frame_begin, i64* frame_end);
+
+// writes every thread's ring buffer as chrome://tracing (trace_event) json
+void profiler_write_trace(const char* filename);
+
+#endif //PROFILER_H_
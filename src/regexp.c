@@ -0,0 +1,734 @@
+#include "regexp.h"
+#include "arraylist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Parsing
+
+typedef enum RegexNodeKind {
+    REGEX_NODE_EMPTY,
+    REGEX_NODE_CLASS,
+    REGEX_NODE_CONCAT,
+    REGEX_NODE_ALT,
+    REGEX_NODE_STAR,
+    REGEX_NODE_PLUS,
+    REGEX_NODE_QUEST,
+    REGEX_NODE_LINE_START,
+    REGEX_NODE_LINE_END,
+} RegexNodeKind;
+
+typedef struct RegexNode {
+    u8 kind;
+    i32 left, right; // children, or left is the class of a class node
+} RegexNode;
+
+typedef struct RegexParser {
+    String pattern;
+    isize index;
+    RegexNode* nodes; // arraylist
+    Regex* regex;
+    i32 depth;
+} RegexParser;
+
+#define REGEX_MAX_DEPTH 256
+
+static void class_set(RegexClass* class, u8 byte) {
+    class->bits[byte >> 3] |= 1 << (byte & 7);
+}
+static bool class_has(RegexClass* class, u8 byte) {
+    return class->bits[byte >> 3] & (1 << (byte & 7));
+}
+static void class_set_range(RegexClass* class, u8 lo, u8 hi) {
+    for (i32 c = lo; c <= hi; c++) class_set(class, c);
+}
+
+static i32 regex_node(RegexParser* parser, RegexNodeKind kind, i32 left, i32 right) {
+    arrlist_append(parser->nodes, ((RegexNode){.kind = kind, .left = left, .right = right}));
+    return arrlist_count(parser->nodes) - 1;
+}
+static i32 regex_class_node(RegexParser* parser, RegexClass class) {
+    arrlist_append(parser->regex->classes, class);
+    return regex_node(parser, REGEX_NODE_CLASS, arrlist_count(parser->regex->classes) - 1, -1);
+}
+
+static bool parser_done(RegexParser* parser) {
+    return parser->index >= parser->pattern.count;
+}
+static u8 parser_peek(RegexParser* parser) {
+    return parser->pattern.data[parser->index];
+}
+
+// \d \w \s and their negations, returns false if c isn't one of them
+static bool regex_shorthand(char c, RegexClass* class) {
+    RegexClass set = {0};
+    switch (c) {
+        case 'd': case 'D': class_set_range(&set, '0', '9'); break;
+        case 'w': case 'W': class_set_range(&set, '0', '9'); class_set_range(&set, 'a', 'z'); class_set_range(&set, 'A', 'Z'); class_set(&set, '_'); break;
+        case 's': case 'S': class_set(&set, ' '); class_set_range(&set, '\t', '\r'); break;
+        default: return false;
+    }
+    if (c >= 'A' && c <= 'Z') {
+        for (isize i = 0; i < 32; i++) set.bits[i] = ~set.bits[i];
+    }
+    for (isize i = 0; i < 32; i++) class->bits[i] |= set.bits[i];
+    return true;
+}
+
+static u8 regex_escape(char c) {
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case '0': return '\0';
+        default: return c;
+    }
+}
+
+// the text of a class after the [
+static bool parse_class(RegexParser* parser, RegexClass* class) {
+    bool negate = !parser_done(parser) && parser_peek(parser) == '^';
+    if (negate) parser->index++;
+
+    bool first = true;
+    while (!parser_done(parser) && (parser_peek(parser) != ']' || first)) {
+        first = false;
+        u8 lo = parser->pattern.data[parser->index++];
+        if (lo == '\\') {
+            if (parser_done(parser)) break;
+            char escaped = parser->pattern.data[parser->index++];
+            if (regex_shorthand(escaped, class)) continue;
+            lo = regex_escape(escaped);
+        }
+        u8 hi = lo;
+        if (parser->index + 1 < parser->pattern.count && parser_peek(parser) == '-' && parser->pattern.data[parser->index + 1] != ']') {
+            parser->index++;
+            hi = parser->pattern.data[parser->index++];
+            if (hi == '\\' && !parser_done(parser)) hi = regex_escape(parser->pattern.data[parser->index++]);
+            if (hi < lo) {
+                parser->regex->error = "class range is backwards";
+                return false;
+            }
+        }
+        class_set_range(class, lo, hi);
+    }
+    if (parser_done(parser)) {
+        parser->regex->error = "missing ]";
+        return false;
+    }
+    parser->index++;
+
+    if (negate) {
+        for (isize i = 0; i < 32; i++) class->bits[i] = ~class->bits[i];
+    }
+    return true;
+}
+
+static i32 parse_alt(RegexParser* parser);
+
+static i32 parse_atom(RegexParser* parser) {
+    u8 c = parser->pattern.data[parser->index++];
+    RegexClass class = {0};
+    switch (c) {
+        case '(': {
+            i32 inner = parse_alt(parser);
+            if (inner < 0) return -1;
+            if (parser_done(parser) || parser_peek(parser) != ')') {
+                parser->regex->error = "missing )";
+                return -1;
+            }
+            parser->index++;
+            return inner;
+        }
+        case '[': {
+            if (!parse_class(parser, &class)) return -1;
+            return regex_class_node(parser, class);
+        }
+        case '.': {
+            for (isize i = 0; i < 32; i++) class.bits[i] = 0xff;
+            class.bits['\n' >> 3] &= ~(1 << ('\n' & 7));
+            return regex_class_node(parser, class);
+        }
+        case '^': return regex_node(parser, REGEX_NODE_LINE_START, -1, -1);
+        case '$': return regex_node(parser, REGEX_NODE_LINE_END, -1, -1);
+        case '*': case '+': case '?': {
+            parser->regex->error = "nothing to repeat";
+            return -1;
+        }
+        case '\\': {
+            if (parser_done(parser)) {
+                parser->regex->error = "trailing \\";
+                return -1;
+            }
+            char escaped = parser->pattern.data[parser->index++];
+            if (!regex_shorthand(escaped, &class)) class_set(&class, regex_escape(escaped));
+            return regex_class_node(parser, class);
+        }
+        default: {
+            class_set(&class, c);
+            return regex_class_node(parser, class);
+        }
+    }
+}
+
+static i32 parse_repeat(RegexParser* parser) {
+    i32 node = parse_atom(parser);
+    while (node >= 0 && !parser_done(parser)) {
+        u8 c = parser_peek(parser);
+        if (c == '*') node = regex_node(parser, REGEX_NODE_STAR, node, -1);
+        else if (c == '+') node = regex_node(parser, REGEX_NODE_PLUS, node, -1);
+        else if (c == '?') node = regex_node(parser, REGEX_NODE_QUEST, node, -1);
+        else break;
+        parser->index++;
+    }
+    return node;
+}
+
+static i32 parse_concat(RegexParser* parser) {
+    i32 node = regex_node(parser, REGEX_NODE_EMPTY, -1, -1);
+    while (!parser_done(parser) && parser_peek(parser) != '|' && parser_peek(parser) != ')') {
+        i32 next = parse_repeat(parser);
+        if (next < 0) return -1;
+        node = regex_node(parser, REGEX_NODE_CONCAT, node, next);
+    }
+    return node;
+}
+
+static i32 parse_alt(RegexParser* parser) {
+    if (++parser->depth > REGEX_MAX_DEPTH) {
+        parser->regex->error = "too deeply nested";
+        return -1;
+    }
+    i32 node = parse_concat(parser);
+    while (node >= 0 && !parser_done(parser) && parser_peek(parser) == '|') {
+        parser->index++;
+        i32 right = parse_concat(parser);
+        if (right < 0) return -1;
+        node = regex_node(parser, REGEX_NODE_ALT, node, right);
+    }
+    parser->depth--;
+    return node;
+}
+
+// Nfa
+
+static i32 nfa_add(RegexDfa* dfa, RegexNfaKind kind, i32 class_id, i32 out, i32 out1) {
+    arrlist_append(dfa->nfa, ((RegexNfaState){.kind = kind, .class_id = class_id, .out = out, .out1 = out1}));
+    return arrlist_count(dfa->nfa) - 1;
+}
+
+// builds the states for node in front of out and returns the first one, reversed builds
+// the nfa of the reversed pattern where concatenations run backwards and ^ and $ swap
+static i32 nfa_compile(RegexDfa* dfa, RegexNode* nodes, i32 node, i32 out, bool reversed) {
+    RegexNode n = nodes[node];
+    switch (n.kind) {
+        case REGEX_NODE_EMPTY: return out;
+        case REGEX_NODE_CLASS: return nfa_add(dfa, REGEX_NFA_CLASS, n.left, out, -1);
+        case REGEX_NODE_CONCAT: {
+            if (reversed) return nfa_compile(dfa, nodes, n.right, nfa_compile(dfa, nodes, n.left, out, reversed), reversed);
+            return nfa_compile(dfa, nodes, n.left, nfa_compile(dfa, nodes, n.right, out, reversed), reversed);
+        }
+        case REGEX_NODE_ALT: {
+            i32 left = nfa_compile(dfa, nodes, n.left, out, reversed);
+            i32 right = nfa_compile(dfa, nodes, n.right, out, reversed);
+            return nfa_add(dfa, REGEX_NFA_SPLIT, -1, left, right);
+        }
+        case REGEX_NODE_STAR:
+        case REGEX_NODE_PLUS: {
+            i32 split = nfa_add(dfa, REGEX_NFA_SPLIT, -1, -1, out);
+            i32 body = nfa_compile(dfa, nodes, n.left, split, reversed);
+            dfa->nfa[split].out = body;
+            return n.kind == REGEX_NODE_STAR ? split : body;
+        }
+        case REGEX_NODE_QUEST: {
+            i32 body = nfa_compile(dfa, nodes, n.left, out, reversed);
+            return nfa_add(dfa, REGEX_NFA_SPLIT, -1, body, out);
+        }
+        case REGEX_NODE_LINE_START: return nfa_add(dfa, reversed ? REGEX_NFA_LINE_END : REGEX_NFA_LINE_START, -1, out, -1);
+        case REGEX_NODE_LINE_END: return nfa_add(dfa, reversed ? REGEX_NFA_LINE_START : REGEX_NFA_LINE_END, -1, out, -1);
+        default: assert(0 && "unknown regex node");
+    }
+    return out;
+}
+
+// Dfa
+
+enum {
+    DFA_LINE_START = 1 << 0, // the previous byte was \n, part of the key since it decides the closure
+    DFA_MATCHED    = 1 << 1, // a match was seen so no new matches may start, part of the key
+    DFA_MATCH      = 1 << 2, // a match ends here
+    DFA_MATCH_EOL  = 1 << 3, // a match ends here if the next byte is \n or the end
+    DFA_DEAD       = 1 << 4, // nothing can match from here
+};
+#define DFA_KEY_FLAGS (DFA_LINE_START | DFA_MATCHED)
+
+static void dfa_flush(RegexDfa* dfa) {
+    arrlist_setcount(dfa->sets, 0);
+    arrlist_setcount(dfa->states, 0);
+    arrlist_setcount(dfa->next, 0);
+    for (isize i = 0; i < dfa->table_cap; i++) dfa->table[i] = -1;
+    dfa->idle_state = -1;
+    dfa->flushes++;
+}
+
+static void dfa_init(RegexDfa* dfa) {
+    dfa->table_cap = REGEX_MAX_STATES * 2;
+    dfa->table = malloc(dfa->table_cap * sizeof(i32));
+    dfa->seen = calloc(arrlist_count(dfa->nfa), sizeof(u32));
+    dfa_flush(dfa);
+    dfa->flushes = 0;
+}
+
+static void dfa_free(RegexDfa* dfa) {
+    arrlist_free(dfa->nfa);
+    arrlist_free(dfa->sets);
+    arrlist_free(dfa->states);
+    arrlist_free(dfa->next);
+    arrlist_free(dfa->work);
+    arrlist_free(dfa->spare);
+    arrlist_free(dfa->stack);
+    free(dfa->table);
+    free(dfa->seen);
+    *dfa = (RegexDfa){0};
+}
+
+// adds everything reachable from state without consuming a byte to work, states already
+// seen this generation belong to an earlier group and are skipped, only states that wait
+// on something (a byte, the end of the line) or the match are kept
+static void dfa_closure(RegexDfa* dfa, i32 state, bool line_start, bool line_end) {
+    arrlist_append(dfa->stack, state);
+    while (arrlist_count(dfa->stack) > 0) {
+        i32 s = dfa->stack[--arrlist_header(dfa->stack)->count];
+        if (dfa->seen[s] == dfa->generation) continue;
+        dfa->seen[s] = dfa->generation;
+
+        RegexNfaState nfa = dfa->nfa[s];
+        switch (nfa.kind) {
+            case REGEX_NFA_SPLIT: {
+                arrlist_append(dfa->stack, nfa.out1);
+                arrlist_append(dfa->stack, nfa.out);
+            } break;
+            case REGEX_NFA_LINE_START: {
+                if (line_start) arrlist_append(dfa->stack, nfa.out);
+            } break;
+            case REGEX_NFA_LINE_END: {
+                if (line_end) arrlist_append(dfa->stack, nfa.out);
+                else arrlist_append(dfa->work, s);
+            } break;
+            default: {
+                arrlist_append(dfa->work, s);
+            } break;
+        }
+    }
+}
+
+static int compare_i32(const void* a, const void* b) {
+    return *(const i32*)a - *(const i32*)b;
+}
+
+// sorts the group that starts at begin so equal sets get equal keys, drops it if it's empty
+static void dfa_end_group(RegexDfa* dfa, isize begin) {
+    isize count = arrlist_count(dfa->work) - begin;
+    if (count == 0) return;
+    qsort(dfa->work + begin, count, sizeof(i32), compare_i32);
+    arrlist_append(dfa->work, -1);
+}
+
+static u32 dfa_hash(i32* set, isize count, u8 flags) {
+    u32 hash = 2166136261u ^ flags;
+    for (isize i = 0; i < count; i++) {
+        hash = (hash ^ (u32)set[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// whether the groups in set reach the match, optionally treating the position as a line end
+static bool dfa_set_matches(RegexDfa* dfa, i32* set, isize count, bool line_start, bool line_end) {
+    for (isize i = 0; i < count; i++) {
+        if (set[i] < 0) continue;
+        RegexNfaKind kind = dfa->nfa[set[i]].kind;
+        if (kind == REGEX_NFA_MATCH) return true;
+        if (kind == REGEX_NFA_LINE_END && line_end) {
+            isize work = arrlist_count(dfa->work);
+            dfa->generation++;
+            dfa_closure(dfa, dfa->nfa[set[i]].out, line_start, true);
+            bool found = false;
+            for (isize j = work; j < arrlist_count(dfa->work); j++) {
+                if (dfa->nfa[dfa->work[j]].kind == REGEX_NFA_MATCH) found = true;
+            }
+            arrlist_setcount(dfa->work, work);
+            if (found) return true;
+        }
+    }
+    return false;
+}
+
+// returns the state for the set held in work, adding it (and flushing the cache if it's full)
+static i32 dfa_intern(RegexDfa* dfa, i32 class_count, u8 flags) {
+    isize count = arrlist_count(dfa->work);
+    u32 hash = dfa_hash(dfa->work, count, flags);
+
+    isize mask = dfa->table_cap - 1;
+    for (isize i = hash & mask; dfa->table[i] >= 0; i = (i + 1) & mask) {
+        RegexDfaState* state = &dfa->states[dfa->table[i]];
+        if (state->hash == hash && state->count == count && (state->flags & DFA_KEY_FLAGS) == flags
+            && memcmp(dfa->sets + state->offset, dfa->work, count * sizeof(i32)) == 0) {
+            return dfa->table[i];
+        }
+    }
+
+    if (arrlist_count(dfa->states) >= REGEX_MAX_STATES || arrlist_count(dfa->sets) + count > REGEX_MAX_SET_POOL) {
+        dfa_flush(dfa);
+    }
+
+    RegexDfaState state = {.offset = arrlist_count(dfa->sets), .count = count, .hash = hash, .flags = flags};
+    for (isize i = 0; i < count; i++) arrlist_append(dfa->sets, dfa->work[i]);
+
+    // checking for the match uses work as scratch so it reads the copy
+    i32* set = dfa->sets + state.offset;
+    // an unanchored search that hasn't matched yet can always start a new match at the next byte
+    if (count == 0 && (dfa->anchored || (flags & DFA_MATCHED))) state.flags |= DFA_DEAD;
+    if (dfa_set_matches(dfa, set, count, flags & DFA_LINE_START, false)) state.flags |= DFA_MATCH;
+    if (dfa_set_matches(dfa, set, count, flags & DFA_LINE_START, true)) state.flags |= DFA_MATCH_EOL;
+
+    arrlist_append(dfa->states, state);
+    for (isize i = 0; i < class_count; i++) arrlist_append(dfa->next, -1);
+
+    i32 index = arrlist_count(dfa->states) - 1;
+    isize slot = hash & mask;
+    while (dfa->table[slot] >= 0) slot = (slot + 1) & mask;
+    dfa->table[slot] = index;
+    return index;
+}
+
+// transitions hold the offset of the target's row in next so the scan loops don't multiply,
+// states that match or are dead are tagged so the loops only look at flags when they have to
+#define DFA_SPECIAL (1 << 30)
+static i32 dfa_entry(RegexDfa* dfa, i32 class_count, i32 state) {
+    bool special = dfa->states[state].flags & (DFA_MATCH | DFA_MATCH_EOL | DFA_DEAD);
+    return state * class_count | (special ? DFA_SPECIAL : 0);
+}
+
+static i32 dfa_start_state(Regex* regex, RegexDfa* dfa, bool line_start) {
+    arrlist_setcount(dfa->work, 0);
+    dfa->generation++;
+    dfa_closure(dfa, dfa->start, line_start, false);
+    dfa_end_group(dfa, 0);
+    return dfa_intern(dfa, regex->class_count, line_start ? DFA_LINE_START : 0);
+}
+
+// builds the transition out of from on byte and caches it unless the cache got flushed on the way
+static i32 dfa_step(Regex* regex, RegexDfa* dfa, i32 from, u8 byte) {
+    RegexDfaState state = dfa->states[from];
+    bool newline = byte == '\n';
+    bool matched = state.flags & DFA_MATCHED;
+
+    // the source set with the line end assertions passed if this byte ends the line, groups
+    // after the first one that matches started later so they can't be the leftmost match
+    arrlist_setcount(dfa->work, 0);
+    dfa->generation++;
+    isize group_begin = 0;
+    for (isize i = 0; i < state.count; i++) {
+        i32 s = dfa->sets[state.offset + i];
+        if (s >= 0) {
+            dfa_closure(dfa, s, state.flags & DFA_LINE_START, newline);
+            continue;
+        }
+        bool group_matches = false;
+        for (isize j = group_begin; j < arrlist_count(dfa->work); j++) {
+            if (dfa->nfa[dfa->work[j]].kind == REGEX_NFA_MATCH) group_matches = true;
+        }
+        dfa_end_group(dfa, group_begin);
+        group_begin = arrlist_count(dfa->work);
+        if (group_matches) {
+            matched = true;
+            break;
+        }
+    }
+
+    // the expanded set moves to spare so the stepped set can be built in work
+    i32* expanded = dfa->work;
+    dfa->work = dfa->spare;
+    dfa->spare = expanded;
+    arrlist_setcount(dfa->work, 0);
+
+    dfa->generation++;
+    group_begin = 0;
+    for (isize i = 0; i < arrlist_count(expanded); i++) {
+        i32 s = expanded[i];
+        if (s < 0) {
+            dfa_end_group(dfa, group_begin);
+            group_begin = arrlist_count(dfa->work);
+            continue;
+        }
+        RegexNfaState nfa = dfa->nfa[s];
+        if (nfa.kind == REGEX_NFA_CLASS && class_has(&regex->classes[nfa.class_id], byte)) {
+            dfa_closure(dfa, nfa.out, newline, false);
+        }
+    }
+
+    // a match could still start at the next byte
+    if (!dfa->anchored && !matched) {
+        group_begin = arrlist_count(dfa->work);
+        dfa_closure(dfa, dfa->start, newline, false);
+        dfa_end_group(dfa, group_begin);
+    }
+
+    isize flushes = dfa->flushes;
+    i32 to = dfa_intern(dfa, regex->class_count, (newline ? DFA_LINE_START : 0) | (matched ? DFA_MATCHED : 0));
+    if (dfa->flushes == flushes) {
+        dfa->next[from * regex->class_count + regex->byte_class[byte]] = dfa_entry(dfa, regex->class_count, to);
+    }
+    return to;
+}
+
+// Compiling
+
+// splits the 256 byte values into the fewest groups no class (and no line assertion) tells apart
+static void regex_build_byte_classes(Regex* regex) {
+    u8 ids[256] = {0};
+    i32 count = 1;
+
+    RegexClass newline = {0};
+    class_set(&newline, '\n');
+    for (isize c = -1; c < arrlist_count(regex->classes); c++) {
+        RegexClass* class = c < 0 ? &newline : &regex->classes[c];
+        i32 split[512];
+        for (isize i = 0; i < 512; i++) split[i] = -1;
+        i32 next = 0;
+        for (isize b = 0; b < 256; b++) {
+            isize key = ids[b] * 2 + class_has(class, b);
+            if (split[key] < 0) split[key] = next++;
+            ids[b] = split[key];
+        }
+        count = next;
+    }
+    memcpy(regex->byte_class, ids, sizeof(ids));
+    regex->class_count = count;
+}
+
+bool regex_compile(Regex* regex, String pattern) {
+    *regex = (Regex){0};
+    RegexParser parser = {.pattern = pattern, .regex = regex};
+
+    i32 root = parse_alt(&parser);
+    if (root >= 0 && !parser_done(&parser)) {
+        regex->error = "unmatched )";
+        root = -1;
+    }
+    if (root < 0) {
+        arrlist_free(parser.nodes);
+        arrlist_free(regex->classes);
+        return false;
+    }
+
+    regex_build_byte_classes(regex);
+
+    RegexDfa* dfas[2] = {&regex->forward, &regex->reverse};
+    for (isize i = 0; i < 2; i++) {
+        RegexDfa* dfa = dfas[i];
+        i32 match = nfa_add(dfa, REGEX_NFA_MATCH, -1, -1, -1);
+        dfa->start = nfa_compile(dfa, parser.nodes, root, match, i == 1);
+        dfa->anchored = i == 1;
+        dfa_init(dfa);
+    }
+    arrlist_free(parser.nodes);
+    return true;
+}
+
+void regex_free(Regex* regex) {
+    dfa_free(&regex->forward);
+    dfa_free(&regex->reverse);
+    arrlist_free(regex->classes);
+    *regex = (Regex){0};
+}
+
+// Searching
+
+static u8 regex_byte(GapBufSlice strings, isize index) {
+    return index < strings.l.count ? strings.l.data[index] : strings.r.data[index - strings.l.count];
+}
+
+// finds the bytes that take the idle state somewhere else, every transition out of it gets built
+static void dfa_find_accel(Regex* regex, RegexDfa* dfa) {
+    isize flushes = dfa->flushes;
+    i32 idle = dfa_start_state(regex, dfa, false);
+    dfa->idle_state = idle;
+    dfa->accel_count = 0;
+    if (dfa->anchored || (dfa->states[idle].flags & (DFA_MATCH | DFA_MATCH_EOL | DFA_DEAD))) return;
+
+    i32 count = 0;
+    u8 accel[4];
+    for (i32 byte = 0; byte < 256 && count <= 3; byte++) {
+        i32 next = dfa->next[idle * regex->class_count + regex->byte_class[byte]];
+        i32 to = next >= 0 ? (next & ~DFA_SPECIAL) / regex->class_count : dfa_step(regex, dfa, idle, byte);
+        if (dfa->flushes != flushes) return;
+        if (to != idle) accel[count++] = byte;
+    }
+    if (count <= 3) {
+        memcpy(dfa->accel, accel, count);
+        dfa->accel_count = count;
+    }
+}
+
+// index of the first of the accel bytes at or after i, count if there is none
+static isize dfa_skip(RegexDfa* dfa, const u8* data, isize i, isize count) {
+    if (dfa->accel_count == 1) {
+        const u8* found = memchr(data + i, dfa->accel[0], count - i);
+        return found ? found - data : count;
+    }
+    u8 a = dfa->accel[0], b = dfa->accel[1], c = dfa->accel[dfa->accel_count - 1];
+    #ifdef __SSE2__
+    __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    for (; i + 16 <= count; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)), _mm_cmpeq_epi8(block, vc));
+        u32 mask = _mm_movemask_epi8(hits);
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    #endif
+    for (; i < count; i++) {
+        if (data[i] == a || data[i] == b || data[i] == c) return i;
+    }
+    return count;
+}
+
+// runs the forward dfa over the text from scan->at up to stop. the scan settles once the dfa dies or
+// reaches the end of the text, scan->last is then the end of the leftmost longest match, -1 without one
+static void regex_scan_forward(Regex* regex, GapBufSlice strings, RegexScan* scan, isize stop) {
+    RegexDfa* dfa = &regex->forward;
+    i32 class_count = regex->class_count;
+    isize count = strings.l.count + strings.r.count;
+    if (scan->entry < 0) {
+        // a scan carried on from an earlier stop holds a state of the cache, finding the idle state
+        // could flush it so that's only done when a scan starts
+        bool line_start = scan->start == 0 || regex_byte(strings, scan->start - 1) == '\n';
+        if (dfa->idle_state < 0) dfa_find_accel(regex, dfa);
+        scan->entry = dfa_entry(dfa, class_count, dfa_start_state(regex, dfa, line_start));
+    }
+    i32 entry = scan->entry;
+    i32 idle_entry = -1;
+    if (dfa->idle_state >= 0 && dfa->accel_count > 0) idle_entry = dfa_entry(dfa, class_count, dfa->idle_state);
+    isize last = scan->last;
+    isize end = stop < count ? stop : count;
+    if (end < scan->at) end = scan->at;
+
+    // the two halves are scanned one after the other, position is the index in the text
+    String halves[2] = {strings.l, strings.r};
+    isize base = 0;
+    for (isize h = 0; h < 2; base += halves[h].count, h++) {
+        const u8* data = (const u8*)halves[h].data;
+        isize begin = scan->at > base ? scan->at - base : 0;
+        isize half_end = end - base < halves[h].count ? end - base : halves[h].count;
+        for (isize i = begin; i < half_end; i++) {
+            if (entry == idle_entry) {
+                i = dfa_skip(dfa, data, i, half_end);
+                if (i == half_end) break;
+            }
+            u8 byte = data[i];
+            i32 row = entry & ~DFA_SPECIAL;
+            if (entry & DFA_SPECIAL) {
+                u8 flags = dfa->states[row / class_count].flags;
+                if ((flags & DFA_MATCH) || ((flags & DFA_MATCH_EOL) && byte == '\n')) last = base + i;
+                if (flags & DFA_DEAD) {
+                    scan->last = last;
+                    scan->settled = true;
+                    return;
+                }
+            }
+            entry = dfa->next[row + regex->byte_class[byte]];
+            if (entry < 0) {
+                isize flushes = dfa->flushes;
+                entry = dfa_entry(dfa, class_count, dfa_step(regex, dfa, row / class_count, byte));
+                if (dfa->flushes != flushes) idle_entry = -1; // the idle state isn't in the new cache
+            }
+        }
+    }
+    scan->entry = entry;
+    scan->last = last;
+    scan->at = end;
+    if (end == count) {
+        if (dfa->states[(entry & ~DFA_SPECIAL) / class_count].flags & (DFA_MATCH | DFA_MATCH_EOL)) scan->last = count;
+        scan->settled = true;
+    }
+}
+
+// runs the reverse dfa backwards from end and returns where the longest match that ends there starts
+static isize regex_scan_reverse(Regex* regex, GapBufSlice strings, isize end, isize limit) {
+    RegexDfa* dfa = &regex->reverse;
+    i32 class_count = regex->class_count;
+    isize count = strings.l.count + strings.r.count;
+    bool line_start = end == count || regex_byte(strings, end) == '\n';
+    i32 state = dfa_start_state(regex, dfa, line_start);
+    isize last = -1;
+
+    for (isize p = end; ; p--) {
+        u8 byte = p > 0 ? regex_byte(strings, p - 1) : 0;
+        u8 flags = dfa->states[state].flags;
+        if ((flags & DFA_MATCH) || ((flags & DFA_MATCH_EOL) && (p == 0 || byte == '\n'))) last = p;
+        if (p <= limit || (flags & DFA_DEAD)) break;
+
+        i32 next = dfa->next[state * class_count + regex->byte_class[byte]];
+        state = next >= 0 ? (next & ~DFA_SPECIAL) / class_count : dfa_step(regex, dfa, state, byte);
+    }
+    return last;
+}
+
+void regex_scan_begin(RegexScan* scan, isize start) {
+    *scan = (RegexScan){.start = start > 0 ? start : 0, .at = start > 0 ? start : 0, .last = -1, .entry = -1};
+}
+
+bool regex_scan(Regex* regex, GapBuffer* gapbuf, RegexScan* scan, isize stop, RegexMatch* match) {
+    GapBufSlice strings = gapbuf_getstrings(gapbuf);
+    isize count = strings.l.count + strings.r.count;
+    if (scan->start > count) scan->settled = true;
+    if (!scan->settled) regex_scan_forward(regex, strings, scan, stop);
+    if (!scan->settled || scan->last < 0) return false;
+
+    isize begin = regex_scan_reverse(regex, strings, scan->last, scan->start);
+    assert(begin >= scan->start && "the reverse scan should find the match the forward scan saw");
+    *match = (RegexMatch){.begin = begin, .end = scan->last};
+    return true;
+}
+
+bool regex_find(Regex* regex, GapBuffer* gapbuf, isize start, RegexMatch* match) {
+    RegexScan scan;
+    regex_scan_begin(&scan, start);
+    return regex_scan(regex, gapbuf, &scan, gapbuf_count(gapbuf), match);
+}
+
+isize regex_find_all(Regex* regex, GapBuffer* gapbuf, RegexMatch** matches) {
+    isize added = 0;
+    RegexMatch match;
+    for (isize start = 0; regex_find(regex, gapbuf, start, &match); added++) {
+        arrlist_append(*matches, match);
+        // an empty match would be found again at the same place
+        start = match.end > match.begin ? match.end : match.end + 1;
+    }
+    return added;
+}
+
+isize regex_count(Regex* regex, GapBuffer* gapbuf) {
+    isize count = 0;
+    RegexMatch match;
+    for (isize start = 0; regex_find(regex, gapbuf, start, &match); count++) {
+        start = match.end > match.begin ? match.end : match.end + 1;
+    }
+    return count;
+}
+
+// there's no backwards search from a position so this walks the matches before end, only
+// stepping to the previous match uses it
+bool regex_find_prev(Regex* regex, GapBuffer* gapbuf, isize end, RegexMatch* match) {
+    bool found = false;
+    RegexMatch next;
+    for (isize start = 0; regex_find(regex, gapbuf, start, &next) && next.begin < end;) {
+        *match = next;
+        found = true;
+        start = next.end > next.begin ? next.end : next.end + 1;
+    }
+    return found;
+}
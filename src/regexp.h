@@ -0,0 +1,113 @@
+#ifndef REGEXP_H_
+#define REGEXP_H_
+
+#include "short_types.h"
+#include "gapbuffer.h"
+
+// regular expressions matched by a lazily built dfa, so searching is linear in the text
+// and never backtracks. the syntax works on bytes:
+//
+//   abc  literals        .  any byte but \n     [a-z] [^"\n]  classes
+//   a|b  alternation     () grouping            * + ?  repetition
+//   ^ $  line start/end  \d \w \s \D \W \S      \n \t \. \\ etc escapes
+//
+// matches are leftmost longest, the text is read straight from the two halves of the gap buffer
+
+#define REGEX_MAX_STATES 4096      // cached dfa states before the cache is flushed, a power of two
+#define REGEX_MAX_SET_POOL 0x40000 // nfa state ids held by all cached dfa states
+
+typedef enum RegexNfaKind {
+    REGEX_NFA_CLASS,      // consumes one byte in the class
+    REGEX_NFA_SPLIT,      // follows out and out1 without consuming anything
+    REGEX_NFA_LINE_START, // only passes if the previous byte was \n or the start of the text
+    REGEX_NFA_LINE_END,   // only passes if the next byte is \n or the end of the text
+    REGEX_NFA_MATCH,
+} RegexNfaKind;
+
+typedef struct RegexNfaState {
+    u8 kind;
+    i32 class_id;
+    i32 out, out1;
+} RegexNfaState;
+
+typedef struct RegexClass {
+    u8 bits[32];
+} RegexClass;
+
+typedef struct RegexDfaState {
+    i32 offset; // into sets, groups of nfa states separated by -1 ordered by where their match started
+    i32 count;
+    u32 hash;
+    u8 flags;
+} RegexDfaState;
+
+// states are only built when the search reaches them, all of it is thrown away when it gets too big
+typedef struct RegexDfa {
+    RegexNfaState* nfa; // arraylist
+    i32 start;
+    bool anchored; // only matches starting where the scan starts, otherwise a new match may start at every byte
+
+    i32* sets;              // arraylist
+    RegexDfaState* states;  // arraylist
+    i32* next;              // arraylist, states * class_count transitions, -1 if not built yet
+    i32* table;             // open addressing from set to state
+    isize table_cap;
+    isize flushes;
+
+    // the state an unanchored search idles in between possible matches, the bytes that leave it
+    // are few for most patterns so the scan can skip straight to the next one
+    i32 idle_state;     // -1 if it isn't known for the current cache
+    i32 accel_count;    // 0 if too many bytes leave the idle state
+    u8 accel[3];
+
+    // scratch space for building states
+    i32* work;
+    i32* spare;
+    i32* stack;
+    u32* seen;
+    u32 generation;
+} RegexDfa;
+
+typedef struct Regex {
+    RegexClass* classes; // arraylist
+    u8 byte_class[256];  // bytes that no pattern class tells apart share a column in the transition table
+    i32 class_count;
+
+    RegexDfa forward; // finds where the leftmost longest match ends
+    RegexDfa reverse; // reads backwards from there to find where it starts
+
+    const char* error; // set when compiling fails
+} Regex;
+
+typedef struct RegexMatch {
+    isize begin;
+    isize end;
+} RegexMatch;
+
+// the search for one match, read a slice of the text at a time so a long scan can be stopped in
+// between. the regex mustn't search anything else until the scan has settled, the state it's
+// carried on from is in the regex's cache
+typedef struct RegexScan {
+    isize start;  // the match starts at or after it
+    isize at;     // the text before it has been read
+    isize last;   // end of the leftmost longest match read so far, -1 without one
+    i32 entry;    // the forward dfa's state at at, -1 before the scan has read anything
+    bool settled; // the match is known, or that there's none
+} RegexScan;
+
+bool regex_compile(Regex* regex, String pattern);
+void regex_free(Regex* regex);
+
+// first match starting at or after start
+bool regex_find(Regex* regex, GapBuffer* gapbuf, isize start, RegexMatch* match);
+void regex_scan_begin(RegexScan* scan, isize start);
+// reads on from scan->at, up to stop at most. true with the match once it's settled on one, false
+// when there's none or when it got to stop first and scan->settled isn't set yet
+bool regex_scan(Regex* regex, GapBuffer* gapbuf, RegexScan* scan, isize stop, RegexMatch* match);
+// last match starting before end
+bool regex_find_prev(Regex* regex, GapBuffer* gapbuf, isize end, RegexMatch* match);
+// appends every match (empty ones included) to the matches arraylist, returns how many were added
+isize regex_find_all(Regex* regex, GapBuffer* gapbuf, RegexMatch** matches);
+isize regex_count(Regex* regex, GapBuffer* gapbuf);
+
+#endif //REGEXP_H_
@@ -0,0 +1,109 @@
+#include "search.h"
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+bool search_match_at(GapBuffer* gapbuf, String needle, isize index) {
+    GapBufSlice strings = gapbuf_getstrings(gapbuf);
+    if (index < 0 || index + needle.count > strings.l.count + strings.r.count) return false;
+
+    isize in_left = strings.l.count - index;
+    if (in_left <= 0) return memcmp(strings.r.data - in_left, needle.data, needle.count) == 0;
+    if (in_left >= needle.count) return memcmp(strings.l.data + index, needle.data, needle.count) == 0;
+
+    return memcmp(strings.l.data + index, needle.data, in_left) == 0
+        && memcmp(strings.r.data, needle.data + in_left, needle.count - in_left) == 0;
+}
+
+// compares the first and last byte of the needle against 16 positions at a time and only
+// checks the bytes in between where both matched, text rarely has many of those so most
+// of the buffer is skipped 16 bytes per step
+isize search_bytes(const char* data, isize count, String needle) {
+    isize n = needle.count;
+    if (n == 0) return 0;
+    if (n > count) return -1;
+    if (n == 1) {
+        const char* found = memchr(data, needle.data[0], count);
+        return found ? found - data : -1;
+    }
+
+    isize i = 0;
+    #ifdef __SSE2__
+    __m128i first = _mm_set1_epi8(needle.data[0]);
+    __m128i last = _mm_set1_epi8(needle.data[n - 1]);
+    for (; i + n - 1 + 32 <= count; i += 32) {
+        __m128i first0 = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i*)(data + i)));
+        __m128i first1 = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i*)(data + i + 16)));
+        __m128i last0 = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i*)(data + i + n - 1)));
+        __m128i last1 = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i*)(data + i + n - 1 + 16)));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(first0, last0))
+                 | (u32)_mm_movemask_epi8(_mm_and_si128(first1, last1)) << 16;
+
+        while (mask != 0) {
+            isize candidate = i + __builtin_ctz(mask);
+            if (memcmp(data + candidate + 1, needle.data + 1, n - 2) == 0) return candidate;
+            mask &= mask - 1;
+        }
+    }
+    #endif
+
+    for (; i + n <= count; i++) {
+        if (data[i] == needle.data[0] && data[i + n - 1] == needle.data[n - 1]
+            && memcmp(data + i + 1, needle.data + 1, n - 2) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+isize search_find(GapBuffer* gapbuf, String needle, isize start) {
+    return search_find_before(gapbuf, needle, start, gapbuf_count(gapbuf));
+}
+
+isize search_find_before(GapBuffer* gapbuf, String needle, isize start, isize limit) {
+    GapBufSlice strings = gapbuf_getstrings(gapbuf);
+    if (start < 0) start = 0;
+    if (needle.count == 0 || start >= limit) return -1;
+    // bytes up to here are read, a match starting just before limit ends there
+    isize read_end = limit + needle.count - 1;
+
+    // entirely in the left half
+    if (start < strings.l.count) {
+        isize end = read_end < strings.l.count ? read_end : strings.l.count;
+        isize found = search_bytes(strings.l.data + start, end - start, needle);
+        if (found >= 0) return start + found;
+    }
+
+    // the needle.count - 1 positions where a match would straddle the gap
+    isize straddle = strings.l.count - needle.count + 1;
+    if (straddle < start) straddle = start;
+    isize straddle_end = strings.l.count < limit ? strings.l.count : limit;
+    for (isize i = straddle; i < straddle_end; i++) {
+        if (search_match_at(gapbuf, needle, i)) return i;
+    }
+
+    // entirely in the right half
+    isize right_start = start > strings.l.count ? start - strings.l.count : 0;
+    isize right_end = read_end - strings.l.count < strings.r.count ? read_end - strings.l.count : strings.r.count;
+    if (right_start < right_end) {
+        isize found = search_bytes(strings.r.data + right_start, right_end - right_start, needle);
+        if (found >= 0) return strings.l.count + right_start + found;
+    }
+    return -1;
+}
+
+// searching backwards is only used to step to the previous match so it stays a simple byte loop
+isize search_find_prev(GapBuffer* gapbuf, String needle, isize end) {
+    if (needle.count == 0) return -1;
+    isize count = gapbuf_count(gapbuf);
+    if (end > count - needle.count + 1) end = count - needle.count + 1;
+
+    GapBufSlice strings = gapbuf_getstrings(gapbuf);
+    for (isize i = end - 1; i >= 0; i--) {
+        char c = i < strings.l.count ? strings.l.data[i] : strings.r.data[i - strings.l.count];
+        if (c == needle.data[0] && search_match_at(gapbuf, needle, i)) return i;
+    }
+    return -1;
+}
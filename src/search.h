@@ -0,0 +1,23 @@
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include "short_types.h"
+#include "gapbuffer.h"
+
+// plain substring search over the gap buffer, both halves are searched in place and
+// matches that straddle the gap are found without copying anything
+
+// compares needle against the buffer at index, reading across the gap if it has to
+bool search_match_at(GapBuffer* gapbuf, String needle, isize index);
+
+// index of the first occurrence of needle in data, -1 if there is none
+isize search_bytes(const char* data, isize count, String needle);
+
+// index of the first match starting at or after start, -1 if there is none
+isize search_find(GapBuffer* gapbuf, String needle, isize start);
+// same as search_find but only matches starting before limit, nothing past limit + needle.count - 1 is read
+isize search_find_before(GapBuffer* gapbuf, String needle, isize start, isize limit);
+// index of the last match starting before end, -1 if there is none
+isize search_find_prev(GapBuffer* gapbuf, String needle, isize end);
+
+#endif //SEARCH_H_
@@ -0,0 +1,295 @@
+#include "searcher.h"
+#include "regexp.h"
+#include "thread.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+struct SearchSnapshot {
+    atomic_int refs;
+    u64 version;          // of the text it was copied from
+    GapBuffer gapbuf;     // the gap is at the end so the search functions read it as one block
+    atomic_llong copied;  // bytes of the text copied so far, only the frontend writes it
+};
+
+// owned by the searcher and, while it's posted, the worker. whichever lets go last frees it
+struct SearchJob {
+    atomic_int refs;
+    atomic_bool cancelled;
+    atomic_bool done;
+    atomic_bool waiting; // not posted, the worker caught up with the copy or it was never handed over
+
+    SearchSnapshot* snapshot;
+    StringBuilder query;
+    bool regex;
+    void (*wake)(void);
+
+    // how far the search got, only read and written by the job's runs
+    isize searched; // plain text matches starting before it are found
+    isize slice;    // bytes searched before the next batch is handed over
+    Regex compiled; // the worker's own, the dfa cache is written while searching so it can't be shared
+    RegexScan scan;
+
+    // with no worker thread the job runs in the polls that copy the text, and batches are gathered
+    // here instead of waiting for room in the queue that same thread would have to drain
+    bool inline_run;
+    MatchRange* gathered; // arraylist
+
+    // single producer single consumer ring of MatchRange arraylists, head and tail only grow
+    MatchRange* queue[SEARCHER_QUEUE_SIZE];
+    atomic_llong head; // written by the frontend
+    atomic_llong tail; // written by the worker
+};
+
+static void snapshot_release(SearchSnapshot* snapshot) {
+    if (snapshot && atomic_fetch_sub(&snapshot->refs, 1) == 1) {
+        gapbuf_free(&snapshot->gapbuf);
+        free(snapshot);
+    }
+}
+
+static SearchSnapshot* snapshot_make(Text* txt) {
+    SearchSnapshot* snapshot = calloc(1, sizeof(SearchSnapshot));
+    assert(snapshot && "calloc failed");
+    atomic_init(&snapshot->refs, 1);
+    atomic_init(&snapshot->copied, 0);
+    snapshot->version = txt->version;
+    isize count = gapbuf_count(&txt->gapbuf);
+    snapshot->gapbuf = gapbuf_with_cap(count);
+    assert((snapshot->gapbuf.data || count == 0) && "malloc failed");
+    snapshot->gapbuf.gap_begin = count;
+    return snapshot;
+}
+
+// copies the next SEARCHER_COPY_SLICE bytes, only SEARCHER_FIRST_SLICE the first time so a search
+// starts without a stall. the worker may be reading the bytes before them meanwhile, it only goes
+// as far as copied said when it looked
+static void snapshot_copy(SearchSnapshot* snapshot, Text* txt) {
+    isize count = snapshot->gapbuf.gap_begin;
+    isize copied = atomic_load_explicit(&snapshot->copied, memory_order_relaxed);
+    if (copied == count) return;
+    PROFILE_BEGIN("snapshot_copy");
+    isize slice = copied == 0 ? SEARCHER_FIRST_SLICE : SEARCHER_COPY_SLICE;
+    isize end = count - copied > slice ? copied + slice : count;
+    GapBufSlice strings = gapbuf_slice(&txt->gapbuf, copied, end);
+    if (strings.l.count > 0) memcpy(snapshot->gapbuf.data + copied, strings.l.data, strings.l.count);
+    if (strings.r.count > 0) memcpy(snapshot->gapbuf.data + copied + strings.l.count, strings.r.data, strings.r.count);
+    atomic_store_explicit(&snapshot->copied, end, memory_order_release);
+    PROFILE_END("snapshot_copy");
+}
+
+static void job_release(void* arg) {
+    SearchJob* job = arg;
+    if (atomic_fetch_sub(&job->refs, 1) != 1) return;
+    for (i64 i = atomic_load(&job->head); i < atomic_load(&job->tail); i++) {
+        arrlist_free(job->queue[i & (SEARCHER_QUEUE_SIZE - 1)]);
+    }
+    snapshot_release(job->snapshot);
+    string_free(&job->query);
+    if (job->regex) regex_free(&job->compiled);
+    arrlist_free(job->gathered);
+    free(job);
+}
+
+// waits for room in the queue, gives up if the search was cancelled in the meantime
+static bool job_push(SearchJob* job, MatchRange* batch) {
+    if (job->inline_run) {
+        isize at = arrlist_count(job->gathered);
+        arrlist_setcount(job->gathered, at + arrlist_count(batch));
+        memcpy(job->gathered + at, batch, arrlist_count(batch) * sizeof(MatchRange));
+        arrlist_free(batch);
+        return true;
+    }
+    i64 tail = atomic_load_explicit(&job->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&job->head, memory_order_acquire) == SEARCHER_QUEUE_SIZE) {
+        if (atomic_load_explicit(&job->cancelled, memory_order_relaxed)) return false;
+        thread_yield();
+    }
+    job->queue[tail & (SEARCHER_QUEUE_SIZE - 1)] = batch;
+    atomic_store_explicit(&job->tail, tail + 1, memory_order_release);
+    if (job->wake) job->wake();
+    return true;
+}
+
+static bool job_cancelled(SearchJob* job) {
+    return atomic_load_explicit(&job->cancelled, memory_order_relaxed);
+}
+
+// the first slice is small so the first matches show up within a frame, they grow from there
+static void job_next_slice(SearchJob* job) {
+    job->slice = job->slice * 2 < SEARCHER_SLICE ? job->slice * 2 : SEARCHER_SLICE;
+}
+
+// slice by slice over the bytes copied so far, each slice still uses every core. a match starting
+// before copied - needle.count + 1 is all copied. true once the whole text was searched
+static bool job_search_text(SearchJob* job, isize copied) {
+    GapBuffer* gapbuf = &job->snapshot->gapbuf;
+    String needle = string_build(job->query);
+    isize count = gapbuf_count(gapbuf);
+    isize limit = copied == count ? count : copied - needle.count + 1;
+    while (job->searched < limit && !job_cancelled(job)) {
+        isize end = limit - job->searched > job->slice ? job->searched + job->slice : limit;
+        MatchRange* batch = NULL;
+        match_index_search(gapbuf, needle, job->searched, end, &batch);
+        job->searched = end;
+        job_next_slice(job);
+        if (batch && !job_push(job, batch)) {
+            arrlist_free(batch);
+            return true;
+        }
+    }
+    return job->searched >= count || needle.count == 0 || job_cancelled(job);
+}
+
+// the scan stops at every slice boundary to hand the matches so far over and check for a cancel,
+// and at the end of the bytes copied so far. a match it's in the middle of carries on from there
+static bool job_search_regex(SearchJob* job, isize copied) {
+    GapBuffer* gapbuf = &job->snapshot->gapbuf;
+    isize count = gapbuf_count(gapbuf);
+    isize slice_end = job->scan.at;
+    MatchRange* batch = NULL;
+    bool finished = false;
+    while (!job_cancelled(job)) {
+        if (job->scan.at >= slice_end) {
+            if (job->scan.at >= copied && copied < count) break;
+            if (batch && !job_push(job, batch)) {
+                arrlist_free(batch);
+                return true;
+            }
+            batch = NULL;
+            slice_end = copied - job->scan.at > job->slice ? job->scan.at + job->slice : copied;
+            job_next_slice(job);
+        }
+        RegexMatch match;
+        bool found = regex_scan(&job->compiled, gapbuf, &job->scan, slice_end, &match);
+        if (!job->scan.settled) continue;
+        if (!found) {
+            finished = true;
+            break;
+        }
+        arrlist_append(batch, ((MatchRange){match.begin, match.end}));
+        regex_scan_begin(&job->scan, match.end > match.begin ? match.end : match.end + 1);
+    }
+    if (batch && !job_push(job, batch)) arrlist_free(batch);
+    return finished || job_cancelled(job);
+}
+
+// searches as far as the copy has got, then waits to be posted again with more of it
+static void job_main(void* arg) {
+    SearchJob* job = arg;
+    PROFILE_BEGIN("search_job");
+    bool finished = false;
+    isize searched_up_to = -1;
+    for (;;) {
+        isize copied = atomic_load_explicit(&job->snapshot->copied, memory_order_acquire);
+        if (copied == searched_up_to) break;
+        searched_up_to = copied;
+        finished = job->regex ? job_search_regex(job, copied) : job_search_text(job, copied);
+        if (finished) break;
+    }
+    if (finished) {
+        atomic_store_explicit(&job->done, true, memory_order_release);
+        if (job->wake && !job->inline_run && !job_cancelled(job)) job->wake();
+    } else {
+        atomic_store_explicit(&job->waiting, true, memory_order_release);
+    }
+    PROFILE_END("search_job");
+}
+
+// copies the next slice of the text and hands the job to the worker again once it caught up, so
+// the start of a huge buffer is searched while the rest of it is still being copied
+static void searcher_advance(Searcher* searcher) {
+    SearchJob* job = searcher->job;
+    assert(job->snapshot->version == searcher->txt->version && "the text changed under a running search, it has to be started again");
+    snapshot_copy(job->snapshot, searcher->txt);
+    if (!atomic_load_explicit(&job->waiting, memory_order_acquire)) return;
+    atomic_store_explicit(&job->waiting, false, memory_order_relaxed);
+    if (searcher->worker == NULL && !job->inline_run) searcher->worker = worker_start(job_release);
+    if (searcher->worker) {
+        atomic_fetch_add(&job->refs, 1); // the worker's
+        worker_post(searcher->worker, job_main, job);
+    } else {
+        job->inline_run = true; // no thread to be had, search right here instead
+        job_main(job);
+    }
+}
+
+void searcher_start(Searcher* searcher, Text* txt, String query, bool regex) {
+    searcher_cancel(searcher);
+    // a snapshot of the same text is reused, finished or not
+    if (searcher->snapshot == NULL || searcher->snapshot->version != txt->version || searcher->txt != txt) {
+        snapshot_release(searcher->snapshot);
+        searcher->snapshot = snapshot_make(txt);
+    }
+    searcher->txt = txt;
+
+    SearchJob* job = calloc(1, sizeof(SearchJob));
+    assert(job && "calloc failed");
+    atomic_init(&job->refs, 1);
+    atomic_init(&job->waiting, true);
+    job->snapshot = searcher->snapshot;
+    atomic_fetch_add(&job->snapshot->refs, 1);
+    string_append_string(&job->query, query);
+    job->regex = regex;
+    job->wake = searcher->wake;
+    job->slice = SEARCHER_FIRST_SLICE;
+    if (regex) {
+        regex_scan_begin(&job->scan, 0);
+        // a pattern that doesn't compile has no matches
+        if (!regex_compile(&job->compiled, query)) atomic_store(&job->done, true);
+    }
+    searcher->job = job;
+    if (!atomic_load(&job->done)) searcher_advance(searcher);
+}
+
+void searcher_cancel(Searcher* searcher) {
+    if (searcher->job == NULL) return;
+    atomic_store(&searcher->job->cancelled, true);
+    job_release(searcher->job);
+    searcher->job = NULL;
+}
+
+bool searcher_running(Searcher* searcher) {
+    return searcher->job != NULL;
+}
+
+bool searcher_poll(Searcher* searcher, MatchIndex* index) {
+    SearchJob* job = searcher->job;
+    if (job == NULL) return true;
+    if (!atomic_load(&job->done)) searcher_advance(searcher);
+
+    // done is read first, everything pushed before it was set is then in the queue
+    bool done = atomic_load_explicit(&job->done, memory_order_acquire);
+    i64 head = atomic_load_explicit(&job->head, memory_order_relaxed);
+    i64 tail = atomic_load_explicit(&job->tail, memory_order_acquire);
+    for (; head < tail; head++) {
+        MatchRange* batch = job->queue[head & (SEARCHER_QUEUE_SIZE - 1)];
+        isize found = arrlist_count(batch);
+        isize at = arrlist_count(index->matches);
+        arrlist_setcount(index->matches, at + found);
+        memcpy(index->matches + at, batch, found * sizeof(MatchRange));
+        free(arrlist_header(batch)); // only batches with matches are pushed
+    }
+    atomic_store_explicit(&job->head, head, memory_order_release);
+    if (job->gathered) {
+        isize at = arrlist_count(index->matches);
+        arrlist_setcount(index->matches, at + arrlist_count(job->gathered));
+        memcpy(index->matches + at, job->gathered, arrlist_count(job->gathered) * sizeof(MatchRange));
+        arrlist_setcount(job->gathered, 0);
+    }
+
+    if (!done) return false;
+    job_release(job);
+    searcher->job = NULL;
+    return true;
+}
+
+void searcher_free(Searcher* searcher) {
+    searcher_cancel(searcher);
+    worker_stop(searcher->worker);
+    snapshot_release(searcher->snapshot);
+    *searcher = (Searcher){0};
+}
@@ -0,0 +1,50 @@
+#ifndef SEARCHER_H_
+#define SEARCHER_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "matchindex.h"
+#include "thread.h"
+
+// finds every match for the match index on a worker thread so big buffers don't stall frames
+//
+// the worker reads a copy of the buffer (kept and reused while the text doesn't change) and hands
+// the matches back in batches through a lock free queue, the frontend drains it once a frame. the
+// copy is made SEARCHER_COPY_SLICE bytes a poll so starting a search on a huge buffer doesn't stall
+// a frame. the worker searches what's been copied meanwhile and is handed the job again when it
+// catches up, its first slice is small so the first matches come in the frame the search started.
+// cancelling only raises a flag, the worker notices it between slices of the buffer and frees the
+// job itself so nothing ever waits for it. one worker thread is kept for every search the searcher starts
+
+#define SEARCHER_BACKGROUND_MIN (1 << 20) // smaller buffers are searched at once
+#define SEARCHER_SLICE (16 << 20)         // bytes searched between checks for cancellation
+#define SEARCHER_FIRST_SLICE (1 << 20)    // the slices start out this small and double up to SEARCHER_SLICE
+#define SEARCHER_QUEUE_SIZE 256           // batches in flight, a power of two
+#define SEARCHER_COPY_SLICE (32 << 20)    // bytes of the buffer copied for the worker per poll
+
+typedef struct SearchSnapshot SearchSnapshot;
+typedef struct SearchJob SearchJob;
+
+typedef struct Searcher {
+    SearchJob* job;           // NULL when no search is running
+    SearchSnapshot* snapshot; // the copy of the buffer of the last search
+    Text* txt;                // what the snapshot is copied from
+    Worker* worker;           // started with the first search
+
+    // supplied by the frontend, called from the worker when it has matches for the next poll
+    void (*wake)(void);
+} Searcher;
+
+// cancels the running search and starts one for query (a regex pattern if regex is set). txt
+// mustn't change until the search is cancelled or started again, the copy of it goes on in polls
+// and the worker reads it as it goes
+void searcher_start(Searcher* searcher, Text* txt, String query, bool regex);
+void searcher_cancel(Searcher* searcher);
+bool searcher_running(Searcher* searcher);
+
+// appends the matches found since the last poll to the index, returns true once the search is done
+bool searcher_poll(Searcher* searcher, MatchIndex* index);
+
+void searcher_free(Searcher* searcher);
+
+#endif //SEARCHER_H_
@@ -542,16 +542,16 @@ ptrdiff_t string_findc(String haystack, Codepoint needle, ptrdiff_t start) {
 // returns the index of first instance of the substring needle in the string
 // return haystack.count if none are found
 ptrdiff_t string_find(String haystack, String needle, ptrdiff_t start) {
-    for (ptrdiff_t i = start; i < haystack.count; i++) {
-        for (ptrdiff_t j = 0; j < needle.count; j++) {
-            if (haystack.data[i + j] == needle.data[j]) {
-                if (j == needle.count - 1) {
-                    return i;
-                }
-            } else {
-                break;
-            }
-        }
+    if (needle.count == 0) return haystack.count;
+
+    // memchr skips to the next candidate, only those are compared in full
+    ptrdiff_t last = haystack.count - needle.count;
+    for (ptrdiff_t i = start; i <= last; i++) {
+        const char* candidate = memchr(haystack.data + i, needle.data[0], last - i + 1);
+        if (!candidate) break;
+
+        i = candidate - haystack.data;
+        if (memcmp(haystack.data + i, needle.data, needle.count) == 0) return i;
     }
     return haystack.count;
 }
@@ -0,0 +1,634 @@
+#include "text.h"
+#include "layout.h"
+#include "search.h"
+#include "regexp.h"
+#include "matchindex.h"
+#include "searcher.h"
+#include "editor.h"
+#include "ahocorasick.h"
+#include "watchlist.h"
+#include "highlight.h"
+#include "brackets.h"
+#include "markers.h"
+#include "minimap.h"
+#include "glyphcache.h"
+#include "thread.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char clipboard[64];
+void set_clipboard(const char* text) {
+    strncpy(clipboard, text, sizeof(clipboard) - 1);
+}
+float advance(void* font, Codepoint c) {
+    return 10.0;
+}
+
+bool text_equals(Text* txt, const char* expected) {
+    GapBufSlice strings = gapbuf_getstrings(&txt->gapbuf);
+    isize len = strlen(expected);
+    if (strings.l.count + strings.r.count != len) return false;
+    return memcmp(strings.l.data, expected, strings.l.count) == 0
+        && memcmp(strings.r.data, expected + strings.l.count, strings.r.count) == 0;
+}
+
+static void match_index_edit_listener(void* index, Text* txt, TextEdit edit) {
+    match_index_edit(index, &txt->gapbuf, edit);
+}
+
+int main() {
+    Text txt = {.set_clipboard = set_clipboard};
+
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, sl("hello\nworld"));
+    text_end_command(&txt);
+    assert(text_equals(&txt, "hello\nworld"));
+    assert(arrlist_count(txt.line_offsets) == 1 && txt.line_offsets[0] == 6);
+    assert(txt.cursor_line == 1 && txt.cursor_col == 5);
+
+    text_begin_command(&txt);
+    text_cursor_remove_before(&txt, 2);
+    text_end_command(&txt);
+    assert(text_equals(&txt, "hello\nwor"));
+
+    text_undo(&txt);
+    assert(text_equals(&txt, "hello\nworld"));
+    text_undo(&txt);
+    assert(text_equals(&txt, ""));
+    text_redo(&txt);
+    assert(text_equals(&txt, "hello\nworld"));
+
+    text_cursor_moveto(&txt, 0, 0);
+    text_select_begin(&txt);
+    text_cursor_moveto(&txt, 5, 0);
+    text_select_end(&txt);
+    text_copy_selection_to_clipboard(&txt);
+    assert(strcmp(clipboard, "hello") == 0);
+
+    // the cursor is after "hello" so the gap splits this match
+    assert(search_find(&txt.gapbuf, sl("o\nw"), 0) == 4);
+    assert(search_find(&txt.gapbuf, sl("o"), 5) == 7);
+    assert(search_find(&txt.gapbuf, sl("xyz"), 0) == -1);
+    assert(search_find_prev(&txt.gapbuf, sl("o"), 7) == 4);
+
+    // every gap position against a plain scan, long enough for the vector loop
+    GapBuffer gapbuf = gapbuf_with_cap(16);
+    for (isize i = 0; i < 300; i++) gapbuf_insert(&gapbuf, "abcab"[i % 5] + (i % 97 == 0));
+    for (isize gap = 0; gap < gapbuf_count(&gapbuf); gap += 7) {
+        gapbuf_movegap(&gapbuf, gap);
+        String needle = sl("abca");
+        isize expected = -1;
+        for (isize start = 0; start < gapbuf_count(&gapbuf); start += 13) {
+            for (expected = start; expected + needle.count <= gapbuf_count(&gapbuf); expected++) {
+                bool same = true;
+                for (isize j = 0; j < needle.count; j++) same &= gapbuf_get(&gapbuf, expected + j) == needle.data[j];
+                if (same) break;
+            }
+            if (expected + needle.count > gapbuf_count(&gapbuf)) expected = -1;
+            assert(search_find(&gapbuf, needle, start) == expected);
+        }
+    }
+    gapbuf_free(&gapbuf);
+
+    // leftmost longest, the gap is still after "hello" so the first match straddles it
+    Regex regex;
+    RegexMatch match;
+    assert(regex_compile(&regex, sl("l+o\\s\\w*|world")));
+    assert(regex_find(&regex, &txt.gapbuf, 0, &match) && match.begin == 2 && match.end == 11);
+    assert(regex_find(&regex, &txt.gapbuf, 3, &match) && match.begin == 3 && match.end == 11);
+    assert(regex_find(&regex, &txt.gapbuf, 4, &match) && match.begin == 6 && match.end == 11);
+    assert(regex_find_prev(&regex, &txt.gapbuf, 6, &match) && match.begin == 2);
+    assert(regex_count(&regex, &txt.gapbuf) == 1);
+    regex_free(&regex);
+    assert(regex_compile(&regex, sl("^w|d$")));
+    assert(regex_count(&regex, &txt.gapbuf) == 2);
+    regex_free(&regex);
+    assert(!regex_compile(&regex, sl("(a|b")) && regex.error != NULL);
+
+    // big enough to be split across threads, chunk boundaries land inside matches
+    gapbuf = gapbuf_with_cap(16);
+    for (isize i = 0; i < 3 * MATCH_INDEX_PARALLEL_MIN; i++) gapbuf_insert(&gapbuf, "abcab"[i % 5]);
+    gapbuf_movegap(&gapbuf, MATCH_INDEX_PARALLEL_MIN + 3);
+    MatchIndex index = {0};
+    match_index_build(&index, &gapbuf, sl("bca"));
+    isize expected_count = 0;
+    for (isize at = search_find(&gapbuf, sl("bca"), 0); at >= 0; at = search_find(&gapbuf, sl("bca"), at + 1)) {
+        assert(index.matches[expected_count].begin == at);
+        expected_count++;
+    }
+    assert(arrlist_count(index.matches) == expected_count && expected_count == 3 * MATCH_INDEX_PARALLEL_MIN / 5);
+    assert(match_index_find(&index, 3) == 0 && match_index_find(&index, 4) == 1);
+    gapbuf_free(&gapbuf);
+
+    // edits patch the index in place, it has to agree with building it again, overlapping matches included
+    Text edited = {0};
+    text_add_listener(&edited, (TextListener){match_index_edit_listener, &index});
+    text_begin_command(&edited);
+    text_cursor_insert(&edited, sl("aaa aa aaaa"));
+    match_index_build(&index, &edited.gapbuf, sl("aa"));
+    const char* inserts[] = {"a", "ba", "aa", "", "a a"};
+    for (isize i = 0; i < 40; i++) {
+        text_cursor_move(&edited, (i * 7) % (gapbuf_count(&edited.gapbuf) + 1) - text_cursor_idx(&edited));
+        if (i % 3 == 0) text_cursor_remove_before(&edited, 1 + i % 2);
+        else text_cursor_insert(&edited, string_from_cstring(inserts[i % 5]));
+        if (i == 20) text_undo(&edited);
+
+        MatchIndex fresh = {0};
+        match_index_build(&fresh, &edited.gapbuf, sl("aa"));
+        assert(arrlist_count(fresh.matches) == arrlist_count(index.matches));
+        for (isize j = 0; j < arrlist_count(fresh.matches); j++) assert(fresh.matches[j].begin == index.matches[j].begin);
+        match_index_free(&fresh);
+    }
+    text_end_command(&edited);
+
+    // a longer query only filters the matches already found, anything else needs a new search
+    match_index_build(&index, &edited.gapbuf, sl("a"));
+    assert(match_index_narrow(&index, &edited.gapbuf, sl("aa")));
+    MatchIndex fresh = {0};
+    match_index_build(&fresh, &edited.gapbuf, sl("aa"));
+    assert(arrlist_count(index.matches) == arrlist_count(fresh.matches));
+    for (isize j = 0; j < arrlist_count(fresh.matches); j++) assert(fresh.matches[j].end == index.matches[j].end);
+    assert(!match_index_narrow(&index, &edited.gapbuf, sl("ba")) && !match_index_narrow(&index, &edited.gapbuf, sl("a")));
+    match_index_free(&fresh);
+    match_index_free(&index);
+
+    // ctrl + f then typing selects the next match as the query grows, enter steps to the one after
+    Editor editor = {.camera = camera_default()};
+    text_begin_command(&editor.txt);
+    text_cursor_insert(&editor.txt, sl("one two one two"));
+    text_end_command(&editor.txt);
+    text_cursor_moveto(&editor.txt, 0, 0);
+    InputEvent find_events[] = {{.key = INPUT_KEY_F}};
+    editor_update(&editor, (EditorInput){.events = find_events, .event_count = 1, .cntrl = true});
+    InputEvent query_events[] = {{.codepoint = 't'}, {.codepoint = 'w'}, {.key = INPUT_KEY_ENTER}};
+    editor_update(&editor, (EditorInput){.events = query_events, .event_count = 3});
+    assert(editor.find.active && editor.find.found);
+    assert(editor.txt.selection_begin == 12 && editor.txt.selection_end == 14);
+    assert(text_equals(&editor.txt, "one two one two"));
+
+    // ctrl + r turns the query into a regex, "tw" still matches and "e+ " finds the end of "one "
+    InputEvent regex_events[] = {{.key = INPUT_KEY_R}};
+    editor_update(&editor, (EditorInput){.events = regex_events, .event_count = 1, .cntrl = true});
+    assert(editor.find.regex && editor.find.found && editor.txt.selection_begin == 4);
+    InputEvent pattern_events[] = {{.key = INPUT_KEY_BACKSPACE}, {.key = INPUT_KEY_BACKSPACE}, {.codepoint = 'e'}, {.codepoint = '+'}, {.codepoint = ' '}};
+    editor_update(&editor, (EditorInput){.events = pattern_events, .event_count = 5});
+    assert(editor.find.found && editor.txt.selection_begin == 2 && editor.txt.selection_end == 4);
+
+    // a buffer past SEARCHER_BACKGROUND_MIN is indexed on the searcher's thread, the query changes
+    // while it runs and the selection only lands once the match came in
+    Editor big = {.camera = camera_default()};
+    StringBuilder haystack = {0};
+    for (isize i = 0; i < 2 * SEARCHER_BACKGROUND_MIN / 16; i++) string_append_string(&haystack, sl("needle haystack\n"));
+    text_begin_command(&big.txt);
+    text_cursor_insert(&big.txt, string_build(haystack));
+    text_end_command(&big.txt);
+    string_free(&haystack);
+    text_cursor_moveto(&big.txt, 0, 10);
+    InputEvent big_events[] = {{.key = INPUT_KEY_F}, {.codepoint = 'h'}, {.codepoint = 'a'}, {.codepoint = 'y'}};
+    editor_update(&big, (EditorInput){.events = big_events, .event_count = 1, .cntrl = true});
+    editor_update(&big, (EditorInput){.events = big_events + 1, .event_count = 3});
+    while (searcher_running(&big.find.searcher) || big.find.pending) editor_update(&big, (EditorInput){0});
+    assert(big.find.found && big.txt.selection_begin == 10 * 16 + 7);
+    assert(arrlist_count(big.find.matches.matches) == 2 * SEARCHER_BACKGROUND_MIN / 16);
+
+    // an edit while the search runs starts it again over the new text
+    InputEvent shorter_events[] = {{.key = INPUT_KEY_BACKSPACE}};
+    editor_update(&big, (EditorInput){.events = shorter_events, .event_count = 1});
+    assert(searcher_running(&big.find.searcher));
+    big.txt.selected = false;
+    text_cursor_moveto(&big.txt, 0, 0);
+    text_begin_command(&big.txt);
+    text_cursor_insert(&big.txt, sl("x"));
+    text_end_command(&big.txt);
+    assert(big.find.restart);
+    while (searcher_running(&big.find.searcher) || big.find.pending || big.find.restart) editor_update(&big, (EditorInput){0});
+    assert(arrlist_count(big.find.matches.matches) == 2 * SEARCHER_BACKGROUND_MIN / 16);
+    assert(big.find.matches.matches[0].begin == 8 && big.find.matches.matches[1].begin == 16 + 8);
+    searcher_free(&big.find.searcher);
+
+    // replace all writes the buffer once and comes back with a single undo
+    Text replaced = {0};
+    text_begin_command(&replaced);
+    text_cursor_insert(&replaced, sl("a.b.c\nd.e"));
+    text_end_command(&replaced);
+    text_cursor_moveto(&replaced, 2, 1);
+    TextRange dots[] = {{1, 2}, {3, 4}, {3, 5}, {7, 8}};
+    assert(text_replace_all(&replaced, dots, 4, sl(" -> ")) == 3);
+    assert(text_equals(&replaced, "a -> b -> c\nd -> e"));
+    assert(text_cursor_idx(&replaced) == 17 && replaced.cursor_col == 5 && replaced.cursor_line == 1);
+    assert(arrlist_count(replaced.line_offsets) == 1 && replaced.line_offsets[0] == 12);
+    text_undo(&replaced);
+    assert(text_equals(&replaced, "a.b.c\nd.e"));
+    text_redo(&replaced);
+    assert(text_equals(&replaced, "a -> b -> c\nd -> e"));
+    text_undo(&replaced);
+    text_undo(&replaced);
+    assert(text_equals(&replaced, ""));
+
+    // the selection moves with the text, undoing an insert before it moves it back
+    Text shifted = {0};
+    text_begin_command(&shifted);
+    text_cursor_insert(&shifted, sl("one three"));
+    text_end_command(&shifted);
+    text_cursor_moveto(&shifted, 0, 0);
+    text_begin_command(&shifted);
+    text_cursor_insert(&shifted, sl("zero "));
+    text_end_command(&shifted);
+    text_select_range(&shifted, 9, 14);
+    text_undo(&shifted);
+    assert(text_equals(&shifted, "one three"));
+    assert(shifted.selected && shifted.selection_begin == 4 && shifted.selection_end == 9);
+
+    // ctrl + h types the replacement, ctrl + enter swaps every match
+    InputEvent replace_events[] = {{.key = INPUT_KEY_H}, {.codepoint = '1'}, {.key = INPUT_KEY_ENTER}};
+    editor_update(&editor, (EditorInput){.events = replace_events, .event_count = 1, .cntrl = true});
+    editor_update(&editor, (EditorInput){.events = replace_events + 1, .event_count = 1});
+    editor_update(&editor, (EditorInput){.events = replace_events + 2, .event_count = 1, .cntrl = true});
+    assert(text_equals(&editor.txt, "on1two on1two"));
+    text_undo(&editor.txt);
+    assert(text_equals(&editor.txt, "one two one two"));
+
+    // typing at every cursor is one edit and one undo, backspace takes a codepoint at each of them
+    Text multi = {0};
+    text_begin_command(&multi);
+    text_cursor_insert(&multi, sl("ab\ncd\nef"));
+    text_end_command(&multi);
+    text_cursor_moveto(&multi, 0, 0);
+    text_add_cursor(&multi, 3, 3);
+    text_add_cursor(&multi, 6, 6);
+    text_add_cursor(&multi, 3, 3);
+    assert(arrlist_count(multi.cursors) == 2);
+    text_cursors_insert(&multi, sl("\xc3\xa9"));
+    assert(text_equals(&multi, "\xc3\xa9" "ab\n\xc3\xa9" "cd\n\xc3\xa9" "ef"));
+    assert(arrlist_count(multi.line_offsets) == 2 && multi.line_offsets[0] == 5 && multi.line_offsets[1] == 10);
+    assert(text_cursor_idx(&multi) == 2 && multi.cursors[0].head == 7 && multi.cursors[1].head == 12);
+    text_cursors_remove(&multi, false);
+    assert(text_equals(&multi, "ab\ncd\nef") && multi.cursors[1].head == 6);
+    text_undo(&multi);
+    assert(text_equals(&multi, "\xc3\xa9" "ab\n\xc3\xa9" "cd\n\xc3\xa9" "ef"));
+    text_undo(&multi);
+    assert(text_equals(&multi, "ab\ncd\nef"));
+
+    // a block has a cursor on every line, short lines only get what they have of it. a copied block
+    // pastes back a line per cursor and the whole paste is one undo
+    Text block = {.set_clipboard = set_clipboard};
+    text_begin_command(&block);
+    text_cursor_insert(&block, sl("abcd\nef\nghij"));
+    text_end_command(&block);
+    text_select_block(&block, 0, 1, 2, 3);
+    assert(arrlist_count(block.cursors) == 2 && block.selected && text_cursor_idx(&block) == 11);
+    assert(block.cursors[0].anchor == 1 && block.cursors[0].head == 3 && block.cursors[1].anchor == 6 && block.cursors[1].head == 7);
+    text_cursors_copy(&block);
+    assert(strcmp(clipboard, "bc\nf\nhi") == 0);
+    text_cursors_insert(&block, (String){0});
+    assert(text_equals(&block, "ad\ne\ngj"));
+    text_cursors_paste(&block, string_from_cstring(clipboard));
+    assert(text_equals(&block, "abcd\nef\nghij"));
+    text_undo(&block);
+    assert(text_equals(&block, "ad\ne\ngj"));
+    text_redo(&block);
+    assert(text_equals(&block, "abcd\nef\nghij"));
+
+    // alt + shift + arrows grow the block from the cursor
+    Editor columns = {.camera = camera_default()};
+    text_begin_command(&columns.txt);
+    text_cursor_insert(&columns.txt, sl("1,2\n3,4\n5,6"));
+    text_end_command(&columns.txt);
+    text_cursor_moveto(&columns.txt, 1, 0);
+    InputEvent block_events[] = {{.key = INPUT_KEY_DOWN}, {.key = INPUT_KEY_DOWN}, {.key = INPUT_KEY_RIGHT}, {.codepoint = ';'}};
+    editor_update(&columns, (EditorInput){.events = block_events, .event_count = 3, .shift = true, .alt = true});
+    assert(arrlist_count(columns.txt.cursors) == 2);
+    editor_update(&columns, (EditorInput){.events = block_events + 3, .event_count = 1});
+    assert(text_equals(&columns.txt, "1;2\n3;4\n5;6"));
+
+    // ctrl + d selects the word, every press after adds the next occurrence and typing replaces them all
+    InputEvent occurrence_events[] = {{.key = INPUT_KEY_D}, {.codepoint = 'x'}};
+    text_cursor_moveto(&editor.txt, 0, 1);
+    editor_update(&editor, (EditorInput){.events = occurrence_events, .event_count = 1, .cntrl = true});
+    editor_update(&editor, (EditorInput){.events = occurrence_events, .event_count = 1, .cntrl = true});
+    assert(arrlist_count(editor.txt.cursors) == 1);
+    editor_update(&editor, (EditorInput){.events = occurrence_events + 1, .event_count = 1});
+    assert(text_equals(&editor.txt, "x two x two"));
+    text_undo(&editor.txt);
+    assert(text_equals(&editor.txt, "one two one two"));
+
+    // every occurrence the automaton reports is real and none are missed, overlapping ones included
+    String patterns[] = {sl("he"), sl("she"), sl("his"), sl("hers"), sl("e"), sl("")};
+    const char* words_text = "ushers he his shehershe";
+    AhoCorasick aho;
+    aho_build(&aho, patterns, countof(patterns));
+    TextRange* found = NULL;
+    aho_scan(&aho, words_text, strlen(words_text), &found);
+    isize expected = 0;
+    for (isize i = 0; i < (isize)strlen(words_text); i++) {
+        for (isize p = 0; p < countof(patterns) - 1; p++) {
+            expected += strncmp(words_text + i, patterns[p].data, patterns[p].count) == 0;
+        }
+    }
+    assert(arrlist_count(found) == expected);
+    for (isize i = 0; i < arrlist_count(found); i++) {
+        bool real = false;
+        for (isize p = 0; p < countof(patterns) - 1; p++) {
+            real |= patterns[p].count == found[i].end - found[i].begin
+                && memcmp(words_text + found[i].begin, patterns[p].data, patterns[p].count) == 0;
+        }
+        assert(real);
+        assert(i == 0 || found[i - 1].end <= found[i].end);
+    }
+    arrlist_free(found);
+    aho_free(&aho);
+
+    // a line's highlights are kept until it's edited, lines below move with the newlines
+    Text watched = {0};
+    text_begin_command(&watched);
+    text_cursor_insert(&watched, sl("alpha beta\ngamma alphabeta\nbeta"));
+    text_end_command(&watched);
+    Watchlist watchlist = {0};
+    String watch_patterns[] = {sl("alpha"), sl("beta"), sl("phab")};
+    watchlist_set(&watchlist, &watched, watch_patterns, countof(watch_patterns));
+    WatchLine* watch_line = watchlist_line(&watchlist, 1);
+    assert(arrlist_count(watch_line->spans) == 1 && watch_line->spans[0].begin == 6 && watch_line->spans[0].end == 15);
+    watch_line = watchlist_line(&watchlist, 0);
+    assert(arrlist_count(watch_line->spans) == 2 && watch_line->spans[1].begin == 6 && watch_line->spans[1].end == 10);
+    watchlist_line(&watchlist, 2);
+    text_cursor_moveto(&watched, 0, 0);
+    text_cursor_insert(&watched, sl("x\n"));
+    assert(arrlist_count(watchlist.lines) == 2 && watchlist.lines[0].line == 2 && watchlist.lines[1].line == 3);
+    assert(watchlist_line(&watchlist, 2)->spans[0].begin == 6);
+    text_cursor_moveto(&watched, 0, 2);
+    text_cursor_remove_before(&watched, 1);
+    assert(arrlist_count(watchlist.lines) == 1 && watchlist.lines[0].line == 2);
+    watch_line = watchlist_line(&watchlist, 1);
+    assert(arrlist_count(watch_line->spans) == 3 && watch_line->spans[2].begin == 16);
+    watchlist_free(&watchlist);
+    assert(arrlist_count(watched.listeners) == 0);
+
+    // lexing a line gives the spans and the state the next line starts in
+    const HighlightLanguage* c = highlight_language_for("hello.c");
+    assert(c && c == highlight_language_for(NULL) && highlight_language_for("notes.txt") == NULL);
+    assert(strcmp(highlight_language_for("tool.py")->name, "python") == 0);
+    HighlightSpan* spans = NULL;
+    const char* include = "#include <stdio.h> // hi\n";
+    assert(highlight_lex_line(c, LEX_LINE_START, include, strlen(include), &spans) == LEX_LINE_START);
+    assert(arrlist_count(spans) == 3);
+    assert(spans[0].kind == HIGHLIGHT_PREPROCESSOR && spans[0].begin == 0 && spans[0].end == 8);
+    assert(spans[1].kind == HIGHLIGHT_STRING && spans[1].begin == 9 && spans[1].end == 18);
+    assert(spans[2].kind == HIGHLIGHT_COMMENT && spans[2].begin == 19 && spans[2].end == 24);
+    arrlist_setcount(spans, 0);
+    const char* opened = "int x = 0x1f; /* open\n";
+    assert(c->state_kinds[highlight_lex_line(c, LEX_LINE_START, opened, strlen(opened), &spans)] == HIGHLIGHT_COMMENT);
+    assert(arrlist_count(spans) == 3 && spans[0].kind == HIGHLIGHT_TYPE && spans[1].kind == HIGHLIGHT_NUMBER);
+    assert(spans[1].begin == 8 && spans[1].end == 12 && spans[2].begin == 14 && spans[2].end == 21);
+    LexState in_string = highlight_lex_line(c, LEX_LINE_START, "s = \"ab\\\n", 9, NULL);
+    assert(c->state_kinds[in_string] == HIGHLIGHT_STRING);
+    arrlist_setcount(spans, 0);
+    assert(highlight_lex_line(c, in_string, "cd\"; x\n", 7, &spans) == LEX_LINE_START);
+    assert(arrlist_count(spans) == 1 && spans[0].kind == HIGHLIGHT_STRING && spans[0].end == 3);
+    // the same table loop with python's tables, # is a comment there rather than a directive
+    arrlist_setcount(spans, 0);
+    const char* python = "def f(): return .5 # None\n";
+    highlight_lex_line(highlight_language_for("tool.py"), LEX_LINE_START, python, strlen(python), &spans);
+    assert(arrlist_count(spans) == 4 && spans[0].kind == HIGHLIGHT_KEYWORD && spans[1].kind == HIGHLIGHT_KEYWORD);
+    assert(spans[2].kind == HIGHLIGHT_NUMBER && spans[2].begin == 16 && spans[2].end == 18);
+    assert(spans[3].kind == HIGHLIGHT_COMMENT && spans[3].begin == 19);
+    arrlist_free(spans);
+
+    // an edit only lexes lines again until one ends the way it did before
+    Text source = {0};
+    StringBuilder source_text = {0};
+    for (isize i = 0; i < 1000; i++) string_append_string(&source_text, sl("int a;\n"));
+    text_begin_command(&source);
+    text_cursor_insert(&source, string_build(source_text));
+    text_end_command(&source);
+    string_free(&source_text);
+    Highlighter highlighter = {0};
+    highlight_attach(&highlighter, &source, c);
+    highlight_line(&highlighter, 1000);
+    assert(highlighter.clean == 1000);
+    text_cursor_moveto(&source, 4, 10);
+    text_cursor_insert(&source, sl("b"));
+    assert(highlighter.clean == 10);
+    highlight_line(&highlighter, 500);
+    assert(highlighter.clean == 1000);
+    // opening a comment carries down only as far as what's drawn
+    text_cursor_moveto(&source, 0, 10);
+    text_cursor_insert(&source, sl("/*"));
+    HighlightSpan* commented = highlight_line(&highlighter, 500);
+    assert(highlighter.clean == 500 && c->state_kinds[highlighter.states[499]] == HIGHLIGHT_COMMENT);
+    assert(arrlist_count(commented) == 1 && commented[0].kind == HIGHLIGHT_COMMENT && commented[0].end == 6);
+    text_cursor_remove_before(&source, 2);
+    HighlightSpan* uncommented = highlight_line(&highlighter, 999);
+    assert(highlighter.clean == 1000 && uncommented[0].kind == HIGHLIGHT_TYPE);
+    highlight_free(&highlighter);
+
+    // brackets in strings and comments don't count, the rest keep matching through edits
+    Text nested = {0};
+    const char* nested_text = "int f(int a) {\n    char* s = \"(\"; /* ] */\n    return g[a] + (a);\n}\n";
+    text_begin_command(&nested);
+    text_cursor_insert(&nested, string_from_cstring(nested_text));
+    text_end_command(&nested);
+    BracketIndex brackets = {0};
+    bracket_index_attach(&brackets, &nested, c);
+    isize open_brace = strchr(nested_text, '{') - nested_text;
+    isize close_brace = strrchr(nested_text, '}') - nested_text;
+    isize quoted = strchr(nested_text, '"') - nested_text + 1;
+    assert(bracket_index_count(&brackets) == 8);
+    assert(bracket_index_match(&brackets, 5) == 11 && bracket_index_match(&brackets, 11) == 5);
+    assert(bracket_index_match(&brackets, open_brace) == close_brace && bracket_index_match(&brackets, close_brace) == open_brace);
+    assert(bracket_index_match(&brackets, quoted) == -1 && bracket_index_match(&brackets, 0) == -1);
+    isize near_at, near_match;
+    assert(bracket_index_near(&brackets, 12, &near_at, &near_match) && near_at == 11 && near_match == 5);
+    // a new opener takes the closing brace and leaves the first one unmatched
+    text_cursor_moveto(&nested, 0, 1);
+    text_cursor_insert(&nested, sl("{"));
+    assert(bracket_index_match(&brackets, open_brace) == -1);
+    assert(bracket_index_match(&brackets, close_brace + 1) == open_brace + 2);
+    // an unclosed comment hides every bracket after it until it's closed again
+    text_cursor_moveto(&nested, 0, 2);
+    text_cursor_insert(&nested, sl("/*"));
+    assert(bracket_index_count(&brackets) == 4 && bracket_index_match(&brackets, open_brace + 2) == -1);
+    text_cursor_remove_before(&nested, 2);
+    assert(bracket_index_count(&brackets) == 9 && bracket_index_match(&brackets, close_brace + 1) == open_brace + 2);
+    bracket_index_free(&brackets);
+    assert(arrlist_count(nested.listeners) == 0);
+
+    // markers move with the edits before them, the ones in removed bytes end up where the edit was
+    Text marked = {0};
+    text_begin_command(&marked);
+    text_cursor_insert(&marked, sl("one\ntwo\nthree\n"));
+    text_end_command(&marked);
+    MarkerSet markers = {0};
+    marker_set_attach(&markers, &marked);
+    Marker two = marker_add(&markers, 4);
+    Marker three = marker_add(&markers, 8);
+    Marker inside = marker_add(&markers, 10);
+    text_cursor_moveto(&marked, 0, 0);
+    text_cursor_insert(&marked, sl("zero\n"));
+    assert(marker_index(&markers, two) == 9 && marker_index(&markers, three) == 13 && marker_index(&markers, inside) == 15);
+    // text inserted right at a marker goes in front of it, like it does of the cursor
+    text_cursor_move(&marked, 9 - text_cursor_idx(&marked));
+    text_cursor_insert(&marked, sl("+"));
+    assert(marker_index(&markers, two) == 10 && marker_index(&markers, inside) == 16);
+    text_select_range(&marked, 14, 18);
+    text_delete_selection(&marked);
+    assert(marker_index(&markers, three) == 14 && marker_index(&markers, inside) == 14);
+    isize next_at;
+    assert(marker_next(&markers, 11, &next_at) == three && next_at == 14);
+    marker_remove(&markers, three);
+    assert(marker_count(&markers) == 2 && marker_next(&markers, 11, &next_at) == inside);
+    marker_set_free(&markers);
+
+    // ctrl + b bookmarks the cursor's line and f2 comes back to it from anywhere
+    InputEvent bookmark_events[] = {{.key = INPUT_KEY_B}, {.key = INPUT_KEY_F2}};
+    text_cursor_moveto(&editor.txt, 5, 0);
+    editor_update(&editor, (EditorInput){.events = bookmark_events, .event_count = 1, .cntrl = true});
+    assert(marker_count(&editor.bookmarks) == 1);
+    text_cursor_moveto(&editor.txt, 0, 0);
+    text_begin_command(&editor.txt);
+    text_cursor_insert(&editor.txt, sl("a\nb\n"));
+    text_end_command(&editor.txt);
+    editor_update(&editor, (EditorInput){.events = bookmark_events + 1, .event_count = 1});
+    assert(text_cursor_idx(&editor.txt) == 4);
+    editor_update(&editor, (EditorInput){.events = bookmark_events, .event_count = 1, .cntrl = true});
+    assert(marker_count(&editor.bookmarks) == 0);
+
+    TextCamera camera = camera_default();
+    camera.width = 1000;
+    camera.height = 1000;
+    camera.max_cols = 4;
+    FontMetrics metrics = {.advance = advance, .line_height = 20};
+    CameraPosition pos = {0};
+    while (pos.index < gapbuf_count(&txt.gapbuf)) camera_next_char(&camera, &txt, metrics, &pos);
+    assert(pos.line == 1 && pos.screen_line == 3);
+
+    // four codepoints to a display row, and the rows of each line follow its edits
+    Text wrapped = {0};
+    text_begin_command(&wrapped);
+    text_cursor_insert(&wrapped, sl("abcdefghij\nxy\n0123456789abcdef"));
+    text_end_command(&wrapped);
+    WrapIndex wrap = {0};
+    wrap_index_attach(&wrap, &wrapped);
+    assert(wrap_index_line_rows(&wrap, 0) == 1);
+    wrap_index_configure(&wrap, &camera, metrics);
+    assert(wrap_index_line_rows(&wrap, 0) == 3);
+    assert(wrap_index_row_start(&wrap, 0, 1).index == 3 && wrap_index_row_start(&wrap, 0, 1).col == 3);
+    assert(wrap_index_row_in_line(&wrap, 0, 6) == 1 && wrap_index_row_in_line(&wrap, 0, 7) == 2);
+    assert(wrap_index_line_rows(&wrap, 2) == 5);
+    assert(wrap_index_row_of(&wrap, 2) == 4);
+    isize row_in_line;
+    assert(wrap_index_line_at(&wrap, 6, &row_in_line) == 2 && row_in_line == 2);
+    assert(wrap_index_line_at(&wrap, 3, &row_in_line) == 1 && row_in_line == 0);
+    isize wrap_line = 0, wrap_row = 0;
+    wrap_index_scroll(&wrap, &wrap_line, &wrap_row, 4);
+    assert(wrap_line == 2 && wrap_row == 0);
+    wrap_index_scroll(&wrap, &wrap_line, &wrap_row, -2);
+    assert(wrap_line == 0 && wrap_row == 2);
+    TextCamera wrap_camera = camera;
+    wrap_camera.row = 2;
+    wrap_camera.wrap_row = 3;
+    CameraPosition start = camera_start_position(&wrap_camera, &wrapped, &wrap);
+    assert(start.index == 25 && start.col == 11 && start.line == 2);
+    while (start.screen_line == 0) {
+        isize before = start.index;
+        camera_next_char(&wrap_camera, &wrapped, metrics, &start);
+        if (start.screen_line != 0) assert(before == wrap_index_row_start(&wrap, 2, 4).index);
+    }
+    text_cursor_moveto(&wrapped, 5, 0);
+    text_begin_command(&wrapped);
+    text_cursor_insert(&wrapped, sl("\n"));
+    text_end_command(&wrapped);
+    assert(wrap_index_line_rows(&wrap, 0) == 2 && wrap_index_line_rows(&wrap, 1) == 2);
+    assert(wrap_index_row_of(&wrap, 3) == 5 && wrap_index_line_rows(&wrap, 3) == 5);
+    assert(wrap_index_row_start(&wrap, 3, 1).index == 18);
+    text_cursor_moveto(&wrapped, 0, 2);
+    text_begin_command(&wrapped);
+    text_cursor_insert(&wrapped, sl("0123456"));
+    text_end_command(&wrapped);
+    assert(wrap_index_line_rows(&wrap, 2) == 3 && wrap_index_row_of(&wrap, 3) == 7);
+    camera.max_cols = 100;
+    wrap_index_configure(&wrap, &camera, metrics);
+    assert(wrap_index_line_rows(&wrap, 3) == 1 && wrap_index_row_of(&wrap, 3) == 3);
+    wrap_index_free(&wrap);
+
+    // a line of 40000 two byte codepoints, columns are found from the checkpoints left along it and
+    // it's only wrapped as far as the rows looked at
+    Text long_line = {0};
+    StringBuilder long_bytes = {0};
+    for (isize i = 0; i < 40000; i++) string_append_string(&long_bytes, sl("\xc3\xa9"));
+    text_begin_command(&long_line);
+    text_cursor_insert(&long_line, string_build(long_bytes));
+    text_end_command(&long_line);
+    assert(long_line.cursor_col == 40000);
+    assert(arrlist_count(long_line.checkpoints) == 80000 / TEXT_CHECKPOINT_BYTES);
+    assert(text_index(&long_line, 30001, 0) == 60002);
+    assert(text_get_pos(&long_line, 50000).col == 25000);
+    text_cursor_moveto(&long_line, 10000, 0);
+    text_begin_command(&long_line);
+    text_cursor_insert(&long_line, sl("a"));
+    text_end_command(&long_line);
+    assert(text_get_pos(&long_line, 60003).col == 30002);
+    assert(text_index(&long_line, 5000, 0) == 10000);
+    WrapIndex long_wrap = {0};
+    wrap_index_attach(&long_wrap, &long_line);
+    camera.max_cols = 4;
+    wrap_index_configure(&long_wrap, &camera, metrics);
+    assert(wrap_index_row_start(&long_wrap, 0, 2).index == 14);
+    assert(long_wrap.lines[0].rows == 0 && wrap_index_row_of(&long_wrap, 1) == 3);
+    assert(wrap_index_line_rows(&long_wrap, 0) == 10001);
+    text_cursor_moveto(&long_line, 39000, 0);
+    text_begin_command(&long_line);
+    text_cursor_remove_before(&long_line, 1);
+    text_end_command(&long_line);
+    assert(arrlist_count(long_wrap.lines[0].breaks) == 9749 && wrap_index_row_of(&long_wrap, 1) == 9750);
+    wrap_index_free(&long_wrap);
+
+    // a minimap cell counts the columns that aren't blank and takes the kind most of them are, the
+    // state a comment leaves a line in colours the next one
+    Text mapped = {0};
+    text_begin_command(&mapped);
+    text_cursor_insert(&mapped, sl("int a;\n/* x\ny */\nb"));
+    text_end_command(&mapped);
+    Minimap map = {0};
+    minimap_attach(&map, &mapped, highlight_language_for("x.c"));
+    while (!minimap_poll(&map)) thread_yield();
+    assert(minimap_lines(&map) == 4);
+    assert(MINIMAP_INK(minimap_row(&map, 0)[0]) == 3 && MINIMAP_INK(minimap_row(&map, 0)[1]) == 2);
+    assert(MINIMAP_KIND(minimap_row(&map, 1)[0]) == HIGHLIGHT_COMMENT && MINIMAP_KIND(minimap_row(&map, 2)[0]) == HIGHLIGHT_COMMENT);
+    assert(MINIMAP_INK(minimap_row(&map, 0)[2]) == 0);
+    // closing the comment early recolours the line after the edit, the lines before it are kept
+    u64 version = map.version;
+    text_cursor_moveto(&mapped, 4, 1);
+    text_begin_command(&mapped);
+    text_cursor_insert(&mapped, sl(" */"));
+    text_end_command(&mapped);
+    assert(map.version != version && map.dirty_begin == 1);
+    while (!minimap_poll(&map)) thread_yield();
+    assert(MINIMAP_KIND(minimap_row(&map, 2)[0]) != HIGHLIGHT_COMMENT && MINIMAP_INK(minimap_row(&map, 0)[0]) == 3);
+    // a panel too short for every line scrolls with the camera and keeps its row on it
+    assert(minimap_top(&map, 3, 10) == 0 && minimap_top(&map, 3, 2) == 2 && minimap_top(&map, 0, 2) == 0);
+    minimap_free(&map);
+
+    // glyphs are packed in shelves onto new pages until there are max_pages, then the page drawn
+    // from the longest ago is emptied for the next one
+    GlyphCache glyphs = {0};
+    glyph_cache_init(&glyphs, 32, 2);
+    i32 cleared;
+    assert(glyph_cache_find(&glyphs, 0x3b1) == NULL);
+    GlyphEntry* alpha = glyph_cache_insert(&glyphs, 0x3b1, 10, 12, &cleared);
+    assert(cleared == 0 && alpha->page == 0 && alpha->x == 0 && alpha->y == 0);
+    assert(glyph_cache_insert(&glyphs, 0x3b2, 10, 8, &cleared)->x == 11 && cleared == -1);
+    GlyphEntry* gamma = glyph_cache_insert(&glyphs, 0x3b3, 15, 8, &cleared);
+    assert(gamma->x == 0 && gamma->y == 13 && cleared == -1);
+    assert(glyph_cache_insert(&glyphs, 0x3b4, 20, 20, &cleared)->page == 1 && cleared == 1);
+    glyph_cache_next_frame(&glyphs);
+    assert(glyph_cache_find(&glyphs, 0x3b1)->page == 0);
+    // page 1 wasn't drawn from this frame, so it goes even though it was filled last
+    assert(glyph_cache_insert(&glyphs, 0x3b5, 20, 20, &cleared)->page == 1 && cleared == 1);
+    assert(glyph_cache_find(&glyphs, 0x3b4) == NULL && glyph_cache_find(&glyphs, 0x3b2)->x == 11);
+    for (Codepoint c = 0x400; c < 0x500; c++) glyph_cache_insert(&glyphs, c, 0, 0, &cleared);
+    assert(glyph_cache_find(&glyphs, 0x4ff) != NULL && arrlist_count(glyphs.pages) == 2);
+    glyph_cache_free(&glyphs);
+
+    printf("Done!\n");
+}
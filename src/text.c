@@ -1,28 +1,83 @@
 #include "text.h"
 #include "arraylist.h"
-#include <raylib.h>
+#include "profiler.h"
 #include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// the first checkpoint at or after index
+static isize text_checkpoint_search(Text* txt, isize index) {
+    isize lo = 0, hi = arrlist_count(txt->checkpoints);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (txt->checkpoints[mid].index < index) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
 
-CursorPosition text_get_pos(Text* txt, isize index) {
-    isize row = 0;
-    isize curr = 0;
-    for (row = 0; row < arrlist_count(txt->line_offsets); row++) {
-        if (txt->line_offsets[row] > index) break;
-        curr = txt->line_offsets[row];
+// walks the line from its last checkpoint before index and col until it reaches either of them or
+// the newline. a walk past the line's last checkpoint leaves new ones behind it
+static TextCheckpoint text_walk_line(Text* txt, isize line, isize index, isize col) {
+    isize begin = line > 0 ? txt->line_offsets[line - 1] : 0;
+    isize end = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf) + 1;
+    isize first = text_checkpoint_search(txt, begin);
+    isize last = text_checkpoint_search(txt, end);
+    // the index and the column both grow through the line, so the ones before both are a prefix
+    isize lo = first, hi = last;
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (txt->checkpoints[mid].index <= index && txt->checkpoints[mid].col <= col) lo = mid + 1;
+        else hi = mid;
     }
+    TextCheckpoint at = lo > first ? txt->checkpoints[lo - 1] : (TextCheckpoint){begin, 0};
+    bool extend = lo == last;
+    isize next = at.index + TEXT_CHECKPOINT_BYTES;
+
     GapBufSlice strings = gapbuf_getstrings(&txt->gapbuf);
-    isize col = 0;
-    while (curr < index) {
-        if (curr < strings.l.count) {
-            curr = string_iterate(strings.l, curr);
+    while (at.index < index && at.col < col) {
+        if (at.index < strings.l.count) {
+            if (strings.l.data[at.index] == '\n') break;
+            at.index = string_iterate(strings.l, at.index);
+        } else if (at.index < strings.l.count + strings.r.count) {
+            if (strings.r.data[at.index - strings.l.count] == '\n') break;
+            at.index = string_iterate(strings.r, at.index - strings.l.count) + strings.l.count;
         } else {
-            curr = string_iterate(strings.r, curr - strings.l.count) + strings.l.count;
+            break;
+        }
+        at.col++;
+        if (extend && at.index >= next) {
+            arrlist_append(txt->checkpoints, at);
+            isize count = arrlist_count(txt->checkpoints);
+            memmove(txt->checkpoints + lo + 1, txt->checkpoints + lo, (count - 1 - lo) * sizeof(TextCheckpoint));
+            txt->checkpoints[lo++] = at;
+            next = at.index + TEXT_CHECKPOINT_BYTES;
         }
-        col++;
     }
+    return at;
+}
+
+// checkpoints before the edit stay, the ones after it on the lines it changed can't be counted from
+// any more and the ones on later lines move with their bytes. the line offsets are still the old ones
+static void text_shift_checkpoints(Text* txt, isize index, isize removed, isize inserted) {
+    isize count = arrlist_count(txt->checkpoints);
+    if (count == 0) return;
+    isize line = text_line_of(txt, index + removed);
+    isize end = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : ISIZE_MAX;
+    isize from = text_checkpoint_search(txt, index + 1);
+    isize to = text_checkpoint_search(txt, end);
+    memmove(txt->checkpoints + from, txt->checkpoints + to, (count - to) * sizeof(TextCheckpoint));
+    count -= to - from;
+    arrlist_setcount(txt->checkpoints, count);
+    for (isize i = from; i < count; i++) txt->checkpoints[i].index += inserted - removed;
+}
+
+CursorPosition text_get_pos(Text* txt, isize index) {
+    isize line = text_line_of(txt, index);
+    TextCheckpoint at = text_walk_line(txt, line, index, ISIZE_MAX);
     CursorPosition pos = {
-        .col = col,
-        .line = row,
+        .col = at.col,
+        .line = line,
     };
     return pos;
 }
@@ -34,6 +89,26 @@ isize text_get_row(Text* txt, isize index) {
     }
     return count;
 }
+isize text_line_of(Text* txt, isize index) {
+    isize lo = 0, hi = arrlist_count(txt->line_offsets);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (txt->line_offsets[mid] <= index) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+String text_line_string(Text* txt, isize line, StringBuilder* scratch) {
+    isize begin = line > 0 ? txt->line_offsets[line - 1] : 0;
+    isize end = line < arrlist_count(txt->line_offsets) ? txt->line_offsets[line] : gapbuf_count(&txt->gapbuf);
+    GapBufSlice bytes = gapbuf_slice(&txt->gapbuf, begin, end);
+    if (bytes.r.count == 0) return bytes.l;
+    if (bytes.l.count == 0) return bytes.r;
+    string_clear(scratch);
+    string_append_string(scratch, bytes.l);
+    string_append_string(scratch, bytes.r);
+    return string_build(*scratch);
+}
 void text_cursor_move(Text* txt, isize n) {
     if (txt->gapbuf.gap_end + n > txt->gapbuf.capacity) {\
         n = txt->gapbuf.capacity - txt->gapbuf.gap_end;
@@ -99,23 +174,7 @@ void text_cursor_move_to_selected(Text* txt, bool front) {
 isize text_index(Text* txt, isize col, isize row) {
     if (row < 0) row = 0;
     if (row > arrlist_count(txt->line_offsets)) row = arrlist_count(txt->line_offsets);
-    isize index = row == 0 ? 0 : txt->line_offsets[row - 1];
-    GapBufSlice strings = gapbuf_getstrings(&txt->gapbuf);
-
-    isize curr_col = 0;
-    while (curr_col < col) {
-        if (index < strings.l.count) {
-            if (strings.l.data[index] == '\n') break;
-            index = string_iterate(strings.l, index);
-        } else if (index < strings.l.count + strings.r.count) {
-            if (strings.r.data[index - strings.l.count] == '\n') break;
-            index = string_iterate(strings.r, index - strings.l.count) + strings.l.count;
-        } else {
-            break;
-        }
-        curr_col++;
-    }
-    return index;
+    return text_walk_line(txt, row, ISIZE_MAX, col).index;
 }
 
 void text_cursor_moveto(Text* txt, isize col, isize row) {
@@ -157,12 +216,63 @@ isize text_cursor_idx(Text* txt) {
     return txt->gapbuf.gap_begin;
 }
 
+void text_add_listener(Text* txt, TextListener listener) {
+    arrlist_append(txt->listeners, listener);
+}
+void text_remove_listener(Text* txt, void* data) {
+    for (isize i = arrlist_count(txt->listeners) - 1; i >= 0; i--) {
+        if (txt->listeners[i].data == data) arrlist_remove(txt->listeners, i);
+    }
+}
+// a cursor that starts inside another's selection, or where another starts, can't be edited apart from it
+static bool text_cursors_overlap(TextCursor first, TextCursor second) {
+    return TEXT_CURSOR_LO(second) < TEXT_CURSOR_HI(first) || TEXT_CURSOR_LO(second) == TEXT_CURSOR_LO(first);
+}
+static void text_merge_cursors(Text* txt) {
+    isize kept = 0;
+    for (isize i = 0; i < arrlist_count(txt->cursors); i++) {
+        TextCursor cursor = txt->cursors[i];
+        if (kept > 0 && text_cursors_overlap(txt->cursors[kept - 1], cursor)) {
+            TextCursor* previous = &txt->cursors[kept - 1];
+            isize hi = TEXT_CURSOR_HI(*previous) > TEXT_CURSOR_HI(cursor) ? TEXT_CURSOR_HI(*previous) : TEXT_CURSOR_HI(cursor);
+            *previous = (TextCursor){TEXT_CURSOR_LO(*previous), hi};
+            continue;
+        }
+        txt->cursors[kept++] = cursor;
+    }
+    if (txt->cursors) arrlist_setcount(txt->cursors, kept);
+}
+
+// where a position ends up after an edit, inside the removed bytes is after what replaced them
+static isize text_shift_index(isize at, isize index, isize removed, isize inserted) {
+    if (at >= index + removed) return at + inserted - removed;
+    if (at > index) return index + inserted;
+    return at;
+}
+
+static void text_notify(Text* txt, isize index, isize removed, isize inserted) {
+    txt->version++;
+    text_shift_checkpoints(txt, index, removed, inserted);
+    txt->selection_begin = text_shift_index(txt->selection_begin, index, removed, inserted);
+    txt->selection_end = text_shift_index(txt->selection_end, index, removed, inserted);
+    for (isize i = 0; i < arrlist_count(txt->cursors); i++) {
+        TextCursor* cursor = &txt->cursors[i];
+        cursor->anchor = text_shift_index(cursor->anchor, index, removed, inserted);
+        cursor->head = text_shift_index(cursor->head, index, removed, inserted);
+    }
+    text_merge_cursors(txt);
+    for (isize i = 0; i < arrlist_count(txt->listeners); i++) {
+        txt->listeners[i].on_edit(txt->listeners[i].data, txt, (TextEdit){index, removed, inserted});
+    }
+}
+
 void text_cursor_insert(Text* txt, String insert) {
     text_delete_selection(txt);
 
     text_add_transaction(txt, insert, false);
 
     gapbuf_insertn(&txt->gapbuf, insert.data, insert.count);
+    text_notify(txt, text_cursor_idx(txt) - insert.count, 0, insert.count);
 
     text_update_line_offsets(txt);
     text_cursor_update_position(txt);
@@ -176,6 +286,7 @@ void text_cursor_remove_before(Text* txt, isize n) {
     text_cursor_move_codepoints(txt, -n);
     isize l = text_cursor_idx(txt);
     String removed = gapbuf_removen_after(&txt->gapbuf, r - l);
+    text_notify(txt, l, r - l, 0);
     
     text_add_transaction(txt, removed, true);
 
@@ -194,6 +305,7 @@ void text_cursor_remove_after(Text* txt, isize n) {
         text_cursor_move_codepoints(txt, -n); 
     }
     String removed = gapbuf_removen_after(&txt->gapbuf, r - l);
+    text_notify(txt, l, r - l, 0);
     
     text_add_transaction(txt, removed, true);
 
@@ -201,6 +313,7 @@ void text_cursor_remove_after(Text* txt, isize n) {
     text_cursor_update_position(txt);
 }
 void text_update_line_offsets(Text* txt) {
+    PROFILE_BEGIN("text_update_line_offsets");
     //arrlist_print(txt->line_offsets, "%lld", ",");
     arrlist_setcount(txt->line_offsets, 0);
 
@@ -214,11 +327,392 @@ void text_update_line_offsets(Text* txt) {
         index++;
         if (strings.r.data[i] == '\n') arrlist_append(txt->line_offsets, index);
     }
+    PROFILE_END("text_update_line_offsets");
 }
 void text_cursor_update_position(Text* txt) {
+    PROFILE_BEGIN("text_cursor_update_position");
     CursorPosition pos = text_get_pos(txt, text_cursor_idx(txt));
     txt->cursor_col = pos.col;
     txt->cursor_line = pos.line;
+    PROFILE_END("text_cursor_update_position");
+}
+
+// a range of the current text and what it is replaced with
+typedef struct TextSplice {
+    isize begin;
+    isize end;
+    String with;
+} TextSplice;
+
+// applies every splice (sorted, not overlapping) in one sweep of the gap from the first to the
+// last, the bytes in between are moved once and the line index is built once. listeners hear
+// about a single edit from the first splice to the last. selections and extra cursors are dropped
+static void text_splice(Text* txt, const TextSplice* splices, isize count) {
+    if (count == 0) return;
+    GapBuffer* gapbuf = &txt->gapbuf;
+    // the gap has to hold the most the text grows by at any point of the sweep
+    isize growth = 0;
+    isize most = 0;
+    for (isize i = 0; i < count; i++) {
+        growth += splices[i].with.count - (splices[i].end - splices[i].begin);
+        if (growth > most) most = growth;
+    }
+    if (gapbuf_gaplen(gapbuf) < most) gapbuf_expand(gapbuf, most - gapbuf_gaplen(gapbuf));
+
+    isize shift = 0;
+    for (isize i = 0; i < count; i++) {
+        gapbuf_movegap_rel(gapbuf, splices[i].begin + shift - gapbuf->gap_begin);
+        gapbuf->gap_end += splices[i].end - splices[i].begin;
+        if (splices[i].with.count > 0) memcpy(gapbuf->data + gapbuf->gap_begin, splices[i].with.data, splices[i].with.count);
+        gapbuf->gap_begin += splices[i].with.count;
+        shift += splices[i].with.count - (splices[i].end - splices[i].begin);
+    }
+
+    txt->selected = false;
+    arrlist_free(txt->cursors);
+    isize begin = splices[0].begin;
+    isize end = splices[count - 1].end;
+    text_notify(txt, begin, end - begin, end + shift - begin);
+    text_update_line_offsets(txt);
+}
+
+// the record is one string so it lives in the undo arena like any other transaction:
+// the header, where each match began in the text before, how long it was there, then the
+// replacement followed by all of the replaced bytes. when every splice has its own replacement
+// their lengths come before the replacements, which are one after the other
+typedef struct ReplaceRecord {
+    isize count;
+    isize replacement_count; // of all the replacements together when they're distinct
+    bool distinct;
+} ReplaceRecord;
+
+static void text_apply_replace_record(Text* txt, String record, bool undo) {
+    ReplaceRecord header;
+    memcpy(&header, record.data, sizeof(header));
+    const char* begins = record.data + sizeof(header);
+    const char* lengths = begins + header.count * sizeof(isize);
+    const char* inserted_lengths = lengths + header.count * sizeof(isize);
+    const char* replacements = header.distinct ? inserted_lengths + header.count * sizeof(isize) : inserted_lengths;
+    const char* removed = replacements + header.replacement_count;
+
+    if (header.count == 0) return;
+    TextSplice* splices = malloc(header.count * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize shift = 0; // how far the matches so far moved the text after them
+    String replacement = {replacements, header.replacement_count};
+    for (isize i = 0; i < header.count; i++) {
+        isize begin, length;
+        memcpy(&begin, begins + i * sizeof(isize), sizeof(isize));
+        memcpy(&length, lengths + i * sizeof(isize), sizeof(isize));
+        if (header.distinct) {
+            if (i > 0) replacement.data += replacement.count;
+            memcpy(&replacement.count, inserted_lengths + i * sizeof(isize), sizeof(isize));
+        }
+        if (undo) {
+            splices[i] = (TextSplice){begin + shift, begin + shift + replacement.count, {removed, length}};
+        } else {
+            splices[i] = (TextSplice){begin, begin + length, replacement};
+        }
+        removed += length;
+        shift += replacement.count - length;
+    }
+    text_splice(txt, splices, header.count);
+    free(splices);
+}
+
+// records the splices as a single command, the replacement is only stored once when they all share it
+static void text_record_splices(Text* txt, const TextSplice* splices, isize kept) {
+    bool distinct = false;
+    isize replacement_count = 0;
+    for (isize i = 0; i < kept; i++) {
+        distinct |= splices[i].with.data != splices[0].with.data || splices[i].with.count != splices[0].with.count;
+        replacement_count += splices[i].with.count;
+    }
+    if (!distinct) replacement_count = splices[0].with.count;
+
+    StringBuilder record = {0};
+    ReplaceRecord header = {kept, replacement_count, distinct};
+    string_append_string(&record, (String){(const char*)&header, sizeof(header)});
+    for (isize i = 0; i < kept; i++) string_append_string(&record, (String){(const char*)&splices[i].begin, sizeof(isize)});
+    for (isize i = 0; i < kept; i++) {
+        isize length = splices[i].end - splices[i].begin;
+        string_append_string(&record, (String){(const char*)&length, sizeof(isize)});
+    }
+    if (distinct) {
+        for (isize i = 0; i < kept; i++) string_append_string(&record, (String){(const char*)&splices[i].with.count, sizeof(isize)});
+        for (isize i = 0; i < kept; i++) string_append_string(&record, splices[i].with);
+    } else {
+        string_append_string(&record, splices[0].with);
+    }
+    for (isize i = 0; i < kept; i++) {
+        GapBufSlice replaced = gapbuf_slice(&txt->gapbuf, splices[i].begin, splices[i].end);
+        string_append_string(&record, replaced.l);
+        string_append_string(&record, replaced.r);
+    }
+
+    text_begin_command(txt);
+    append_transaction(&txt->commands, (Transaction){
+        .col = txt->cursor_col,
+        .line = txt->cursor_line,
+        .modified = arena_string_dup(&txt->commands.string_stack, string_build(record)),
+        .replaced_all = true,
+    });
+    text_end_command(txt);
+    string_free(&record);
+}
+
+isize text_replace_all(Text* txt, const TextRange* ranges, isize count, String replacement) {
+    if (count == 0) return 0;
+    PROFILE_BEGIN("text_replace_all");
+    TextSplice* splices = malloc(count * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize kept = 0;
+    for (isize i = 0; i < count; i++) {
+        if (kept > 0 && ranges[i].begin < splices[kept - 1].end) continue;
+        splices[kept++] = (TextSplice){ranges[i].begin, ranges[i].end, replacement};
+    }
+    if (kept == 0) {
+        free(splices);
+        PROFILE_END("text_replace_all");
+        return 0;
+    }
+
+    // the cursor follows the text it was in, the splices are one edit to the listeners so it's
+    // moved through each of them here
+    isize cursor = text_cursor_idx(txt);
+    isize shift = 0;
+    for (isize i = 0; i < kept; i++) {
+        cursor = text_shift_index(cursor, splices[i].begin + shift, splices[i].end - splices[i].begin, splices[i].with.count);
+        shift += splices[i].with.count - (splices[i].end - splices[i].begin);
+    }
+    text_record_splices(txt, splices, kept);
+    text_splice(txt, splices, kept);
+    free(splices);
+    text_cursor_move(txt, cursor - text_cursor_idx(txt));
+    text_cursor_update_position(txt);
+    PROFILE_END("text_replace_all");
+    return kept;
+}
+
+void text_add_cursor(Text* txt, isize anchor, isize head) {
+    TextCursor cursor = {anchor, head};
+    // cursors are mostly added in order so this is usually an append
+    isize count = arrlist_count(txt->cursors);
+    isize at = count;
+    while (at > 0 && TEXT_CURSOR_LO(txt->cursors[at - 1]) > TEXT_CURSOR_LO(cursor)) at--;
+    arrlist_append(txt->cursors, cursor);
+    memmove(txt->cursors + at + 1, txt->cursors + at, (count - at) * sizeof(TextCursor));
+    txt->cursors[at] = cursor;
+    bool overlaps = (at > 0 && text_cursors_overlap(txt->cursors[at - 1], cursor))
+        || (at < count && text_cursors_overlap(cursor, txt->cursors[at + 1]));
+    if (overlaps) text_merge_cursors(txt);
+}
+
+void text_clear_cursors(Text* txt) {
+    arrlist_free(txt->cursors);
+}
+
+// the position a codepoint after (or before) index, utf8 continuation bytes are stepped over
+static isize text_step_codepoint(GapBuffer* gapbuf, isize index, bool forwards) {
+    isize count = gapbuf_count(gapbuf);
+    if (forwards) {
+        if (index >= count) return count;
+        index++;
+        while (index < count && ((u8)gapbuf_get(gapbuf, index) & 0xc0) == 0x80) index++;
+    } else {
+        if (index <= 0) return 0;
+        index--;
+        while (index > 0 && ((u8)gapbuf_get(gapbuf, index) & 0xc0) == 0x80) index--;
+    }
+    return index;
+}
+
+// every cursor's selection in order with the gap's cursor among them, primary is set to which one
+// that is
+static isize text_cursor_splices(Text* txt, TextSplice* splices, isize* primary) {
+    isize lo = text_cursor_idx(txt);
+    isize hi = lo;
+    if (txt->selected) {
+        lo = txt->selection_begin < txt->selection_end ? txt->selection_begin : txt->selection_end;
+        hi = txt->selection_begin < txt->selection_end ? txt->selection_end : txt->selection_begin;
+    }
+    isize count = arrlist_count(txt->cursors);
+    isize n = 0;
+    *primary = -1;
+    for (isize i = 0; i <= count; i++) {
+        TextCursor cursor = i < count ? txt->cursors[i] : (TextCursor){0};
+        bool after = i == count || TEXT_CURSOR_LO(cursor) > lo || (TEXT_CURSOR_LO(cursor) == lo && TEXT_CURSOR_HI(cursor) >= hi);
+        if (*primary < 0 && after) {
+            *primary = n;
+            splices[n++] = (TextSplice){lo, hi};
+        }
+        if (i < count) splices[n++] = (TextSplice){TEXT_CURSOR_LO(cursor), TEXT_CURSOR_HI(cursor)};
+    }
+    return n;
+}
+// joins splices that overlap, a caret stepped back over a codepoint can reach into the one before
+static isize text_join_splices(TextSplice* splices, isize count, isize* primary) {
+    isize kept = 0;
+    for (isize i = 0; i < count; i++) {
+        TextSplice* previous = kept > 0 ? &splices[kept - 1] : NULL;
+        if (previous && (splices[i].begin < previous->end || splices[i].begin == previous->begin)) {
+            if (splices[i].begin < previous->begin) previous->begin = splices[i].begin;
+            if (splices[i].end > previous->end) previous->end = splices[i].end;
+            if (*primary == i) *primary = kept - 1;
+            continue;
+        }
+        if (*primary == i) *primary = kept;
+        splices[kept++] = splices[i];
+    }
+    return kept;
+}
+
+// swaps every splice for what it's given as one command, then puts a cursor after each insert
+static void text_cursors_apply(Text* txt, TextSplice* splices, isize count, isize primary) {
+    isize changed = 0;
+    for (isize i = 0; i < count; i++) changed += splices[i].end - splices[i].begin + splices[i].with.count;
+    if (changed == 0) return;
+
+    text_record_splices(txt, splices, count);
+    text_splice(txt, splices, count);
+    isize shift = 0;
+    isize head = 0;
+    for (isize i = 0; i < count; i++) {
+        isize at = splices[i].begin + shift + splices[i].with.count;
+        shift += splices[i].with.count - (splices[i].end - splices[i].begin);
+        if (i == primary) head = at;
+        else arrlist_append(txt->cursors, ((TextCursor){at, at}));
+    }
+    // removals can leave cursors on top of each other
+    text_merge_cursors(txt);
+    isize count_left = arrlist_count(txt->cursors);
+    for (isize i = 0; i < count_left; i++) {
+        if (txt->cursors[i].head != head) continue;
+        memmove(txt->cursors + i, txt->cursors + i + 1, (count_left - i - 1) * sizeof(TextCursor));
+        arrlist_setcount(txt->cursors, count_left - 1);
+        break;
+    }
+    text_cursor_move(txt, head - text_cursor_idx(txt));
+    text_cursor_update_position(txt);
+}
+
+void text_cursors_insert(Text* txt, String insert) {
+    PROFILE_BEGIN("text_cursors_insert");
+    TextSplice* splices = malloc((arrlist_count(txt->cursors) + 1) * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize primary;
+    isize count = text_cursor_splices(txt, splices, &primary);
+    count = text_join_splices(splices, count, &primary);
+    for (isize i = 0; i < count; i++) splices[i].with = insert;
+    text_cursors_apply(txt, splices, count, primary);
+    free(splices);
+    PROFILE_END("text_cursors_insert");
+}
+
+void text_cursors_remove(Text* txt, bool forwards) {
+    PROFILE_BEGIN("text_cursors_remove");
+    TextSplice* splices = malloc((arrlist_count(txt->cursors) + 1) * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize primary;
+    isize count = text_cursor_splices(txt, splices, &primary);
+    for (isize i = 0; i < count; i++) {
+        if (splices[i].begin != splices[i].end) continue;
+        if (forwards) splices[i].end = text_step_codepoint(&txt->gapbuf, splices[i].end, true);
+        else splices[i].begin = text_step_codepoint(&txt->gapbuf, splices[i].begin, false);
+    }
+    count = text_join_splices(splices, count, &primary);
+    for (isize i = 0; i < count; i++) splices[i].with = (String){0};
+    text_cursors_apply(txt, splices, count, primary);
+    free(splices);
+    PROFILE_END("text_cursors_remove");
+}
+
+// the clipboard text goes one line to each cursor when it has a line for every one of them, which
+// is how a copied block comes back. anything else is inserted whole at every cursor
+void text_cursors_paste(Text* txt, String text) {
+    PROFILE_BEGIN("text_cursors_paste");
+    TextSplice* splices = malloc((arrlist_count(txt->cursors) + 1) * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize primary;
+    isize count = text_cursor_splices(txt, splices, &primary);
+    count = text_join_splices(splices, count, &primary);
+    isize lines = 1;
+    for (isize i = 0; i < text.count; i++) lines += text.data[i] == '\n';
+    if (lines == count && count > 1) {
+        isize begin = 0;
+        for (isize i = 0; i < count; i++) {
+            isize end = begin;
+            while (end < text.count && text.data[end] != '\n') end++;
+            splices[i].with = (String){text.data + begin, end - begin};
+            begin = end + 1;
+        }
+    } else {
+        for (isize i = 0; i < count; i++) splices[i].with = text;
+    }
+    text_cursors_apply(txt, splices, count, primary);
+    free(splices);
+    PROFILE_END("text_cursors_paste");
+}
+
+// every cursor's selection in order, one line each
+void text_cursors_copy(Text* txt) {
+    TextSplice* splices = malloc((arrlist_count(txt->cursors) + 1) * sizeof(TextSplice));
+    assert(splices && "malloc failed");
+    isize primary;
+    isize count = text_cursor_splices(txt, splices, &primary);
+    StringBuilder copied = {0};
+    for (isize i = 0; i < count; i++) {
+        if (i > 0) string_append_byte(&copied, '\n');
+        GapBufSlice slice = gapbuf_slice(&txt->gapbuf, splices[i].begin, splices[i].end);
+        string_append_string(&copied, slice.l);
+        string_append_string(&copied, slice.r);
+    }
+    string_append_byte(&copied, '\0');
+    if (txt->set_clipboard) txt->set_clipboard(copied.data);
+    string_free(&copied);
+    free(splices);
+}
+
+// the columns are found from the line index, the walk only covers the columns of each line so
+// a block over any number of lines is set up in one pass
+void text_select_block(Text* txt, isize anchor_line, isize anchor_col, isize head_line, isize head_col) {
+    PROFILE_BEGIN("text_select_block");
+    isize last_line = arrlist_count(txt->line_offsets);
+    if (anchor_line > last_line) anchor_line = last_line;
+    if (head_line > last_line) head_line = last_line;
+    isize first = anchor_line < head_line ? anchor_line : head_line;
+    isize last = anchor_line < head_line ? head_line : anchor_line;
+    arrlist_setcount(txt->cursors, 0);
+    isize head_anchor = 0, head = 0;
+    for (isize line = first; line <= last; line++) {
+        isize anchor = text_index(txt, anchor_col, line);
+        isize at = head_col == anchor_col ? anchor : text_index(txt, head_col, line);
+        if (line == head_line) {
+            head_anchor = anchor;
+            head = at;
+        } else {
+            arrlist_append(txt->cursors, ((TextCursor){anchor, at}));
+        }
+    }
+    txt->selected = false;
+    text_cursor_move(txt, head - text_cursor_idx(txt));
+    text_cursor_update_position(txt);
+    if (head_anchor != head) text_select_range(txt, head_anchor, head);
+    PROFILE_END("text_select_block");
+}
+
+void text_cursors_move_codepoints(Text* txt, isize n) {
+    for (isize i = 0; i < arrlist_count(txt->cursors); i++) {
+        TextCursor cursor = txt->cursors[i];
+        isize at = cursor.head;
+        if (cursor.anchor != cursor.head) {
+            at = n < 0 ? TEXT_CURSOR_LO(cursor) : TEXT_CURSOR_HI(cursor);
+        } else {
+            for (isize step = 0; step < (n < 0 ? -n : n); step++) at = text_step_codepoint(&txt->gapbuf, at, n > 0);
+        }
+        txt->cursors[i] = (TextCursor){at, at};
+    }
+    text_merge_cursors(txt);
 }
 
 void text_delete_selection(Text* txt) {
@@ -235,6 +729,7 @@ void text_delete_selection(Text* txt) {
     text_cursor_move(txt, l - text_cursor_idx(txt));
     gapbuf_removen_after(&txt->gapbuf, r - l);
     txt->selection_begin = l;
+    text_notify(txt, l, r - l, 0);
 
     text_update_line_offsets(txt);
     text_cursor_update_position(txt);
@@ -257,7 +752,7 @@ void text_copy_selection_to_clipboard(Text* txt) {
     memcpy(buffer + slice.l.count, slice.r.data, slice.r.count);
     buffer[count] = '\0';
 
-    SetClipboardText(buffer);
+    if (txt->set_clipboard) txt->set_clipboard(buffer);
     free(buffer);
 }
 
@@ -274,6 +769,14 @@ void text_select_begin(Text* txt) {
 void text_select_end(Text* txt) {
     txt->selection_end = text_index(txt, txt->cursor_col, txt->cursor_line);
 }
+// selects the bytes from begin to end and puts the cursor at the end of the selection
+void text_select_range(Text* txt, isize begin, isize end) {
+    text_cursor_move(txt, end - text_cursor_idx(txt));
+    text_cursor_update_position(txt);
+    txt->selected = true;
+    txt->selection_begin = begin;
+    txt->selection_end = end;
+}
 
 GapBufSlice text_selected_string(Text* txt) {
     isize l, r;
@@ -296,9 +799,13 @@ void text_save_file(Text* txt) {
     text_cursor_update_position(txt);
 }
 void text_load_file(Text* txt, const char* filename) {
+    isize old_count = gapbuf_count(&txt->gapbuf);
     gapbuf_read_entire_file(&txt->gapbuf, filename);
+    text_notify(txt, 0, old_count, gapbuf_count(&txt->gapbuf));
     string_clear(&txt->filename);
     string_append_string(&txt->filename, string_from_cstring(filename));
+    text_update_line_offsets(txt);
+    text_cursor_update_position(txt);
 }
 void text_prompt_filename(StringBuilder* sb) {
     string_clear(sb);
@@ -337,11 +844,19 @@ void text_undo(Text* txt) {
     for (isize i = command.count - 1; i >= 0; i--) {
         Transaction transaction = command.data[i];
 
+        if (transaction.replaced_all) {
+            text_apply_replace_record(txt, transaction.modified, true);
+            text_cursor_moveto(txt, transaction.col, transaction.line);
+            continue;
+        }
         text_cursor_moveto(txt, transaction.col, transaction.line);
+        isize index = text_cursor_idx(txt);
         if (transaction.removed) {
             gapbuf_insertn(&txt->gapbuf, transaction.modified.data, transaction.modified.count);
+            text_notify(txt, index, 0, transaction.modified.count);
         } else {
             gapbuf_removen_after(&txt->gapbuf, transaction.modified.count);
+            text_notify(txt, index, transaction.modified.count, 0);
         }
     
         text_update_line_offsets(txt);
@@ -359,11 +874,19 @@ void text_redo(Text* txt) {
     for (isize i = 0; i < command.count; i++) {
         Transaction transaction = command.data[i];
 
+        if (transaction.replaced_all) {
+            text_apply_replace_record(txt, transaction.modified, false);
+            text_cursor_moveto(txt, transaction.col, transaction.line);
+            continue;
+        }
         text_cursor_moveto(txt, transaction.col, transaction.line);
+        isize index = text_cursor_idx(txt);
         if (transaction.removed) {
             gapbuf_removen_after(&txt->gapbuf, transaction.modified.count);
+            text_notify(txt, index, transaction.modified.count, 0);
         } else {
             gapbuf_insertn(&txt->gapbuf, transaction.modified.data, transaction.modified.count);
+            text_notify(txt, index, 0, transaction.modified.count);
         }
     
         text_update_line_offsets(txt);
@@ -3,6 +3,42 @@
 #include "gapbuffer.h"
 #include "undo.h"
 
+typedef struct Text Text;
+
+// a change to the buffer: removed bytes at index were replaced by inserted bytes, listeners
+// are told after the gap buffer changed so they see the new text, but before the line
+// offsets are rebuilt so those still describe the text before the edit
+typedef struct TextEdit {
+    isize index;
+    isize removed;
+    isize inserted;
+} TextEdit;
+
+typedef struct TextRange {
+    isize begin;
+    isize end;
+} TextRange;
+
+// a cursor besides the one at the gap, head is where it is and anchor the other end of its selection
+typedef struct TextCursor {
+    isize anchor;
+    isize head;
+} TextCursor;
+#define TEXT_CURSOR_LO(cursor) ((cursor).anchor < (cursor).head ? (cursor).anchor : (cursor).head)
+#define TEXT_CURSOR_HI(cursor) ((cursor).anchor < (cursor).head ? (cursor).head : (cursor).anchor)
+
+// a codepoint boundary inside a line and how many codepoints of the line come before it. lines are
+// walked from the nearest one so finding a column in a megabyte long line only reads a few KB
+typedef struct TextCheckpoint {
+    isize index;
+    isize col;
+} TextCheckpoint;
+#define TEXT_CHECKPOINT_BYTES 4096
+
+typedef struct TextListener {
+    void (*on_edit)(void* data, Text* txt, TextEdit edit);
+    void* data;
+} TextListener;
 
 typedef struct Text {
     StringBuilder filename;
@@ -10,13 +46,26 @@ typedef struct Text {
     CommandList commands;
 
     isize* line_offsets;
+    TextCheckpoint* checkpoints; // arraylist sorted by index, left every TEXT_CHECKPOINT_BYTES of the lines walked through
 
+    // the cursor is where the gap is so it moves with the text by itself, the selection's ends
+    // are moved by every edit like the extra cursors are
     bool selected;
     isize selection_begin;
     isize selection_end;
 
     isize cursor_col;
     isize cursor_line;
+
+    // arraylist, sorted and never overlapping. they move with every edit, and the edits that act
+    // on all cursors apply to the gap's cursor as well
+    TextCursor* cursors;
+
+    // supplied by the frontend, copying to the clipboard does nothing without it
+    void (*set_clipboard)(const char* text);
+
+    TextListener* listeners; // arraylist, indexes over the text keep themselves up to date through these
+    u64 version;             // counts edits, anything derived from the text can tell it's out of date
 } Text;
 
 typedef struct CursorPosition {
@@ -26,6 +75,10 @@ typedef struct CursorPosition {
 
 CursorPosition text_get_pos(Text* txt, isize index);
 isize text_get_row(Text* txt, isize index);
+// the line index is on, a binary search over the line offsets
+isize text_line_of(Text* txt, isize index);
+// the bytes of a line including its newline, copied into scratch only when the line straddles the gap
+String text_line_string(Text* txt, isize line, StringBuilder* scratch);
 isize text_index(Text* txt, isize col, isize line);
 
 isize text_cursor_idx(Text* txt);
@@ -42,6 +95,30 @@ void text_cursor_insert(Text* txt, String insert);
 void text_cursor_remove_before(Text* txt, isize n);
 void text_cursor_remove_after(Text* txt, isize n);
 
+// adds a cursor selecting from anchor to head, it's merged with any cursor it overlaps
+void text_add_cursor(Text* txt, isize anchor, isize head);
+void text_clear_cursors(Text* txt);
+// these edit at the gap's cursor and every other one in a single sweep of the gap through the
+// buffer, listeners hear about one edit from the first cursor to the last and it's undone as
+// one command. undoing it leaves just the gap's cursor
+// replaces every cursor's selection, or inserts where there isn't one
+void text_cursors_insert(Text* txt, String insert);
+// removes every cursor's selection, or the codepoint before it (after it when forwards) where there isn't one
+void text_cursors_remove(Text* txt, bool forwards);
+// inserts a line of text at each cursor when it has as many lines as there are cursors, like
+// text_cursors_insert otherwise
+void text_cursors_paste(Text* txt, String text);
+// puts every cursor's selection on the clipboard, one per line
+void text_cursors_copy(Text* txt);
+// moves the cursors besides the gap's one by n codepoints, selections collapse to the side moved towards
+void text_cursors_move_codepoints(Text* txt, isize n);
+// a rectangle: a cursor on every line from anchor_line to head_line selecting from anchor_col to
+// head_col, or up to the end of lines too short for them. the gap's cursor is the one on head_line
+void text_select_block(Text* txt, isize anchor_line, isize anchor_col, isize head_line, isize head_col);
+
+void text_add_listener(Text* txt, TextListener listener);
+void text_remove_listener(Text* txt, void* data);
+
 void text_add_transaction(Text* txt, String modified, bool removed);
 void text_begin_command(Text* txt);
 void text_end_command(Text* txt);
@@ -52,12 +129,18 @@ void text_redo(Text* txt);
 void text_update_line_offsets(Text* txt);
 void text_cursor_update_position(Text* txt);
 
+// replaces every range (sorted by begin, ones overlapping the previous range are skipped) with
+// replacement in place, sweeping the gap through the buffer once from the first range to the last.
+// undone and redone as a single command, returns how many ranges were replaced
+isize text_replace_all(Text* txt, const TextRange* ranges, isize count, String replacement);
+
 void text_delete_selection(Text* txt);
 void text_copy_selection_to_clipboard(Text* txt);
 void text_copy_and_delete_selection_to_clipboard(Text* txt);
 
 void text_select_begin(Text* txt);
 void text_select_end(Text* txt);
+void text_select_range(Text* txt, isize begin, isize end);
 GapBufSlice text_selected_string(Text* txt);
 
 void text_save_file(Text* txt);
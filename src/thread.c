@@ -0,0 +1,202 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // sysconf
+#endif
+#include "thread.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// the platforms want different signatures so every thread starts here
+typedef struct ThreadStart {
+    ThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+static ThreadStart* thread_start_alloc(ThreadFn fn, void* arg) {
+    ThreadStart* start = malloc(sizeof(ThreadStart));
+    assert(start && "malloc failed");
+    *start = (ThreadStart){fn, arg};
+    return start;
+}
+
+#ifdef _WIN32
+#include <windows.h>
+
+static DWORD WINAPI thread_main(LPVOID param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    PROFILE_THREAD_EXIT();
+    return 0;
+}
+
+bool thread_start(Thread* thread, ThreadFn fn, void* arg) {
+    ThreadStart* start = thread_start_alloc(fn, arg);
+    *thread = CreateThread(NULL, 0, thread_main, start, 0, NULL);
+    if (*thread == NULL) free(start);
+    return *thread != NULL;
+}
+
+void thread_join(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void thread_yield(void) {
+    SwitchToThread();
+}
+
+isize thread_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+typedef SRWLOCK WorkerLock;
+typedef CONDITION_VARIABLE WorkerSignal;
+
+static void worker_sync_init(WorkerLock* lock, WorkerSignal* signal) {
+    InitializeSRWLock(lock);
+    InitializeConditionVariable(signal);
+}
+static void worker_sync_free(WorkerLock* lock, WorkerSignal* signal) {
+    (void)lock;
+    (void)signal;
+}
+static void worker_lock(WorkerLock* lock) {
+    AcquireSRWLockExclusive(lock);
+}
+static void worker_unlock(WorkerLock* lock) {
+    ReleaseSRWLockExclusive(lock);
+}
+static void worker_wait(WorkerSignal* signal, WorkerLock* lock) {
+    SleepConditionVariableSRW(signal, lock, INFINITE, 0);
+}
+static void worker_wake(WorkerSignal* signal) {
+    WakeConditionVariable(signal);
+}
+#else
+#include <unistd.h>
+#include <sched.h>
+
+static void* thread_main(void* param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    PROFILE_THREAD_EXIT();
+    return NULL;
+}
+
+bool thread_start(Thread* thread, ThreadFn fn, void* arg) {
+    ThreadStart* start = thread_start_alloc(fn, arg);
+    if (pthread_create(thread, NULL, thread_main, start) != 0) {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+void thread_join(Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+void thread_yield(void) {
+    sched_yield();
+}
+
+isize thread_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+}
+
+typedef pthread_mutex_t WorkerLock;
+typedef pthread_cond_t WorkerSignal;
+
+static void worker_sync_init(WorkerLock* lock, WorkerSignal* signal) {
+    pthread_mutex_init(lock, NULL);
+    pthread_cond_init(signal, NULL);
+}
+static void worker_sync_free(WorkerLock* lock, WorkerSignal* signal) {
+    pthread_mutex_destroy(lock);
+    pthread_cond_destroy(signal);
+}
+static void worker_lock(WorkerLock* lock) {
+    pthread_mutex_lock(lock);
+}
+static void worker_unlock(WorkerLock* lock) {
+    pthread_mutex_unlock(lock);
+}
+static void worker_wait(WorkerSignal* signal, WorkerLock* lock) {
+    pthread_cond_wait(signal, lock);
+}
+static void worker_wake(WorkerSignal* signal) {
+    pthread_cond_signal(signal);
+}
+#endif
+
+struct Worker {
+    Thread thread;
+    WorkerLock lock;
+    WorkerSignal signal;
+    ThreadFn release;
+    // the task waiting to run, fn is NULL when there's none
+    ThreadFn fn;
+    void* arg;
+    bool stopping;
+};
+
+static void worker_main(void* arg) {
+    Worker* worker = arg;
+    worker_lock(&worker->lock);
+    for (;;) {
+        while (worker->fn == NULL && !worker->stopping) worker_wait(&worker->signal, &worker->lock);
+        if (worker->fn == NULL) break;
+        ThreadFn fn = worker->fn;
+        void* task = worker->arg;
+        worker->fn = NULL;
+        worker_unlock(&worker->lock);
+        fn(task);
+        if (worker->release) worker->release(task);
+        worker_lock(&worker->lock);
+    }
+    worker_unlock(&worker->lock);
+}
+
+Worker* worker_start(ThreadFn release) {
+    Worker* worker = calloc(1, sizeof(Worker));
+    assert(worker && "calloc failed");
+    worker_sync_init(&worker->lock, &worker->signal);
+    worker->release = release;
+    if (!thread_start(&worker->thread, worker_main, worker)) {
+        worker_sync_free(&worker->lock, &worker->signal);
+        free(worker);
+        return NULL;
+    }
+    return worker;
+}
+
+void worker_post(Worker* worker, ThreadFn fn, void* arg) {
+    worker_lock(&worker->lock);
+    ThreadFn replaced = worker->fn;
+    void* replaced_arg = worker->arg;
+    worker->fn = fn;
+    worker->arg = arg;
+    worker_wake(&worker->signal);
+    worker_unlock(&worker->lock);
+    if (replaced && worker->release) worker->release(replaced_arg);
+}
+
+void worker_stop(Worker* worker) {
+    if (worker == NULL) return;
+    worker_lock(&worker->lock);
+    ThreadFn replaced = worker->fn;
+    void* replaced_arg = worker->arg;
+    worker->fn = NULL;
+    worker->stopping = true;
+    worker_wake(&worker->signal);
+    worker_unlock(&worker->lock);
+    if (replaced && worker->release) worker->release(replaced_arg);
+    thread_join(worker->thread);
+    worker_sync_free(&worker->lock, &worker->signal);
+    free(worker);
+}
@@ -0,0 +1,39 @@
+#ifndef THREAD_H_
+#define THREAD_H_
+
+#include "short_types.h"
+
+// thin wrapper over win32 threads and pthreads, just enough to fan work out to the cores and wait for it
+
+#ifdef _WIN32
+typedef void* Thread; // HANDLE
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+#endif
+
+typedef void (*ThreadFn)(void* arg);
+
+bool thread_start(Thread* thread, ThreadFn fn, void* arg);
+void thread_join(Thread thread);
+// gives the rest of the time slice to another thread
+void thread_yield(void);
+
+// number of logical cores, at least 1
+isize thread_cpu_count(void);
+
+// a thread kept around for background tasks posted to it one after another, so work started on
+// every keystroke doesn't start a thread on every keystroke. it runs one task at a time and only
+// the newest one posted waits. the worker holds on to the arg of every task posted to it and hands
+// it to release when it's done with it, after the task ran or once a newer one replaced it before
+// it could start
+typedef struct Worker Worker;
+
+// NULL when no thread can be had, the caller does the work itself then
+Worker* worker_start(ThreadFn release);
+void worker_post(Worker* worker, ThreadFn fn, void* arg);
+// the waiting task is released without running, waits for the running one to finish and joins the
+// thread. a task that might run long should be told to stop first
+void worker_stop(Worker* worker);
+
+#endif //THREAD_H_
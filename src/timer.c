@@ -0,0 +1,28 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#endif
+#include "timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+i64 timer_now_ns(void) {
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    // split to avoid overflowing when multiplying the counter by a billion
+    i64 seconds = counter.QuadPart / frequency.QuadPart;
+    i64 remainder = counter.QuadPart % frequency.QuadPart;
+    return seconds * TIMER_NS_PER_S + remainder * TIMER_NS_PER_S / frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+i64 timer_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (i64)ts.tv_sec * TIMER_NS_PER_S + ts.tv_nsec;
+}
+#endif
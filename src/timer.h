@@ -0,0 +1,13 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include "short_types.h"
+
+// monotonic high resolution clock, only differences between two calls are meaningful
+i64 timer_now_ns(void);
+
+#define TIMER_NS_PER_US 1000ll
+#define TIMER_NS_PER_MS 1000000ll
+#define TIMER_NS_PER_S  1000000000ll
+
+#endif //TIMER_H_
@@ -0,0 +1,799 @@
+// micro benchmarks for the buffer and string primitives the editor is built on
+//
+//   bench [--filter name] [--max-size bytes] [--min-time ms] > baseline.tsv
+//   bench --compare baseline.tsv [--threshold percent]
+//
+// results are written to stdout as tab separated lines (name, size, iterations, ns/op, MB/s),
+// progress goes to stderr. with --compare the run is checked against a previous output and
+// exits with 1 if any benchmark got slower than the threshold (default 10%)
+#include "gapbuffer.h"
+#include "stringbuilder.h"
+#include "arena.h"
+#include "arraylist.h"
+#include "search.h"
+#include "regexp.h"
+#include "matchindex.h"
+#include "ahocorasick.h"
+#include "highlight.h"
+#include "brackets.h"
+#include "markers.h"
+#include "minimap.h"
+#include "glyphcache.h"
+#include "thread.h"
+#include "layout.h"
+#include "text.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define KB (1ll << 10)
+#define MB (1ll << 20)
+#define GB (1ll << 30)
+
+// runs the benchmark for iterations ops and returns the nanoseconds taken, setup is not timed
+typedef i64 (*BenchFn)(isize size, i64 iterations);
+
+typedef struct Bench {
+    const char* name;
+    BenchFn fn;
+    isize sizes[16]; // zero terminated
+    bool throughput; // size is the number of bytes each op touches
+} Bench;
+
+typedef struct BenchResult {
+    char name[64];
+    isize size;
+    i64 iterations;
+    f64 ns_per_op;
+} BenchResult;
+
+// xorshift so runs are repeatable without depending on the libc rand
+static u64 rng_state = 0x9E3779B97F4A7C15ull;
+static u64 rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// results are stored here so the compiler can't drop the work
+static volatile i64 sink;
+
+// lowercase words separated by spaces and newlines, roughly what source code looks like to the buffer
+// the first 64KB are random and repeated after that so filling a gigabyte stays quick
+static void fill_text(char* data, isize count) {
+    isize pattern = count < 64*KB ? count : 64*KB;
+    for (isize i = 0; i < pattern; i++) {
+        u64 r = rng_next();
+        if (r % 61 == 0) data[i] = '\n';
+        else if (r % 7 == 0) data[i] = ' ';
+        else data[i] = 'a' + (r >> 8) % 26;
+    }
+    for (isize i = pattern; i < count; i += pattern) {
+        memcpy(data + i, data, count - i < pattern ? count - i : pattern);
+    }
+}
+
+// a buffer holding count bytes of text with the gap of gap bytes in the middle
+static GapBuffer make_gapbuf(isize count, isize gap) {
+    GapBuffer gapbuf = gapbuf_with_cap(count + gap);
+    assert(gapbuf.data && "malloc failed");
+    fill_text(gapbuf.data, count + gap);
+    gapbuf.gap_begin = count / 2;
+    gapbuf.gap_end = count / 2 + gap;
+    return gapbuf;
+}
+
+// GapBuffer
+
+// moves the gap back and forth over size bytes
+static i64 bench_gapbuf_move(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size + 2, 64);
+    gapbuf_movegap(&gapbuf, 0);
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        gapbuf_movegap_rel(&gapbuf, i & 1 ? -size : size);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// types one byte at a random position of a size byte buffer, the gap move dominates on large buffers
+static i64 bench_gapbuf_insert(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size, 4096);
+    isize* positions = malloc(1024 * sizeof(isize));
+    for (isize i = 0; i < 1024; i++) positions[i] = rng_next() % size;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        gapbuf_movegap(&gapbuf, positions[i & 1023]);
+        gapbuf_insert(&gapbuf, 'x');
+        gapbuf_remove(&gapbuf); // keeps the buffer the same size, removing at the gap is free
+    }
+    i64 elapsed = timer_now_ns() - start;
+    free(positions);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// deletes one byte at a random position, the buffer starts with an extra byte for every iteration
+static i64 bench_gapbuf_remove(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size + iterations, 64);
+    isize* positions = malloc(1024 * sizeof(isize));
+    for (isize i = 0; i < 1024; i++) positions[i] = 1 + rng_next() % (size - 1);
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        gapbuf_movegap(&gapbuf, positions[i & 1023]);
+        gapbuf_remove(&gapbuf);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    free(positions);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// pastes a size byte block and takes it out again
+static i64 bench_gapbuf_insertn(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(4096, size);
+    char* block = malloc(size);
+    fill_text(block, size);
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        gapbuf_insertn(&gapbuf, block, size);
+        gapbuf_removen(&gapbuf, size);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    free(block);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// StringBuilder
+
+// a few spare bytes at the end since string_find compares the whole needle near the end of the haystack
+static String make_string(isize size) {
+    String s = {.data = calloc(size + 16, 1), .count = size};
+    fill_text((char*)s.data, size);
+    return s;
+}
+
+// a needle that never matches so the whole haystack is scanned
+static i64 bench_string_find(isize size, i64 iterations) {
+    String haystack = make_string(size);
+    String needle = sl("needle!");
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        found += string_find(haystack, needle, 0);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    assert(found == size * iterations);
+    free((char*)haystack.data);
+    return elapsed;
+}
+
+// the find command's search, the gap sits in the middle and the needle is never found
+static i64 bench_search_find(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size, 64);
+    String needle = sl("needle!");
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        found += search_find(&gapbuf, needle, 0);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    assert(found == -iterations);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// a pattern that never matches, after the first pass every byte is one cached transition
+static i64 bench_regex_find(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size, 64);
+    Regex regex;
+    bool compiled = regex_compile(&regex, sl("(foo|bar)[0-9]+\\(|^#define"));
+    assert(compiled);
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        RegexMatch match;
+        found += regex_find(&regex, &gapbuf, 0, &match);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    assert(found == 0);
+    regex_free(&regex);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// two letters match every few hundred bytes of the random text so there is plenty to merge,
+// sizes from MATCH_INDEX_PARALLEL_MIN up are searched on every core
+static i64 bench_match_index_build(isize size, i64 iterations) {
+    GapBuffer gapbuf = make_gapbuf(size, 64);
+    MatchIndex index = {0};
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        match_index_build(&index, &gapbuf, sl("th"));
+        found += arrlist_count(index.matches);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+    match_index_free(&index);
+    gapbuf_free(&gapbuf);
+    return elapsed;
+}
+
+// five hundred random five letter words, the scan is one table lookup per byte so the pattern
+// count shouldn't show up in the throughput
+static i64 bench_aho_scan(isize size, i64 iterations) {
+    char* data = malloc(size);
+    fill_text(data, size);
+    char words[512][5];
+    String patterns[512];
+    for (isize i = 0; i < 512; i++) {
+        for (isize j = 0; j < 5; j++) words[i][j] = 'a' + rng_next() % 26;
+        patterns[i] = (String){.data = words[i], .count = 5};
+    }
+    AhoCorasick aho;
+    aho_build(&aho, patterns, 512);
+    TextRange* matches = NULL;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        arrlist_setcount(matches, 0);
+        aho_scan(&aho, data, size, &matches);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = arrlist_count(matches);
+    arrlist_free(matches);
+    aho_free(&aho);
+    free(data);
+    return elapsed;
+}
+
+// c source repeated to size, lexed a line at a time with the spans kept like drawing does
+static i64 bench_highlight_lex(isize size, i64 iterations) {
+    String snippet = sl(
+        "#include <stdio.h>\n"
+        "// adds up the numbers\n"
+        "static int sum(const int* values, size_t count) {\n"
+        "    int total = 0; /* running */\n"
+        "    for (size_t i = 0; i < count; i++) total += values[i] * 0x10;\n"
+        "    printf(\"%d\\n\", total);\n"
+        "    return total;\n"
+        "}\n"
+    );
+    char* data = malloc(size);
+    for (isize i = 0; i < size; i += snippet.count) memcpy(data + i, snippet.data, size - i < snippet.count ? size - i : snippet.count);
+    HighlightSpan* spans = NULL;
+    const HighlightLanguage* c = highlight_language_for("bench.c");
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        LexState state = LEX_LINE_START;
+        for (isize line = 0; line < size;) {
+            const char* newline = memchr(data + line, '\n', size - line);
+            isize end = newline ? newline - data + 1 : size;
+            arrlist_setcount(spans, 0);
+            state = highlight_lex_line(c, state, data + line, end - line, &spans);
+            line = end;
+        }
+        sink = arrlist_count(spans) + state;
+    }
+    i64 elapsed = timer_now_ns() - start;
+    arrlist_free(spans);
+    free(data);
+    return elapsed;
+}
+
+// the match of a random opener in c source repeated to size, the lookup should stay a few walks
+// down the tree however much text there is. indexing isn't timed
+static i64 bench_bracket_match(isize size, i64 iterations) {
+    String snippet = sl(
+        "static int sum(const int* values, size_t count) {\n"
+        "    int total = 0; /* ( */\n"
+        "    for (size_t i = 0; i < count; i++) total += values[i];\n"
+        "    return total;\n"
+        "}\n"
+    );
+    StringBuilder source = {0};
+    while (source.count + snippet.count <= size) string_append_string(&source, snippet);
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, string_build(source));
+    text_end_command(&txt);
+    BracketIndex index = {0};
+    bracket_index_attach(&index, &txt, highlight_language_for("bench.c"));
+    isize* openers = NULL;
+    for (isize i = 0; i < source.count; i++) {
+        if (source.data[i] == '(' && bracket_index_match(&index, i) >= 0) arrlist_append(openers, i);
+    }
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        found += bracket_index_match(&index, openers[rng_next() % arrlist_count(openers)]);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+    arrlist_free(openers);
+    bracket_index_free(&index);
+    string_free(&source);
+    return elapsed;
+}
+
+// a column typed into size lines of column aligned data: the block is laid out from the line
+// index and the insert at every line is one sweep and one undo record
+static i64 bench_text_block_insert(isize size, i64 iterations) {
+    StringBuilder rows = {0};
+    for (isize i = 0; i < size; i++) string_append_string(&rows, sl("12345,67890\n"));
+    i64 elapsed = 0;
+    for (i64 i = 0; i < iterations; i++) {
+        Text txt = {0};
+        text_begin_command(&txt);
+        text_cursor_insert(&txt, string_build(rows));
+        text_end_command(&txt);
+
+        i64 start = timer_now_ns();
+        text_select_block(&txt, 0, 5, size - 1, 6);
+        text_cursors_insert(&txt, sl(";"));
+        elapsed += timer_now_ns() - start;
+        sink = gapbuf_count(&txt.gapbuf);
+
+        gapbuf_free(&txt.gapbuf);
+        arrlist_free(txt.line_offsets);
+        arrlist_free(txt.checkpoints);
+        arrlist_free(txt.cursors);
+        reset_command(&txt.commands);
+        free(txt.commands.data);
+        arena_free(&txt.commands.string_stack);
+    }
+    string_free(&rows);
+    return elapsed;
+}
+
+// size markers spread over a 4KB text, one byte typed and taken away again at a random place and
+// a random marker looked up. the text costs the same at every size, the markers should add log n
+static i64 bench_marker_edit(isize size, i64 iterations) {
+    String text = make_string(4*KB);
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, text);
+    text_end_command(&txt);
+    MarkerSet set = {0};
+    marker_set_attach(&set, &txt);
+    Marker* markers = NULL;
+    for (isize i = 0; i < size; i++) arrlist_append(markers, marker_add(&set, rng_next() % text.count));
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    text_begin_command(&txt);
+    for (i64 i = 0; i < iterations; i++) {
+        text_cursor_move(&txt, (isize)(rng_next() % text.count) - text_cursor_idx(&txt));
+        text_cursor_insert(&txt, sl("x"));
+        text_cursor_remove_before(&txt, 1);
+        found += marker_index(&set, markers[rng_next() % size]);
+    }
+    text_end_command(&txt);
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+
+    arrlist_free(markers);
+    marker_set_free(&set);
+    gapbuf_free(&txt.gapbuf);
+    arrlist_free(txt.line_offsets);
+    arrlist_free(txt.checkpoints);
+    arrlist_free(txt.listeners);
+    reset_command(&txt.commands);
+    free(txt.commands.data);
+    arena_free(&txt.commands.string_stack);
+    free((char*)text.data);
+    return elapsed;
+}
+
+// an edit and the worker laying out its row again on a file of size lines
+static i64 bench_minimap_edit(isize size, i64 iterations) {
+    StringBuilder sb = {0};
+    for (isize i = 0; i < size; i++) string_append_string(&sb, sl("    int x = f(y, \"z\"); // w\n"));
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, string_build(sb));
+    text_end_command(&txt);
+    Minimap map = {0};
+    minimap_attach(&map, &txt, highlight_language_for("bench.c"));
+    while (!minimap_poll(&map)) thread_yield();
+    isize ink = 0;
+
+    i64 start = timer_now_ns();
+    text_begin_command(&txt);
+    for (i64 i = 0; i < iterations; i++) {
+        isize line = rng_next() % size;
+        text_cursor_moveto(&txt, 4, line);
+        text_cursor_insert(&txt, sl("x"));
+        while (!minimap_poll(&map)) thread_yield();
+        ink += MINIMAP_INK(minimap_row(&map, line)[1]);
+    }
+    text_end_command(&txt);
+    i64 elapsed = timer_now_ns() - start;
+    sink = ink;
+
+    minimap_free(&map);
+    gapbuf_free(&txt.gapbuf);
+    arrlist_free(txt.line_offsets);
+    arrlist_free(txt.checkpoints);
+    arrlist_free(txt.listeners);
+    reset_command(&txt.commands);
+    free(txt.commands.data);
+    arena_free(&txt.commands.string_stack);
+    string_free(&sb);
+    return elapsed;
+}
+
+// looking up size distinct codepoints a frame at a time, the ones evicted are inserted again
+static i64 bench_glyph_lookup(isize size, i64 iterations) {
+    GlyphCache cache = {0};
+    glyph_cache_init(&cache, GLYPH_PAGE_SIZE, GLYPH_PAGE_MAX);
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        if (i % 1000 == 0) glyph_cache_next_frame(&cache);
+        Codepoint c = 0x4e00 + rng_next() % size;
+        GlyphEntry* glyph = glyph_cache_find(&cache, c);
+        if (glyph == NULL) {
+            i32 cleared;
+            glyph = glyph_cache_insert(&cache, c, 18, 20, &cleared);
+        }
+        found += glyph->x;
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+
+    glyph_cache_free(&cache);
+    return elapsed;
+}
+
+static float bench_advance(void* font, Codepoint c) {
+    return 10.0;
+}
+
+// size lines of 200 bytes that wrap onto 3 rows each, a jump to a random display row and a scroll
+// of a page from there. the rows are only counted once, after that a jump should cost log n
+static i64 bench_wrap_scroll(isize size, i64 iterations) {
+    StringBuilder rows = {0};
+    for (isize i = 0; i < size; i++) {
+        for (isize j = 0; j < 199; j++) string_append_byte(&rows, 'a' + j % 26);
+        string_append_byte(&rows, '\n');
+    }
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, string_build(rows));
+    text_end_command(&txt);
+    WrapIndex wrap = {0};
+    wrap_index_attach(&wrap, &txt);
+    TextCamera camera = camera_default();
+    camera.width = 1280;
+    camera.height = 720;
+    wrap_index_configure(&wrap, &camera, (FontMetrics){.advance = bench_advance, .line_height = 20});
+    isize total = size * 3;
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        isize row_in_line;
+        isize line = wrap_index_line_at(&wrap, rng_next() % total, &row_in_line);
+        wrap_index_scroll(&wrap, &line, &row_in_line, 20);
+        found += line + row_in_line;
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+
+    wrap_index_free(&wrap);
+    gapbuf_free(&txt.gapbuf);
+    arrlist_free(txt.line_offsets);
+    arrlist_free(txt.checkpoints);
+    arrlist_free(txt.listeners);
+    reset_command(&txt.commands);
+    free(txt.commands.data);
+    arena_free(&txt.commands.string_stack);
+    string_free(&rows);
+    return elapsed;
+}
+
+// a cursor put at a random column of one size byte line and its column read back, the walk
+// from the nearest checkpoint should cost the same however long the line is
+static i64 bench_text_long_line(isize size, i64 iterations) {
+    StringBuilder line = {0};
+    for (isize i = 0; i < size; i++) string_append_byte(&line, 'a' + i % 26);
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, string_build(line));
+    text_end_command(&txt);
+    isize found = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        text_cursor_moveto(&txt, rng_next() % size, 0);
+        found += txt.cursor_col;
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = found;
+
+    gapbuf_free(&txt.gapbuf);
+    arrlist_free(txt.line_offsets);
+    arrlist_free(txt.checkpoints);
+    arrlist_free(txt.listeners);
+    reset_command(&txt.commands);
+    free(txt.commands.data);
+    arena_free(&txt.commands.string_stack);
+    string_free(&line);
+    return elapsed;
+}
+
+// a match every 64 bytes swapped for a longer replacement, the whole buffer and an undo record
+// are written every op so the text is set up again outside the timing each time
+static i64 bench_text_replace_all(isize size, i64 iterations) {
+    isize count = size / 64;
+    TextRange* ranges = malloc(count * sizeof(TextRange) + 1);
+    for (isize i = 0; i < count; i++) ranges[i] = (TextRange){i * 64, i * 64 + 1};
+    String text = make_string(size);
+
+    i64 elapsed = 0;
+    for (i64 i = 0; i < iterations; i++) {
+        Text txt = {0};
+        text_begin_command(&txt);
+        text_cursor_insert(&txt, text);
+        text_end_command(&txt);
+
+        i64 start = timer_now_ns();
+        sink = text_replace_all(&txt, ranges, count, sl("xy"));
+        elapsed += timer_now_ns() - start;
+
+        gapbuf_free(&txt.gapbuf);
+        arrlist_free(txt.line_offsets);
+        arrlist_free(txt.checkpoints);
+        reset_command(&txt.commands);
+        free(txt.commands.data);
+        arena_free(&txt.commands.string_stack);
+    }
+    free((char*)text.data);
+    free(ranges);
+    return elapsed;
+}
+
+// a cursor every 64 bytes typing one character, the gap sweeps the buffer once per keystroke
+// instead of moving to every cursor in turn
+static i64 bench_text_cursors_insert(isize size, i64 iterations) {
+    String text = make_string(size);
+    Text txt = {0};
+    text_begin_command(&txt);
+    text_cursor_insert(&txt, text);
+    text_end_command(&txt);
+    text_cursor_moveto(&txt, 0, 0);
+    for (isize at = 64; at < size; at += 64) text_add_cursor(&txt, at, at);
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) text_cursors_insert(&txt, sl("x"));
+    i64 elapsed = timer_now_ns() - start;
+    sink = gapbuf_count(&txt.gapbuf);
+
+    gapbuf_free(&txt.gapbuf);
+    arrlist_free(txt.line_offsets);
+    arrlist_free(txt.checkpoints);
+    arrlist_free(txt.cursors);
+    reset_command(&txt.commands);
+    free(txt.commands.data);
+    arena_free(&txt.commands.string_stack);
+    free((char*)text.data);
+    return elapsed;
+}
+
+// mostly ascii with a two and a three byte codepoint every few dozen bytes
+static i64 bench_string_validate(isize size, i64 iterations) {
+    String s = make_string(size);
+    char* data = (char*)s.data;
+    for (isize i = 0; i + 5 < size; i += 40) {
+        memcpy(data + i, u8"é", 2);
+        memcpy(data + i + 2, u8"€", 3);
+    }
+    isize invalid = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        invalid += string_validate(s);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    assert(invalid == -iterations);
+    free(data);
+    return elapsed;
+}
+
+static i64 bench_string_hash(isize size, i64 iterations) {
+    String s = make_string(size);
+    u64 hash = 0;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        hash ^= string_hash(s);
+    }
+    i64 elapsed = timer_now_ns() - start;
+    sink = hash;
+    free((char*)s.data);
+    return elapsed;
+}
+
+// Arena and ArrayList
+
+// undo strings are allocated like this, the arena is cleared (not freed) when a region fills up
+static i64 bench_arena_alloc(isize size, i64 iterations) {
+    Arena arena = {0};
+    isize per_clear = ARENA_REGION_SIZE / (size + 8) + 1;
+
+    i64 start = timer_now_ns();
+    for (i64 i = 0; i < iterations; i++) {
+        if (i % per_clear == 0) arena_clear(&arena);
+        char* p = arena_alloc(&arena, size, 1, 8);
+        sink = p[0];
+    }
+    i64 elapsed = timer_now_ns() - start;
+    arena_free(&arena);
+    return elapsed;
+}
+
+// grows a list to size elements from empty, the op is one append so the cost of growing is amortized in
+static i64 bench_arrlist_append(isize size, i64 iterations) {
+    isize* arr = NULL;
+
+    i64 elapsed = 0;
+    for (i64 done = 0; done < iterations; ) {
+        i64 start = timer_now_ns();
+        for (isize i = 0; i < size && done < iterations; i++, done++) {
+            arrlist_append(arr, i);
+        }
+        sink = arr[0];
+        elapsed += timer_now_ns() - start;
+        arrlist_free(arr);
+    }
+    return elapsed;
+}
+
+static Bench benches[] = {
+    {"gapbuf_move", bench_gapbuf_move, {1, 16, 256, 4*KB, 64*KB, MB, 16*MB, 256*MB, GB}, true},
+    {"gapbuf_insert", bench_gapbuf_insert, {KB, 64*KB, MB, 16*MB, 256*MB, GB}},
+    {"gapbuf_remove", bench_gapbuf_remove, {KB, 64*KB, MB, 16*MB, 256*MB, GB}},
+    {"gapbuf_insertn", bench_gapbuf_insertn, {1, 16, 256, 4*KB, 64*KB, MB, 16*MB}, true},
+    {"string_find", bench_string_find, {16, 256, 4*KB, 64*KB, MB, 16*MB}, true},
+    {"search_find", bench_search_find, {16, 256, 4*KB, 64*KB, MB, 16*MB, 256*MB, GB}, true},
+    {"regex_find", bench_regex_find, {16, 256, 4*KB, 64*KB, MB, 16*MB, 256*MB, GB}, true},
+    {"text_replace_all", bench_text_replace_all, {4*KB, 64*KB, MB, 16*MB}, true},
+    {"text_cursors_insert", bench_text_cursors_insert, {4*KB, 64*KB, MB}, true},
+    {"text_block_insert", bench_text_block_insert, {16, 1*KB, 100000}},
+    {"match_index_build", bench_match_index_build, {16, 256, 4*KB, 64*KB, MB, 16*MB, 256*MB, GB}, true},
+    {"aho_scan", bench_aho_scan, {16, 256, 4*KB, 64*KB, MB, 16*MB}, true},
+    {"highlight_lex", bench_highlight_lex, {256, 4*KB, 64*KB, MB, 16*MB}, true},
+    {"bracket_match", bench_bracket_match, {4*KB, 64*KB, MB, 16*MB, 64*MB}},
+    {"marker_edit", bench_marker_edit, {16, 1*KB, 64*KB, MB}},
+    {"minimap_edit", bench_minimap_edit, {16, 1*KB, 64*KB, 256*KB}},
+    {"glyph_lookup", bench_glyph_lookup, {16, 1*KB, 16*KB}},
+    {"wrap_scroll", bench_wrap_scroll, {16, 1*KB, 64*KB}},
+    {"text_long_line", bench_text_long_line, {4*KB, 64*KB, MB, 16*MB}},
+    {"string_validate", bench_string_validate, {16, 256, 4*KB, 64*KB, MB, 16*MB}, true},
+    {"string_hash", bench_string_hash, {8, 64, 1*KB, 64*KB, MB}, true},
+    {"arena_alloc", bench_arena_alloc, {8, 64, 1*KB, 64*KB}},
+    {"arrlist_append", bench_arrlist_append, {16, 1*KB, 64*KB, MB, 16*MB}},
+};
+
+// doubles the iterations until a run takes min_time, then keeps the fastest of three runs
+static BenchResult bench_run(Bench* bench, isize size, i64 min_time) {
+    i64 iterations = 1;
+    i64 elapsed = bench->fn(size, iterations);
+    while (elapsed < min_time && iterations < (1ll << 40)) {
+        i64 scale = elapsed > 0 ? min_time / elapsed + 1 : 16;
+        if (scale > 16) scale = 16;
+        if (scale < 2) scale = 2;
+        iterations *= scale;
+        elapsed = bench->fn(size, iterations);
+    }
+    for (isize i = 0; i < 2; i++) {
+        i64 again = bench->fn(size, iterations);
+        if (again < elapsed) elapsed = again;
+    }
+
+    BenchResult result = {.size = size, .iterations = iterations, .ns_per_op = elapsed / (f64)iterations};
+    snprintf(result.name, sizeof(result.name), "%s", bench->name);
+    return result;
+}
+
+static BenchResult* read_baseline(const char* filename) {
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        perror("Couldn't Open File: ");
+        return NULL;
+    }
+    BenchResult* results = NULL;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        BenchResult result = {0};
+        long long size, iterations;
+        if (sscanf(line, "%63s %lld %lld %lf", result.name, &size, &iterations, &result.ns_per_op) == 4) {
+            result.size = size;
+            result.iterations = iterations;
+            arrlist_append(results, result);
+        }
+    }
+    fclose(f);
+    return results;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* baseline_filename = NULL;
+    isize max_size = GB;
+    i64 min_time = 50 * TIMER_NS_PER_MS;
+    f64 threshold = 10;
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = atoll(argv[++i]) * TIMER_NS_PER_MS;
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            baseline_filename = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--filter name] [--max-size bytes] [--min-time ms] [--compare baseline.tsv] [--threshold percent]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchResult* baseline = NULL;
+    if (baseline_filename) {
+        baseline = read_baseline(baseline_filename);
+        if (!baseline) return 1;
+    }
+
+    isize regressions = 0;
+    printf("# name\tsize\titerations\tns_per_op\tmb_per_s\n");
+    for (isize i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        Bench* bench = &benches[i];
+        if (filter && !strstr(bench->name, filter)) continue;
+
+        for (isize j = 0; bench->sizes[j] != 0 && bench->sizes[j] <= max_size; j++) {
+            fprintf(stderr, "%s %lld...\n", bench->name, (long long)bench->sizes[j]);
+            BenchResult result = bench_run(bench, bench->sizes[j], min_time);
+            f64 mb_per_s = bench->throughput ? result.size / result.ns_per_op * 1e9 / MB : 0;
+            printf("%s\t%lld\t%lld\t%.3f\t%.1f\n", result.name, (long long)result.size, (long long)result.iterations, result.ns_per_op, mb_per_s);
+            fflush(stdout);
+
+            for (isize k = 0; k < arrlist_count(baseline); k++) {
+                BenchResult old = baseline[k];
+                if (old.size != result.size || strcmp(old.name, result.name) != 0) continue;
+
+                f64 change = (result.ns_per_op - old.ns_per_op) / old.ns_per_op * 100;
+                bool regressed = change > threshold;
+                if (regressed) regressions++;
+                fprintf(stderr, "    %.3f -> %.3f ns/op (%+.1f%%)%s\n", old.ns_per_op, result.ns_per_op, change, regressed ? " REGRESSION" : "");
+            }
+        }
+    }
+
+    arrlist_free(baseline);
+    if (baseline_filename) {
+        fprintf(stderr, "%lld regression(s) over %.0f%%\n", (long long)regressions, threshold);
+    }
+    return regressions > 0;
+}
@@ -0,0 +1,467 @@
+// generates the syntax highlighting tables from the grammars
+//
+//   highlightgen src/grammars/c.grammar src/grammars/python.grammar > src/highlight_tables.h
+//
+// a grammar has one rule per line, the rule's name and then its values separated by spaces,
+// lines starting with ; are comments:
+//
+//   language name                          what the language is called
+//   extensions ext...                      file extensions it's used for, without the dot
+//   keyword word... / type ... / constant ...   words coloured as keywords, types or like numbers
+//   line_comment open [escape]             a comment to the end of the line, escape right before the
+//                                          newline carries it on to the next line
+//   block_comment open close               a comment that can span lines
+//   string open close [escape]             a string that ends with its line, escape skips the next
+//                                          byte so an escaped newline carries it on
+//   directive char                         a word after char at the start of a line, c's #
+//   directive_string word open close       after that directive open ... close is a string, #include <...>
+//
+// every language is compiled into one table of states by bytes, bytes that behave the same in
+// every state are merged into a class and the table is written out as static arrays of
+// HIGHLIGHT_ROW / HIGHLIGHT_EMIT / HIGHLIGHT_BACK entries. nothing about a language is left to
+// decide while lexing
+#include "highlight.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_STATES 255 // LEX_UNKNOWN is the one state id left over
+#define MAX_REGIONS 16
+#define MAX_WORDS 1024
+#define MAX_TOKEN 32
+
+// a comment or string, whatever is between its open and close is one kind
+typedef struct Region {
+    HighlightKind kind;
+    char open[MAX_TOKEN];
+    char close[MAX_TOKEN]; // empty for a line comment
+    i32 escape;            // -1 for none
+    bool multiline;
+    char word[MAX_TOKEN];  // the directive it follows, empty for anywhere
+    i32 body;              // body + j is the state with j bytes of close matched
+    i32 escape_state;
+} Region;
+
+typedef struct Grammar {
+    const char* filename;
+    char name[MAX_TOKEN];
+    char extensions[16][MAX_TOKEN];
+    i32 extension_count;
+    char words[MAX_WORDS][MAX_TOKEN];
+    HighlightKind word_kinds[MAX_WORDS];
+    i32 word_count;
+    Region regions[MAX_REGIONS];
+    i32 region_count;
+    i32 directive; // -1 for none
+} Grammar;
+
+typedef struct Entry {
+    i32 next;
+    HighlightKind emit;
+    i32 back;
+} Entry;
+
+// states every language has
+enum {
+    S_LINE_START = LEX_LINE_START,
+    S_NORMAL,
+    S_IDENT,
+    S_NUMBER,
+    S_EXPONENT,
+    S_DOT,
+    S_FIXED_COUNT,
+};
+
+typedef struct Builder {
+    Grammar* grammar;
+    Entry table[MAX_STATES][256];
+    u8 state_kinds[MAX_STATES];
+    i32 state_count;
+
+    // the unfinished openers and the directive words read so far that have a state
+    char prefixes[MAX_STATES][MAX_TOKEN];
+    i32 prefix_states[MAX_STATES];
+    i32 prefix_count;
+    char word_prefixes[MAX_STATES][MAX_TOKEN];
+    i32 word_prefix_states[MAX_STATES];
+    i32 word_prefix_count;
+
+    i32 directive_hash;
+    i32 directive_word;
+    i32 after_word[MAX_REGIONS];
+} Builder;
+
+static void fail(Grammar* grammar, isize line, const char* message, const char* detail) {
+    fprintf(stderr, "%s:%ld: %s %s\n", grammar->filename, (long)line, message, detail ? detail : "");
+    exit(1);
+}
+
+static bool is_ident(i32 byte) {
+    return (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || byte == '_' || byte >= 0x80;
+}
+static bool is_digit(i32 byte) {
+    return byte >= '0' && byte <= '9';
+}
+static bool is_space(i32 byte) {
+    return byte == ' ' || byte == '\t' || byte == '\v' || byte == '\f';
+}
+
+static void copy_token(Grammar* grammar, isize line, char* to, const char* token) {
+    if (strlen(token) >= MAX_TOKEN) fail(grammar, line, "too long:", token);
+    strcpy(to, token);
+}
+
+static void parse_grammar(Grammar* grammar, const char* filename) {
+    *grammar = (Grammar){.filename = filename, .directive = -1};
+    FILE* f = fopen(filename, "r");
+    if (f == NULL) fail(grammar, 0, "can't open", NULL);
+
+    char text[1024];
+    isize line = 0;
+    while (fgets(text, sizeof(text), f)) {
+        line++;
+        char* tokens[64];
+        i32 count = 0;
+        for (char* token = strtok(text, " \t\r\n"); token && count < 64; token = strtok(NULL, " \t\r\n")) tokens[count++] = token;
+        if (count == 0 || tokens[0][0] == ';') continue;
+        const char* rule = tokens[0];
+
+        if (strcmp(rule, "language") == 0 && count == 2) {
+            copy_token(grammar, line, grammar->name, tokens[1]);
+        } else if (strcmp(rule, "extensions") == 0) {
+            for (i32 i = 1; i < count && grammar->extension_count < 16; i++) copy_token(grammar, line, grammar->extensions[grammar->extension_count++], tokens[i]);
+        } else if (strcmp(rule, "keyword") == 0 || strcmp(rule, "type") == 0 || strcmp(rule, "constant") == 0) {
+            HighlightKind kind = rule[0] == 'k' ? HIGHLIGHT_KEYWORD : rule[0] == 't' ? HIGHLIGHT_TYPE : HIGHLIGHT_NUMBER;
+            for (i32 i = 1; i < count; i++) {
+                if (grammar->word_count == MAX_WORDS) fail(grammar, line, "too many words", NULL);
+                copy_token(grammar, line, grammar->words[grammar->word_count], tokens[i]);
+                grammar->word_kinds[grammar->word_count++] = kind;
+            }
+        } else if (strcmp(rule, "directive") == 0 && count == 2 && strlen(tokens[1]) == 1) {
+            grammar->directive = (u8)tokens[1][0];
+        } else if (strcmp(rule, "line_comment") == 0 || strcmp(rule, "block_comment") == 0
+            || strcmp(rule, "string") == 0 || strcmp(rule, "directive_string") == 0) {
+            if (grammar->region_count == MAX_REGIONS) fail(grammar, line, "too many comments and strings", NULL);
+            Region* region = &grammar->regions[grammar->region_count++];
+            *region = (Region){.kind = rule[0] == 'l' || rule[0] == 'b' ? HIGHLIGHT_COMMENT : HIGHLIGHT_STRING, .escape = -1};
+            i32 values = 1;
+            if (rule[0] == 'd') {
+                if (count != 4 || strlen(tokens[2]) != 1) fail(grammar, line, "expected directive_string word open close", NULL);
+                copy_token(grammar, line, region->word, tokens[values++]);
+            }
+            if (values >= count) fail(grammar, line, "expected an opening delimiter for", rule);
+            copy_token(grammar, line, region->open, tokens[values++]);
+            if (rule[0] != 'l') {
+                if (values >= count) fail(grammar, line, "expected a closing delimiter for", rule);
+                copy_token(grammar, line, region->close, tokens[values++]);
+            }
+            if (values < count) {
+                if (strlen(tokens[values]) != 1 || rule[0] == 'b' || rule[0] == 'd') fail(grammar, line, "bad escape", tokens[values]);
+                region->escape = (u8)tokens[values++][0];
+            }
+            region->multiline = rule[0] == 'b';
+            if (is_ident((u8)region->open[0]) || is_digit((u8)region->open[0])) fail(grammar, line, "delimiters can't start like a word or number:", region->open);
+        } else {
+            fail(grammar, line, "unknown rule", rule);
+        }
+    }
+    fclose(f);
+    if (grammar->name[0] == '\0') fail(grammar, line, "no language name", NULL);
+
+    // an opener that is the start of another one would never let the longer one be seen
+    for (i32 i = 0; i < grammar->region_count; i++) {
+        for (i32 j = 0; j < grammar->region_count; j++) {
+            Region* a = &grammar->regions[i];
+            Region* b = &grammar->regions[j];
+            if (i == j || a->word[0] || b->word[0]) continue;
+            if (strncmp(a->open, b->open, strlen(a->open)) == 0) fail(grammar, line, "opener is the start of another opener:", a->open);
+        }
+    }
+}
+
+static i32 new_state(Builder* b, HighlightKind kind) {
+    if (b->state_count == MAX_STATES) fail(b->grammar, 0, "too many states", NULL);
+    b->state_kinds[b->state_count] = kind;
+    return b->state_count++;
+}
+
+static i32 find_prefix(char prefixes[][MAX_TOKEN], i32* states, i32 count, const char* prefix) {
+    for (i32 i = 0; i < count; i++) {
+        if (strcmp(prefixes[i], prefix) == 0) return states[i];
+    }
+    return -1;
+}
+
+// a state for every proper prefix of every opener and every prefix of every directive word
+static void add_prefixes(Builder* b) {
+    Grammar* grammar = b->grammar;
+    for (i32 r = 0; r < grammar->region_count; r++) {
+        Region* region = &grammar->regions[r];
+        char prefix[MAX_TOKEN] = {0};
+        if (region->word[0] == '\0') {
+            for (isize len = 1; len < (isize)strlen(region->open); len++) {
+                memcpy(prefix, region->open, len);
+                if (find_prefix(b->prefixes, b->prefix_states, b->prefix_count, prefix) >= 0) continue;
+                strcpy(b->prefixes[b->prefix_count], prefix);
+                b->prefix_states[b->prefix_count++] = new_state(b, HIGHLIGHT_TEXT);
+            }
+        } else {
+            if (grammar->directive < 0) fail(grammar, 0, "directive_string without a directive", NULL);
+            for (isize len = 1; len <= (isize)strlen(region->word); len++) {
+                memcpy(prefix, region->word, len);
+                if (find_prefix(b->word_prefixes, b->word_prefix_states, b->word_prefix_count, prefix) >= 0) continue;
+                strcpy(b->word_prefixes[b->word_prefix_count], prefix);
+                b->word_prefix_states[b->word_prefix_count++] = new_state(b, HIGHLIGHT_TEXT);
+            }
+            b->after_word[r] = new_state(b, HIGHLIGHT_TEXT);
+        }
+    }
+}
+
+// continues an opener with byte, false if no opener goes on like that
+static bool opener_entry(Builder* b, const char* prefix, i32 byte, Entry* entry) {
+    if (byte == '\0') return false; // delimiters are c strings, a nul never continues one
+    char extended[MAX_TOKEN + 1];
+    isize len = strlen(prefix);
+    memcpy(extended, prefix, len);
+    extended[len] = byte;
+    extended[len + 1] = '\0';
+    for (i32 r = 0; r < b->grammar->region_count; r++) {
+        Region* region = &b->grammar->regions[r];
+        if (region->word[0] == '\0' && strcmp(region->open, extended) == 0) {
+            *entry = (Entry){region->body, region->kind, len};
+            return true;
+        }
+    }
+    i32 state = find_prefix(b->prefixes, b->prefix_states, b->prefix_count, extended);
+    if (state < 0) return false;
+    *entry = (Entry){state, HIGHLIGHT_TEXT, 0};
+    return true;
+}
+
+// what byte starts when nothing is going on
+static Entry start_entry(Builder* b, i32 byte) {
+    Entry entry;
+    if (byte == '\n') return (Entry){S_LINE_START, HIGHLIGHT_TEXT, 0};
+    if (opener_entry(b, "", byte, &entry)) return entry;
+    if (is_ident(byte)) return (Entry){S_IDENT, HIGHLIGHT_IDENTIFIER, 0};
+    if (is_digit(byte)) return (Entry){S_NUMBER, HIGHLIGHT_NUMBER, 0};
+    if (byte == '.') return (Entry){S_DOT, HIGHLIGHT_TEXT, 0};
+    return (Entry){S_NORMAL, HIGHLIGHT_TEXT, 0};
+}
+
+// the longest start of close that the matched bytes followed by byte end in
+static i32 close_fallback(const char* close, i32 matched, i32 byte) {
+    char read[MAX_TOKEN + 1];
+    memcpy(read, close, matched);
+    read[matched] = byte;
+    for (i32 k = matched; k > 0; k--) {
+        if (memcmp(read + matched + 1 - k, close, k) == 0) return k;
+    }
+    return 0;
+}
+
+static Entry region_entry(Builder* b, Region* region, i32 matched, i32 byte) {
+    isize close_count = strlen(region->close);
+    if (matched < close_count && byte == (u8)region->close[matched]) {
+        if (matched + 1 == close_count) return (Entry){S_NORMAL, region->kind, 0};
+        return (Entry){region->body + matched + 1, region->kind, 0};
+    }
+    if (byte == region->escape) return (Entry){region->escape_state, region->kind, 0};
+    if (byte == '\n') return (Entry){region->multiline ? region->body : S_LINE_START, HIGHLIGHT_TEXT, 0};
+    i32 fallback = close_count > 0 ? close_fallback(region->close, matched, byte) : 0;
+    return (Entry){region->body + fallback, region->kind, 0};
+}
+
+static void build(Builder* b, Grammar* grammar) {
+    memset(b, 0, sizeof(*b));
+    b->grammar = grammar;
+    for (i32 i = 0; i < S_FIXED_COUNT; i++) new_state(b, HIGHLIGHT_TEXT);
+    if (grammar->directive >= 0) {
+        b->directive_hash = new_state(b, HIGHLIGHT_TEXT);
+        b->directive_word = new_state(b, HIGHLIGHT_TEXT);
+    }
+    add_prefixes(b);
+    for (i32 r = 0; r < grammar->region_count; r++) {
+        Region* region = &grammar->regions[r];
+        isize close_count = strlen(region->close);
+        region->body = new_state(b, region->kind);
+        for (isize j = 1; j < close_count; j++) new_state(b, region->kind);
+        region->escape_state = region->escape >= 0 ? new_state(b, region->kind) : -1;
+    }
+
+    for (i32 byte = 0; byte < 256; byte++) {
+        Entry start = start_entry(b, byte);
+        bool number = is_ident(byte) || is_digit(byte) || byte == '.';
+        bool exponent = byte == 'e' || byte == 'E';
+
+        b->table[S_LINE_START][byte] = is_space(byte) ? (Entry){S_LINE_START, HIGHLIGHT_TEXT, 0}
+            : byte == grammar->directive ? (Entry){b->directive_hash, HIGHLIGHT_PREPROCESSOR, 0}
+            : start;
+        b->table[S_NORMAL][byte] = start;
+        b->table[S_IDENT][byte] = is_ident(byte) || is_digit(byte) ? (Entry){S_IDENT, HIGHLIGHT_IDENTIFIER, 0} : start;
+        b->table[S_NUMBER][byte] = number ? (Entry){exponent ? S_EXPONENT : S_NUMBER, HIGHLIGHT_NUMBER, 0} : start;
+        b->table[S_EXPONENT][byte] = byte == '+' || byte == '-' ? (Entry){S_NUMBER, HIGHLIGHT_NUMBER, 0} : b->table[S_NUMBER][byte];
+        b->table[S_DOT][byte] = is_digit(byte) ? (Entry){S_NUMBER, HIGHLIGHT_NUMBER, 1} : start;
+
+        for (i32 p = 0; p < b->prefix_count; p++) {
+            Entry entry;
+            b->table[b->prefix_states[p]][byte] = opener_entry(b, b->prefixes[p], byte, &entry) ? entry : start;
+        }
+
+        if (grammar->directive >= 0) {
+            char first[2] = {byte, '\0'};
+            i32 word = find_prefix(b->word_prefixes, b->word_prefix_states, b->word_prefix_count, first);
+            b->table[b->directive_hash][byte] = is_space(byte) ? (Entry){b->directive_hash, HIGHLIGHT_PREPROCESSOR, 0}
+                : is_ident(byte) ? (Entry){word >= 0 ? word : b->directive_word, HIGHLIGHT_PREPROCESSOR, 0}
+                : start;
+            b->table[b->directive_word][byte] = is_ident(byte) || is_digit(byte) ? (Entry){b->directive_word, HIGHLIGHT_PREPROCESSOR, 0} : start;
+        }
+        for (i32 r = 0; r < grammar->region_count; r++) {
+            Region* region = &grammar->regions[r];
+            if (region->word[0]) {
+                b->table[b->after_word[r]][byte] = is_space(byte) ? (Entry){b->after_word[r], HIGHLIGHT_TEXT, 0}
+                    : byte == (u8)region->open[0] ? (Entry){region->body, region->kind, 0}
+                    : start;
+            }
+            isize close_states = strlen(region->close) > 1 ? strlen(region->close) : 1;
+            for (i32 j = 0; j < close_states; j++) b->table[region->body + j][byte] = region_entry(b, region, j, byte);
+            if (region->escape_state >= 0) {
+                b->table[region->escape_state][byte] = byte == '\n' ? (Entry){region->body, HIGHLIGHT_TEXT, 0} : (Entry){region->body, region->kind, 0};
+            }
+        }
+        for (i32 w = 0; w < b->word_prefix_count; w++) {
+            const char* prefix = b->word_prefixes[w];
+            i32 state = b->word_prefix_states[w];
+            if (is_ident(byte) || is_digit(byte)) {
+                char extended[MAX_TOKEN + 1];
+                isize len = strlen(prefix);
+                memcpy(extended, prefix, len);
+                extended[len] = byte;
+                extended[len + 1] = '\0';
+                i32 next = find_prefix(b->word_prefixes, b->word_prefix_states, b->word_prefix_count, extended);
+                b->table[state][byte] = (Entry){next >= 0 ? next : b->directive_word, HIGHLIGHT_PREPROCESSOR, 0};
+                continue;
+            }
+            b->table[state][byte] = start;
+            // the whole word was read, what comes after is up to its string (filled in above)
+            for (i32 r = grammar->region_count - 1; r >= 0; r--) {
+                if (strcmp(grammar->regions[r].word, prefix) == 0) b->table[state][byte] = b->table[b->after_word[r]][byte];
+            }
+        }
+
+    }
+}
+
+// returns how many byte classes there are
+static i32 write_language(Builder* b, const char* id) {
+    Grammar* grammar = b->grammar;
+
+    // bytes that do the same thing in every state share a column
+    u8 classes[256];
+    i32 representatives[256];
+    i32 class_count = 0;
+    for (i32 byte = 0; byte < 256; byte++) {
+        i32 class = 0;
+        for (; class < class_count; class++) {
+            bool same = true;
+            for (i32 s = 0; s < b->state_count && same; s++) {
+                Entry x = b->table[s][byte];
+                Entry y = b->table[s][representatives[class]];
+                same = x.next == y.next && x.emit == y.emit && x.back == y.back;
+            }
+            if (same) break;
+        }
+        if (class == class_count) representatives[class_count++] = byte;
+        classes[byte] = class;
+    }
+
+    printf("// %s: %d states, %d byte classes\n", grammar->filename, b->state_count, class_count);
+    printf("static const u8 %s_classes[256] = {", id);
+    for (i32 byte = 0; byte < 256; byte++) printf("%s%d,", byte % 32 == 0 ? "\n    " : " ", classes[byte]);
+    printf("\n};\n");
+
+    printf("static const u32 %s_next[%d] = {", id, b->state_count * class_count);
+    for (i32 s = 0; s < b->state_count; s++) {
+        printf("\n   ");
+        for (i32 class = 0; class < class_count; class++) {
+            Entry entry = b->table[s][representatives[class]];
+            printf(" 0x%08x,", (u32)(entry.next * class_count) | entry.emit << 16 | (u32)entry.back << 24);
+        }
+    }
+    printf("\n};\n");
+
+    printf("static const u8 %s_state_kinds[%d] = {", id, b->state_count);
+    for (i32 s = 0; s < b->state_count; s++) printf("%s%d,", s % 32 == 0 ? "\n    " : " ", b->state_kinds[s]);
+    printf("\n};\n");
+
+    printf("static const char* const %s_words[%d] = {", id, grammar->word_count + 1);
+    for (i32 i = 0; i < grammar->word_count; i++) printf("%s\"%s\",", i % 8 == 0 ? "\n    " : " ", grammar->words[i]);
+    printf("\n    NULL,\n};\n");
+    printf("static const u8 %s_word_kinds[%d] = {", id, grammar->word_count + 1);
+    for (i32 i = 0; i < grammar->word_count; i++) printf("%s%d,", i % 32 == 0 ? "\n    " : " ", grammar->word_kinds[i]);
+    printf("\n    0,\n};\n");
+
+    // at most half full so a miss ends quickly
+    u32 slot_count = 16;
+    while (slot_count < 2u * grammar->word_count) slot_count *= 2;
+    i16* slots = malloc(slot_count * sizeof(i16));
+    for (u32 i = 0; i < slot_count; i++) slots[i] = -1;
+    for (i32 i = 0; i < grammar->word_count; i++) {
+        u32 slot = HIGHLIGHT_WORD_HASH(grammar->words[i], (isize)strlen(grammar->words[i])) & (slot_count - 1);
+        while (slots[slot] >= 0) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = i;
+    }
+    printf("static const i16 %s_word_slots[%u] = {", id, slot_count);
+    for (u32 i = 0; i < slot_count; i++) printf("%s%d,", i % 16 == 0 ? "\n    " : " ", slots[i]);
+    printf("\n};\n");
+    free(slots);
+
+    printf("static const char* const %s_extensions[] = {", id);
+    for (i32 i = 0; i < grammar->extension_count; i++) printf("\"%s\", ", grammar->extensions[i]);
+    printf("NULL};\n\n");
+    return class_count;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: highlightgen grammar... > highlight_tables.h\n");
+        return 1;
+    }
+    static Grammar grammars[32];
+    static Builder builder;
+    char ids[32][MAX_TOKEN];
+    i32 class_counts[32];
+    i32 count = argc - 1 < 32 ? argc - 1 : 32;
+
+    printf("// generated by src/tools/highlightgen.c from src/grammars, make -f MakeFile highlight_tables writes it again\n");
+    printf("#ifndef HIGHLIGHT_TABLES_H_\n#define HIGHLIGHT_TABLES_H_\n\n#include \"highlight.h\"\n\n");
+    for (i32 i = 0; i < count; i++) {
+        parse_grammar(&grammars[i], argv[i + 1]);
+        strcpy(ids[i], grammars[i].name);
+        for (char* c = ids[i]; *c; c++) {
+            if (!is_ident((u8)*c) && !is_digit((u8)*c)) *c = '_';
+        }
+        build(&builder, &grammars[i]);
+        class_counts[i] = write_language(&builder, ids[i]);
+    }
+
+    printf("static const HighlightLanguage highlight_languages[] = {\n");
+    for (i32 i = 0; i < count; i++) {
+        const char* id = ids[i];
+        printf("    {\n");
+        printf("        .name = \"%s\",\n", grammars[i].name);
+        printf("        .extensions = %s_extensions,\n", id);
+        printf("        .classes = %s_classes,\n", id);
+        printf("        .class_count = %d,\n", class_counts[i]);
+        printf("        .next = %s_next,\n", id);
+        printf("        .state_kinds = %s_state_kinds,\n", id);
+        printf("        .words = %s_words,\n", id);
+        printf("        .word_kinds = %s_word_kinds,\n", id);
+        printf("        .word_slots = %s_word_slots,\n", id);
+        printf("        .word_slot_mask = countof(%s_word_slots) - 1,\n", id);
+        printf("    },\n");
+    }
+    printf("};\n\n#endif //HIGHLIGHT_TABLES_H_\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+// replays a trace recorded with --record through the editing core as fast as possible
+//
+//   replay <trace> [file]
+//
+// the file is loaded before the first frame, it should be the one the session was recorded on
+#include "editor.h"
+#include "trace.h"
+#include "timer.h"
+#include "arraylist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// what the frame did, decided by its first event that acts on the text
+typedef enum ReplayOp {
+    REPLAY_INSERT,
+    REPLAY_DELETE,
+    REPLAY_MOVE,
+    REPLAY_UNDO,
+    REPLAY_OTHER,
+    REPLAY_OP_COUNT,
+} ReplayOp;
+
+static const char* replay_op_names[REPLAY_OP_COUNT] = {"insert", "delete", "move", "undo", "other"};
+
+static ReplayOp replay_classify(TraceFrame* frame) {
+    EditorInput input = frame->input;
+    for (isize i = 0; i < input.event_count; i++) {
+        InputEvent event = input.events[i];
+        if (event.codepoint != 0 || event.key == INPUT_KEY_ENTER || event.key == INPUT_KEY_TAB) {
+            return input.cntrl ? REPLAY_OTHER : REPLAY_INSERT;
+        }
+        switch (event.key) {
+            case INPUT_KEY_BACKSPACE:
+            case INPUT_KEY_DELETE:
+                return REPLAY_DELETE;
+            case INPUT_KEY_LEFT: case INPUT_KEY_RIGHT: case INPUT_KEY_UP: case INPUT_KEY_DOWN:
+            case INPUT_KEY_HOME: case INPUT_KEY_END: case INPUT_KEY_PAGE_UP: case INPUT_KEY_PAGE_DOWN:
+                return REPLAY_MOVE;
+            case INPUT_KEY_Z: case INPUT_KEY_Y:
+                if (input.cntrl) return REPLAY_UNDO;
+                break;
+            default: break;
+        }
+    }
+    if (frame->mouse.pos.exists) return REPLAY_MOVE;
+    return REPLAY_OTHER;
+}
+
+// the clipboard stays inside the replay so pastes are deterministic
+static char* clipboard = NULL;
+static void replay_set_clipboard(const char* text) {
+    isize len = strlen(text);
+    clipboard = realloc(clipboard, len + 1);
+    memcpy(clipboard, text, len + 1);
+}
+static const char* replay_get_clipboard(void) {
+    return clipboard ? clipboard : "";
+}
+
+// fixed width glyphs, wide enough that wrapping behaves like the default font
+static float replay_advance(void* font, Codepoint c) {
+    return 11.0;
+}
+
+// the same walk over the visible rows camera_draw does, without drawing anything
+static isize replay_layout(Editor* editor, FontMetrics metrics) {
+    TextCamera* camera = &editor->camera;
+    Text* txt = &editor->txt;
+    float bottom = camera->height - camera->padding - camera->bottom_margin;
+    wrap_index_configure(&editor->wrap, camera, metrics);
+    CameraPosition pos = camera_start_position(camera, txt, &editor->wrap);
+    isize glyphs = 0;
+    for (; pos.index < gapbuf_count(&txt->gapbuf) && pos.position.y + metrics.line_height < bottom;) {
+        Codepoint c = camera_next_char(camera, txt, metrics, &pos);
+        if (c != '\r' && c != '\n') {
+            pos.position.x += pos.width;
+            glyphs++;
+        }
+    }
+    return glyphs;
+}
+
+static int compare_i64(const void* a, const void* b) {
+    i64 x = *(const i64*)a, y = *(const i64*)b;
+    return (x > y) - (x < y);
+}
+
+// frame times are kept exactly since most edits finish well under the latency histogram's 0.1ms buckets
+static void print_samples(const char* name, i64* samples) {
+    isize count = arrlist_count(samples);
+    if (count == 0) return;
+    qsort(samples, count, sizeof(i64), compare_i64);
+    i64 total = 0;
+    for (isize i = 0; i < count; i++) total += samples[i];
+    printf("%-8s %8lld %10.2f %10.2f %10.2f %10.2f\n", name, (long long)count,
+        total / (f64)count / TIMER_NS_PER_US,
+        samples[count / 2] / (f64)TIMER_NS_PER_US,
+        samples[count * 99 / 100] / (f64)TIMER_NS_PER_US,
+        samples[count - 1] / (f64)TIMER_NS_PER_US
+    );
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace> [file]\n", argv[0]);
+        return 1;
+    }
+
+    TraceReader reader = {0};
+    if (!trace_reader_open(&reader, argv[1])) return 1;
+
+    Editor editor = {
+        .txt = {.set_clipboard = replay_set_clipboard},
+        .camera = camera_default(),
+        .get_clipboard = replay_get_clipboard,
+    };
+    editor.camera.width = 1280;
+    editor.camera.height = 720;
+    FontMetrics metrics = {.advance = replay_advance, .line_height = 20};
+
+    if (argc > 2) {
+        text_load_file(&editor.txt, argv[2]);
+    }
+    wrap_index_attach(&editor.wrap, &editor.txt);
+
+    i64* ops[REPLAY_OP_COUNT] = {0};
+    i64* edit = NULL;
+    i64* layout = NULL;
+    i64 frames = 0, events = 0, glyphs = 0, session = 0;
+
+    TraceFrame frame;
+    i64 start = timer_now_ns();
+    while (trace_read_frame(&reader, &frame)) {
+        i64 frame_start = timer_now_ns();
+        editor_update(&editor, frame.input);
+        editor_mouse(&editor, frame.mouse);
+        i64 edited = timer_now_ns();
+        glyphs += replay_layout(&editor, metrics);
+        i64 laid_out = timer_now_ns();
+
+        arrlist_append(edit, edited - frame_start);
+        arrlist_append(layout, laid_out - edited);
+        arrlist_append(ops[replay_classify(&frame)], edited - frame_start);
+
+        frames++;
+        events += frame.input.event_count;
+        session = frame.time;
+    }
+    i64 elapsed = timer_now_ns() - start;
+    trace_reader_close(&reader);
+
+    f64 seconds = elapsed / (f64)TIMER_NS_PER_S;
+    printf("frames %lld, events %lld, glyphs laid out %lld\n", (long long)frames, (long long)events, (long long)glyphs);
+    printf("replayed in %.3fs (recorded session %.1fs)\n", seconds, session / (f64)TIMER_NS_PER_S);
+    if (seconds > 0) {
+        printf("throughput %.0f events/s, %.0f frames/s\n", events / seconds, frames / seconds);
+    }
+    printf("final buffer %lld bytes, %lld lines\n", (long long)gapbuf_count(&editor.txt.gapbuf), (long long)arrlist_count(editor.txt.line_offsets) + 1);
+
+    printf("\n%-8s %8s %10s %10s %10s %10s\n", "stage", "frames", "mean_us", "p50_us", "p99_us", "max_us");
+    print_samples("edit", edit);
+    print_samples("layout", layout);
+    for (isize i = 0; i < REPLAY_OP_COUNT; i++) {
+        print_samples(replay_op_names[i], ops[i]);
+        arrlist_free(ops[i]);
+    }
+    arrlist_free(edit);
+    arrlist_free(layout);
+
+    free(clipboard);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "timer.h"
+#include "arraylist.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    TRACE_CNTRL        = 1 << 0,
+    TRACE_SHIFT        = 1 << 1,
+    TRACE_MOUSE        = 1 << 2, // mouse line and col follow
+    TRACE_MOUSE_PRESS  = 1 << 3,
+    TRACE_MOUSE_DOWN   = 1 << 4,
+    TRACE_MOUSE_SHIFT  = 1 << 5,
+    TRACE_ALT          = 1 << 6,
+    TRACE_MOUSE_ALT    = 1 << 7,
+};
+
+static const char trace_magic[4] = {'E', 'T', 'R', 'C'};
+
+bool trace_writer_open(TraceWriter* writer, const char* filename) {
+    writer->file = fopen(filename, "wb");
+    if (!writer->file) {
+        perror("Couldn't Open File: ");
+        return false;
+    }
+    u32 version = TRACE_VERSION;
+    fwrite(trace_magic, 1, sizeof(trace_magic), writer->file);
+    fwrite(&version, sizeof(version), 1, writer->file);
+    writer->start = timer_now_ns();
+    return true;
+}
+
+// frames where nothing happened are skipped to keep traces of idle sessions small
+void trace_write_frame(TraceWriter* writer, EditorInput input, EditorMouse mouse) {
+    if (!writer->file) return;
+
+    bool mouse_active = mouse.pos.exists && (mouse.pressed || mouse.down);
+    if (input.event_count == 0 && input.wheel == 0 && !mouse_active) return;
+
+    i64 time = timer_now_ns() - writer->start;
+    u8 flags = 0;
+    if (input.cntrl) flags |= TRACE_CNTRL;
+    if (input.shift) flags |= TRACE_SHIFT;
+    if (mouse_active) flags |= TRACE_MOUSE;
+    if (mouse.pressed) flags |= TRACE_MOUSE_PRESS;
+    if (mouse.down) flags |= TRACE_MOUSE_DOWN;
+    if (mouse.shift) flags |= TRACE_MOUSE_SHIFT;
+    if (input.alt) flags |= TRACE_ALT;
+    if (mouse.alt) flags |= TRACE_MOUSE_ALT;
+    f32 wheel = input.wheel;
+    u16 count = input.event_count > U16_MAX ? U16_MAX : input.event_count;
+
+    fwrite(&time, sizeof(time), 1, writer->file);
+    fwrite(&flags, sizeof(flags), 1, writer->file);
+    fwrite(&wheel, sizeof(wheel), 1, writer->file);
+    if (mouse_active) {
+        i64 line = mouse.pos.pos.line;
+        i64 col = mouse.pos.pos.col;
+        fwrite(&line, sizeof(line), 1, writer->file);
+        fwrite(&col, sizeof(col), 1, writer->file);
+    }
+    fwrite(&count, sizeof(count), 1, writer->file);
+    for (isize i = 0; i < count; i++) {
+        u16 key = input.events[i].key;
+        u32 codepoint = input.events[i].codepoint;
+        u8 repeat = input.events[i].repeat;
+        fwrite(&key, sizeof(key), 1, writer->file);
+        fwrite(&codepoint, sizeof(codepoint), 1, writer->file);
+        fwrite(&repeat, sizeof(repeat), 1, writer->file);
+    }
+}
+void trace_writer_close(TraceWriter* writer) {
+    if (writer->file) fclose(writer->file);
+    writer->file = NULL;
+}
+
+bool trace_reader_open(TraceReader* reader, const char* filename) {
+    reader->file = fopen(filename, "rb");
+    if (!reader->file) {
+        perror("Couldn't Open File: ");
+        return false;
+    }
+    char magic[4];
+    u32 version = 0;
+    if (fread(magic, 1, sizeof(magic), reader->file) != sizeof(magic) || memcmp(magic, trace_magic, sizeof(magic)) != 0
+        || fread(&version, sizeof(version), 1, reader->file) != 1 || version != TRACE_VERSION) {
+        fprintf(stderr, "%s is not a version %d trace\n", filename, TRACE_VERSION);
+        trace_reader_close(reader);
+        return false;
+    }
+    return true;
+}
+
+// returns false at the end of the trace (or on a truncated frame)
+bool trace_read_frame(TraceReader* reader, TraceFrame* frame) {
+    if (!reader->file) return false;
+    FILE* f = reader->file;
+
+    u8 flags;
+    f32 wheel;
+    u16 count;
+    *frame = (TraceFrame){0};
+    if (fread(&frame->time, sizeof(frame->time), 1, f) != 1) return false;
+    if (fread(&flags, sizeof(flags), 1, f) != 1) return false;
+    if (fread(&wheel, sizeof(wheel), 1, f) != 1) return false;
+    if (flags & TRACE_MOUSE) {
+        i64 line, col;
+        if (fread(&line, sizeof(line), 1, f) != 1) return false;
+        if (fread(&col, sizeof(col), 1, f) != 1) return false;
+        frame->mouse.pos = (MouseCursorPosition){.pos = {.line = line, .col = col}, .exists = true};
+    }
+    if (fread(&count, sizeof(count), 1, f) != 1) return false;
+
+    arrlist_setcount(reader->events, count);
+    for (isize i = 0; i < count; i++) {
+        u16 key;
+        u32 codepoint;
+        u8 repeat;
+        if (fread(&key, sizeof(key), 1, f) != 1) return false;
+        if (fread(&codepoint, sizeof(codepoint), 1, f) != 1) return false;
+        if (fread(&repeat, sizeof(repeat), 1, f) != 1) return false;
+        reader->events[i] = (InputEvent){.key = key, .codepoint = codepoint, .repeat = repeat, .time = frame->time};
+    }
+
+    frame->input = (EditorInput) {
+        .events = reader->events,
+        .event_count = count,
+        .cntrl = flags & TRACE_CNTRL,
+        .shift = flags & TRACE_SHIFT,
+        .alt = flags & TRACE_ALT,
+        .wheel = wheel,
+    };
+    frame->mouse.pressed = flags & TRACE_MOUSE_PRESS;
+    frame->mouse.down = flags & TRACE_MOUSE_DOWN;
+    frame->mouse.shift = flags & TRACE_MOUSE_SHIFT;
+    frame->mouse.alt = flags & TRACE_MOUSE_ALT;
+    return true;
+}
+void trace_reader_close(TraceReader* reader) {
+    if (reader->file) fclose(reader->file);
+    reader->file = NULL;
+    arrlist_free(reader->events);
+}
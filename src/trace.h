@@ -0,0 +1,41 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdio.h>
+#include "short_types.h"
+#include "editor.h"
+
+// binary recording of the input the editor received, one record per frame that did something
+// records are written in the machine's native byte order
+//
+// header: "ETRC" u32 version
+// frame:  i64 time_ns u8 flags f32 wheel [i64 mouse_line i64 mouse_col] u16 event_count
+// event:  u16 key u32 codepoint u8 repeat
+
+#define TRACE_VERSION 1
+
+typedef struct TraceFrame {
+    i64 time; // nanoseconds since the recording started
+    EditorInput input;
+    EditorMouse mouse;
+} TraceFrame;
+
+typedef struct TraceWriter {
+    FILE* file;
+    i64 start;
+} TraceWriter;
+
+typedef struct TraceReader {
+    FILE* file;
+    InputEvent* events; // arraylist, TraceFrame.input.events points into it until the next read
+} TraceReader;
+
+bool trace_writer_open(TraceWriter* writer, const char* filename);
+void trace_write_frame(TraceWriter* writer, EditorInput input, EditorMouse mouse);
+void trace_writer_close(TraceWriter* writer);
+
+bool trace_reader_open(TraceReader* reader, const char* filename);
+bool trace_read_frame(TraceReader* reader, TraceFrame* frame);
+void trace_reader_close(TraceReader* reader);
+
+#endif //TRACE_H_
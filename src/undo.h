@@ -12,6 +12,7 @@ typedef struct Transaction {
 
     String modified;
     bool removed;
+    bool replaced_all; // modified holds a replace all record, see text_replace_all
 } Transaction;
 
 typedef struct Command {
@@ -0,0 +1,131 @@
+#include "watchlist.h"
+#include "arraylist.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the first cached line at or after line
+static isize watchlist_lower_bound(Watchlist* watchlist, isize line) {
+    isize lo = 0, hi = arrlist_count(watchlist->lines);
+    while (lo < hi) {
+        isize mid = lo + (hi - lo) / 2;
+        if (watchlist->lines[mid].line < line) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void watchlist_drop(Watchlist* watchlist, isize begin, isize end) {
+    for (isize i = begin; i < end; i++) arrlist_free(watchlist->lines[i].spans);
+    isize count = arrlist_count(watchlist->lines);
+    memmove(watchlist->lines + begin, watchlist->lines + end, (count - end) * sizeof(WatchLine));
+    arrlist_setcount(watchlist->lines, count - (end - begin));
+}
+
+// line offsets still describe the text before the edit here, so the lines the edit touched are
+// found in them and the lines after move by however many newlines came and went
+static void watchlist_on_edit(void* data, Text* txt, TextEdit edit) {
+    Watchlist* watchlist = data;
+    if (arrlist_count(watchlist->lines) == 0) return;
+
+    isize first = text_line_of(txt, edit.index);
+    isize last = text_line_of(txt, edit.index + edit.removed);
+    isize added = 0;
+    GapBufSlice inserted = gapbuf_slice(&txt->gapbuf, edit.index, edit.index + edit.inserted);
+    for (isize i = 0; i < inserted.l.count; i++) added += inserted.l.data[i] == '\n';
+    for (isize i = 0; i < inserted.r.count; i++) added += inserted.r.data[i] == '\n';
+    isize shift = added - (last - first);
+
+    isize begin = watchlist_lower_bound(watchlist, first);
+    isize end = watchlist_lower_bound(watchlist, last + 1);
+    watchlist_drop(watchlist, begin, end);
+    for (isize i = begin; i < arrlist_count(watchlist->lines); i++) watchlist->lines[i].line += shift;
+}
+
+void watchlist_set(Watchlist* watchlist, Text* txt, const String* patterns, isize count) {
+    watchlist_free(watchlist);
+    aho_build(&watchlist->aho, patterns, count);
+    watchlist->active = true;
+    watchlist->txt = txt;
+    text_add_listener(txt, (TextListener){watchlist_on_edit, watchlist});
+}
+
+bool watchlist_load(Watchlist* watchlist, Text* txt, const char* filename) {
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL) return false;
+    fclose(f);
+
+    StringBuilder file = {0};
+    string_read_entire_file(filename, &file);
+    String* patterns = NULL;
+    String contents = string_build(file);
+    isize index = 0;
+    while (index < contents.count) {
+        String pattern = string_tokenc(contents, '\n', &index);
+        if (pattern.count > 0 && pattern.data[pattern.count - 1] == '\r') pattern.count--;
+        if (pattern.count > 0) arrlist_append(patterns, pattern);
+    }
+    watchlist_set(watchlist, txt, patterns, arrlist_count(patterns));
+    arrlist_free(patterns);
+    string_free(&file);
+    return true;
+}
+
+void watchlist_free(Watchlist* watchlist) {
+    if (watchlist->txt) text_remove_listener(watchlist->txt, watchlist);
+    watchlist_drop(watchlist, 0, arrlist_count(watchlist->lines));
+    arrlist_free(watchlist->lines);
+    arrlist_free(watchlist->scratch);
+    string_free(&watchlist->straddle);
+    aho_free(&watchlist->aho);
+    *watchlist = (Watchlist){0};
+}
+
+static int watchlist_compare_begin(const void* a, const void* b) {
+    const TextRange* l = a;
+    const TextRange* r = b;
+    return (l->begin > r->begin) - (l->begin < r->begin);
+}
+
+static void watchlist_scan(Watchlist* watchlist, isize line, TextRange** spans) {
+    PROFILE_BEGIN("watchlist_scan");
+    String contiguous = text_line_string(watchlist->txt, line, &watchlist->straddle);
+
+    arrlist_setcount(watchlist->scratch, 0);
+    aho_scan(&watchlist->aho, contiguous.data, contiguous.count, &watchlist->scratch);
+    isize count = arrlist_count(watchlist->scratch);
+    qsort(watchlist->scratch, count, sizeof(TextRange), watchlist_compare_begin);
+    for (isize i = 0; i < count; i++) {
+        TextRange match = watchlist->scratch[i];
+        isize spans_count = arrlist_count(*spans);
+        if (spans_count > 0 && match.begin <= (*spans)[spans_count - 1].end) {
+            if (match.end > (*spans)[spans_count - 1].end) (*spans)[spans_count - 1].end = match.end;
+        } else {
+            arrlist_append(*spans, match);
+        }
+    }
+    PROFILE_END("watchlist_scan");
+}
+
+WatchLine* watchlist_line(Watchlist* watchlist, isize line) {
+    isize at = watchlist_lower_bound(watchlist, line);
+    if (at < arrlist_count(watchlist->lines) && watchlist->lines[at].line == line) return &watchlist->lines[at];
+
+    if (arrlist_count(watchlist->lines) >= WATCHLIST_MAX_LINES) {
+        // the view moved far away, keep the lines around the new one
+        isize keep_begin = watchlist_lower_bound(watchlist, line - WATCHLIST_MAX_LINES / 4);
+        isize keep_end = watchlist_lower_bound(watchlist, line + WATCHLIST_MAX_LINES / 4);
+        watchlist_drop(watchlist, keep_end, arrlist_count(watchlist->lines));
+        watchlist_drop(watchlist, 0, keep_begin);
+        at = watchlist_lower_bound(watchlist, line);
+    }
+
+    WatchLine scanned = {.line = line};
+    watchlist_scan(watchlist, line, &scanned.spans);
+    isize count = arrlist_count(watchlist->lines);
+    arrlist_setcount(watchlist->lines, count + 1);
+    memmove(watchlist->lines + at + 1, watchlist->lines + at, (count - at) * sizeof(WatchLine));
+    watchlist->lines[at] = scanned;
+    return &watchlist->lines[at];
+}
@@ -0,0 +1,38 @@
+#ifndef WATCHLIST_H_
+#define WATCHLIST_H_
+
+#include "short_types.h"
+#include "text.h"
+#include "ahocorasick.h"
+
+// a list of patterns highlighted wherever they appear, the automaton is built once and only
+// lines that are drawn get scanned. a line's matches are kept until that line is edited, so
+// frames that don't edit anything don't scan anything no matter how many patterns there are
+
+// lines further than this from the line being looked up are dropped once the cache is full
+#define WATCHLIST_MAX_LINES 1024
+
+typedef struct WatchLine {
+    isize line;
+    TextRange* spans; // arraylist, sorted and merged where matches overlap, relative to the start of the line
+} WatchLine;
+
+typedef struct Watchlist {
+    AhoCorasick aho;
+    bool active;
+    WatchLine* lines; // arraylist, sorted by line
+    TextRange* scratch;
+    StringBuilder straddle; // a line's bytes when it crosses the gap
+    Text* txt;
+} Watchlist;
+
+// starts highlighting patterns in txt, the patterns are copied into the automaton
+void watchlist_set(Watchlist* watchlist, Text* txt, const String* patterns, isize count);
+// one pattern per line, blank lines are skipped. false if the file couldn't be read
+bool watchlist_load(Watchlist* watchlist, Text* txt, const char* filename);
+void watchlist_free(Watchlist* watchlist);
+
+// the highlighted spans of a line of the current text, scanned the first time it's asked for
+WatchLine* watchlist_line(Watchlist* watchlist, isize line);
+
+#endif //WATCHLIST_H_